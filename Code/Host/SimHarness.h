@@ -0,0 +1,121 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Host Simulation Harness
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Puts the whole sketch in front of a simulated oven on the host build.
+
+  Include it after the generated sketch, it needs the sketch's pins and
+  globals. The oven model is heated by the RELAY pin and cooled by the FAN
+  pin, and a MAX31855 on the bit bang pins reads it back, through the same
+  thermocouple table and cold junction sums as a real chip. The sampler and
+  buttons are ticked every virtual ms, as the timer interrupts do on the
+  board, and loop() runs whenever the sketch isn't waiting.
+
+  The probe can be given a fault, or a fixed temperature, at any moment to
+  see what the sketch does about it.
+  ---------------------------------------------------------------------------
+*/
+#ifndef SimHarness_h
+#define SimHarness_h
+
+#include "HostBoard.h"
+#include "OvenSim.h"
+#include "TCLinearize.h"
+
+// What the probe does, SIM_PROBE_OK reads the oven
+#define SIM_PROBE_OK 0xFF
+#define SIM_PROBE_NOREAD 0xFE
+
+#define SIM_COLD_JUNCTION 25
+
+OvenSim simOven;
+
+// A status for the chip to report instead of a temperature, or SIM_PROBE_OK
+uint8_t simProbe = SIM_PROBE_OK;
+
+// Read this instead of the oven when it isn't NAN
+float simProbeTemp = NAN;
+
+// The oven model only sees whether the element is on
+static void SimOvenTick()
+{
+  simOven.setDuty( HostGetPin( RELAY ) ? 1 : 0 );
+  simOven.setFan( HostGetPin( FAN ) );
+  simOven.update( millis() );
+}
+
+// The timer interrupts
+static void SimInterruptTick()
+{
+  tcSampler.poll();
+  buttons.poll();
+}
+
+static uint32_t SimProbeFrame( uint8_t cs )
+{
+  (void)cs;
+
+  if ( simProbe == SIM_PROBE_NOREAD )
+    return 0;
+
+  // Fault bit 16 and the status bits, the chip keeps the cold junction going
+  uint32_t internal = (uint32_t)( SIM_COLD_JUNCTION * 16 ) << 4;
+  if ( simProbe != SIM_PROBE_OK )
+    return internal | ( 1ul << 16 ) | ( simProbe & 0x07 );
+
+  float temp = isnan( simProbeTemp ) ? simOven.getTemperature() : simProbeTemp;
+  int16_t reading = TCChipReading( *TCTableFor( 'K' ), lround( temp * 64 ), SIM_COLD_JUNCTION * 16 );
+  return ( (uint32_t)( reading & 0x3FFF ) << 18 ) | internal;
+}
+
+// Power up the board in a room at ambient
+void SimBegin( float ambient = SIM_COLD_JUNCTION )
+{
+  HostReset();
+  simOven.reset( ambient );
+  simProbe = SIM_PROBE_OK;
+  simProbeTemp = NAN;
+
+  HostAddTickHook( SimOvenTick );
+  HostAddTickHook( SimInterruptTick );
+  HostAddMax31855( MAXCLK, MAXCS, MAXDO, SimProbeFrame );
+
+  setup();
+}
+
+// Run the sketch for ms of virtual time
+void SimRunFor( unsigned long ms )
+{
+  unsigned long start = millis();
+  while ( !CoopScheduler::reached( millis(), start + ms ) )
+    loop();
+}
+
+// Run until done() says so, or timeout ms have gone by, false on a timeout
+bool SimRunUntil( bool (*done)( void ), unsigned long timeout )
+{
+  unsigned long start = millis();
+  while ( !done() )
+  {
+    if ( CoopScheduler::reached( millis(), start + timeout ) )
+      return false;
+    loop();
+  }
+  return true;
+}
+
+// Press a button and let it go after ms, long enough for a long press if it needs one
+void SimPress( uint8_t pin, unsigned long ms = 100 )
+{
+  HostSetPin( pin, HIGH );
+  SimRunFor( ms );
+  HostSetPin( pin, LOW );
+  SimRunFor( BUTTON_DEBOUNCE * 2 );
+}
+
+#endif
@@ -0,0 +1,154 @@
+// Runs every built in paste profile with both controllers against a few simulated ovens, and says how well each tracked.
+//
+//   bench_control [--oven NAME] [--paste N] [--pid|--heuristic]
+//
+// For each run it reports:
+//   RMS     error of the probe against the profile from the start of the reflow to the cutoff
+//   peak    the hottest the probe got, less the profile's peak, so over 0 is an overshoot
+//   TAL     seconds the probe spent above the paste's liquidus
+//
+// Each run is a fork of a board that hasn't been set up yet, so every run
+// starts from power on. Exits 0 if every run finished without an abort.
+
+#include "Reflow_Master_v2.cpp"
+#include "SimHarness.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef struct {
+  const char *name;
+  float heaterPower;
+  float thermalMass;
+  float lossCoeff;
+  float sensorLag;
+} BenchOven;
+
+static const BenchOven ovens[] = {
+  { "stock", 1500, 1000, 5, 4 },  // The OvenSim defaults
+  { "light", 1800, 600, 4, 3 },   // Small and quick
+  { "heavy", 2400, 1200, 6, 10 }, // Plenty of power, late to show it
+};
+
+// Sample the run this often, ms
+#define BENCH_STEP 100
+
+static bool RunOver()
+{
+  return state == FINISHED || state == ABORT || state == MENU;
+}
+
+// One run, on a fresh board, prints its line and returns true if it finished
+static bool BenchRun( const BenchOven &oven, int paste, bool pid )
+{
+  SimBegin();
+  simOven.heaterPower = oven.heaterPower;
+  simOven.thermalMass = oven.thermalMass;
+  simOven.lossCoeff = oven.lossCoeff;
+  simOven.sensorLag = oven.sensorLag;
+  SimRunFor( 3000 );
+
+  set.controller = pid ? CONTROLLER_PID : CONTROLLER_HEURISTIC;
+  set.paste = paste;
+  SetCurrentGraph( paste );
+  const ReflowGraph &graph = CurrentGraph();
+
+  SimPress( BUTTON0 );
+
+  double squares = 0;
+  unsigned long samples = 0;
+  float peak = 0;
+  unsigned long aboveLiquidus = 0;
+
+  unsigned long start = millis();
+  while ( !RunOver() && millis() - start < 3600000UL )
+  {
+    SimRunFor( BENCH_STEP );
+
+    float temp = simOven.getTemperature();
+    peak = max( peak, temp );
+    if ( temp >= graph.tempDeg )
+      aboveLiquidus += BENCH_STEP;
+
+    if ( state == REFLOW && timeX <= graph.offTime )
+    {
+      float error = temp - wantedCurve.value( (int)timeX );
+      squares += error * error;
+      samples++;
+    }
+  }
+
+  bool finished = state == FINISHED;
+  printf( "%-6s %-20s %-9s %7.2f %+7.1f %6.1f  %s\n", oven.name, graph.n, pid ? "PID" : "heuristic",
+          samples > 0 ? sqrt( squares / samples ) : 0.0, peak - graph.maxTemp, aboveLiquidus / 1000.0, finished ? "ok" : "ABORTED" );
+  return finished;
+}
+
+int main( int argc, char **argv )
+{
+  const char *onlyOven = NULL;
+  int onlyPaste = -1;
+  int onlyPid = -1;
+
+  for ( int i = 1; i < argc; i++ )
+  {
+    if ( strcmp( argv[i], "--oven" ) == 0 && i + 1 < argc )
+      onlyOven = argv[++i];
+    else if ( strcmp( argv[i], "--paste" ) == 0 && i + 1 < argc )
+      onlyPaste = atoi( argv[++i] );
+    else if ( strcmp( argv[i], "--pid" ) == 0 )
+      onlyPid = 1;
+    else if ( strcmp( argv[i], "--heuristic" ) == 0 )
+      onlyPid = 0;
+    else
+    {
+      printf( "bench_control [--oven NAME] [--paste N] [--pid|--heuristic]\n" );
+      return 2;
+    }
+  }
+
+  printf( "%-6s %-20s %-9s %7s %7s %6s\n", "oven", "profile", "control", "RMS c", "peak c", "TAL s" );
+
+  int runs = 0;
+  int failed = 0;
+  for ( const BenchOven &oven : ovens )
+  {
+    if ( onlyOven != NULL && strcmp( onlyOven, oven.name ) != 0 )
+      continue;
+
+    for ( int paste = 0; paste < (int)ELEMENTS( solderPaste ); paste++ )
+    {
+      if ( onlyPaste >= 0 && paste != onlyPaste )
+        continue;
+
+      for ( int pid = 0; pid < 2; pid++ )
+      {
+        if ( onlyPid >= 0 && pid != onlyPid )
+          continue;
+
+        fflush( stdout );
+        pid_t child = fork();
+        if ( child == 0 )
+        {
+          bool finished = BenchRun( oven, paste, pid );
+          fflush( stdout );
+          _exit( finished ? 0 : 1 );
+        }
+
+        int status = 1;
+        if ( child < 0 || waitpid( child, &status, 0 ) != child || !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 )
+          failed++;
+        runs++;
+      }
+    }
+  }
+
+  if ( runs == 0 || failed > 0 )
+  {
+    printf( "FAIL: %d of %d runs didn't finish\n", failed, runs );
+    return 1;
+  }
+
+  printf( "PASS\n" );
+  return 0;
+}
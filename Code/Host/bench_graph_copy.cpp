@@ -0,0 +1,213 @@
+// Counts the bytes copied and the heap allocations per control tick, returning the profile by value and by reference.
+//
+//   bench_graph_copy [--paste N]
+//
+// The sketch is built with CurrentGraph() and ControlTask() wrapped. Every
+// call the control tick makes to CurrentGraph() also makes the copy the old
+// CurrentGraph() made, of the ReflowGraph as it was then, with its two name
+// Strings and the 480 float wanted curve in it. Its bytes and allocations
+// are counted apart from the tick's own.
+//
+// Exits 0 if the control tick copies nothing and allocates nothing.
+
+#include "Reflow_Master_v2_wrapped.cpp"
+#include "SimHarness.h"
+
+extern "C" void *__libc_malloc( size_t size );
+extern "C" void *__libc_calloc( size_t count, size_t size );
+extern "C" void *__libc_realloc( void *ptr, size_t size );
+extern "C" void __libc_free( void *ptr );
+
+static bool countAllocs = false;
+static unsigned long heapAllocs = 0;
+
+// Every allocation goes past here, operator new included
+extern "C" void *malloc( size_t size )
+{
+  if ( countAllocs )
+    heapAllocs++;
+  return __libc_malloc( size );
+}
+
+extern "C" void *calloc( size_t count, size_t size )
+{
+  if ( countAllocs )
+    heapAllocs++;
+  return __libc_calloc( count, size );
+}
+
+extern "C" void *realloc( void *ptr, size_t size )
+{
+  if ( countAllocs )
+    heapAllocs++;
+  return __libc_realloc( ptr, size );
+}
+
+extern "C" void free( void *ptr )
+{
+  __libc_free( ptr );
+}
+
+// The profile as it was, copied whole by every CurrentGraph() call
+class LegacyReflowGraph
+{
+  public:
+    String n;
+    String t;
+    int tempDeg;
+    float reflowTime[10];
+    float reflowTemp[10];
+    float reflowTangents[10] { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+    float wantedCurve[480];
+    int len = -1;
+    int fanTime = -1;
+    int offTime = -1;
+    int completeTime = -1;
+
+    float maxWantedDelta = 0;
+
+    LegacyReflowGraph()
+    {
+    }
+
+    LegacyReflowGraph( const ReflowGraph &graph ) : n( graph.n ), t( graph.t ), tempDeg( graph.tempDeg )
+    {
+      len = min( 10, graph.len );
+      fanTime = graph.fanTime;
+      offTime = graph.offTime;
+      completeTime = graph.completeTime;
+
+      for ( int i = 0; i < len; i++ )
+      {
+        reflowTime[i] = graph.reflowTime[i];
+        reflowTemp[i] = graph.reflowTemp[i];
+        reflowTangents[i] = graph.reflowTangents[i];
+      }
+
+      for ( size_t i = 0; i < 480; i++ )
+        wantedCurve[i] = -1;
+    }
+
+    // What a copy moves, the object and the String buffers
+    unsigned long copyBytes() const
+    {
+      return sizeof( *this ) + n.length() + 1 + t.length() + 1;
+    }
+};
+
+static LegacyReflowGraph legacyGraph;
+
+static LegacyReflowGraph LegacyCurrentGraph()
+{
+  return legacyGraph;
+}
+
+// Per control tick
+static unsigned long graphCalls = 0;
+static unsigned long legacyAllocs = 0;
+static unsigned long legacyBytes = 0;
+
+// Totals over the ticks of the run
+static unsigned long ticks = 0;
+static unsigned long totalCalls = 0;
+static unsigned long maxCalls = 0;
+static unsigned long totalAllocs = 0;
+static unsigned long totalLegacyAllocs = 0;
+static unsigned long totalLegacyBytes = 0;
+
+const ReflowGraph& CurrentGraph()
+{
+  if ( countAllocs )
+  {
+    graphCalls++;
+
+    // The copy the old CurrentGraph() made, kept out of the tick's own count
+    unsigned long before = heapAllocs;
+    {
+      LegacyReflowGraph copy = LegacyCurrentGraph();
+      legacyBytes += copy.copyBytes();
+    }
+    legacyAllocs += heapAllocs - before;
+    heapAllocs = before;
+  }
+
+  return CurrentGraph_wrapped();
+}
+
+void ControlTask()
+{
+  bool running = state == WARMUP || state == REFLOW;
+
+  graphCalls = 0;
+  legacyAllocs = 0;
+  legacyBytes = 0;
+  heapAllocs = 0;
+  countAllocs = running;
+
+  ControlTask_wrapped();
+
+  countAllocs = false;
+  if ( !running )
+    return;
+
+  ticks++;
+  totalCalls += graphCalls;
+  maxCalls = max( maxCalls, graphCalls );
+  totalAllocs += heapAllocs;
+  totalLegacyAllocs += legacyAllocs;
+  totalLegacyBytes += legacyBytes;
+}
+
+static bool RunOver()
+{
+  return state == FINISHED || state == ABORT || state == MENU;
+}
+
+int main( int argc, char **argv )
+{
+  int paste = 4;
+  for ( int i = 1; i < argc; i++ )
+  {
+    if ( strcmp( argv[i], "--paste" ) == 0 && i + 1 < argc )
+      paste = atoi( argv[++i] );
+    else
+    {
+      printf( "bench_graph_copy [--paste N]\n" );
+      return 2;
+    }
+  }
+
+  SimBegin();
+  SimRunFor( 3000 );
+
+  set.paste = paste;
+  SetCurrentGraph( paste );
+  legacyGraph = LegacyReflowGraph( CurrentGraph_wrapped() );
+
+  SimPress( BUTTON0 );
+  if ( !SimRunUntil( RunOver, 3600000UL ) || ticks == 0 )
+  {
+    printf( "FAIL: the run didn't finish, state %d\n", state );
+    return 1;
+  }
+
+  // Before is the tick as it is plus the copies the old CurrentGraph() made
+  double calls = (double)totalCalls / ticks;
+  double afterAllocs = (double)totalAllocs / ticks;
+  double beforeAllocs = afterAllocs + (double)totalLegacyAllocs / ticks;
+  double beforeBytes = (double)totalLegacyBytes / ticks;
+
+  printf( "%s, %lu control ticks, CurrentGraph() %.1f calls a tick, %lu at most\n", CurrentGraph_wrapped().n, ticks, calls, maxCalls );
+  printf( "%-24s %10s %10s\n", "per control tick", "by value", "by ref" );
+  printf( "%-24s %10.0f %10.0f\n", "bytes copied", beforeBytes, 0.0 );
+  printf( "%-24s %10.1f %10.1f\n", "heap allocations", beforeAllocs, afterAllocs );
+
+  if ( totalAllocs > 0 )
+  {
+    printf( "FAIL: the control tick allocates\n" );
+    return 1;
+  }
+
+  printf( "PASS\n" );
+  return 0;
+}
@@ -0,0 +1,151 @@
+// Times building the wanted curve, one sample a second over each built in profile, with the old and new spline code.
+//
+//   bench_spline [--reps N]
+//
+// Cycles per sample are read from the x86 time stamp counter, or are ns
+// elsewhere, and are the best of N runs. The old Spline is kept here as it
+// was, a wrapping linear search for the segment and pow() for the Hermite
+// basis. Exits 0 if the new value() and values() agree with it.
+
+#include "Reflow_Master_v2.cpp"
+#include "check.h"
+
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static inline uint64_t BenchClock() { return __rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t BenchClock() { return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count(); }
+#endif
+
+// The spline before the coefficients were precomputed
+class LegacySpline
+{
+  public:
+    void setPoints( const float x[], const float y[], const float m[], int numPoints ) { _x = x; _y = y; _m = m; _length = numPoints; }
+    void setDegree( int degree ) { _degree = degree; }
+
+    float value( float x )
+    {
+      if ( _x[0] > x ) {
+        return _y[0];
+      }
+      else if ( _x[_length - 1] < x ) {
+        return _y[_length - 1];
+      }
+      else {
+        for (int i = 0; i < _length; i++ )
+        {
+          int index = ( i + _prev_point ) % _length;
+
+          if ( _x[index] == x ) {
+            _prev_point = index;
+            return _y[index];
+          } else if ( (_x[index] < x) && (x < _x[index + 1]) ) {
+            _prev_point = index;
+            return calc( x, index );
+          }
+        }
+      }
+      return _y[0];
+    }
+
+  private:
+    const float *_x;
+    const float *_y;
+    const float *_m;
+    int _degree = Hermite;
+    int _length = 0;
+    int _prev_point = 0;
+
+    float calc( float x, int i )
+    {
+      switch ( _degree ) {
+        case 1:
+          return _y[i] + (_y[i + 1] - _y[i]) * ( x - _x[i]) / ( _x[i + 1] - _x[i] );
+        case Hermite:
+          return hermite( ((x - _x[i]) / (_x[i + 1] - _x[i])), _y[i], _y[i + 1], _m[i], _m[i + 1], _x[i], _x[i + 1] );
+      }
+      return _y[i];
+    }
+
+    float hermite( float t, float p0, float p1, float m0, float m1, float x0, float x1 ) {
+      return (hermite_00(t) * p0) + (hermite_10(t) * (x1 - x0) * m0) + (hermite_01(t) * p1) + (hermite_11(t) * (x1 - x0) * m1);
+    }
+    float hermite_00( float t ) { return (2 * pow(t, 3)) - (3 * pow(t, 2)) + 1; }
+    float hermite_10( float t ) { return pow(t, 3) - (2 * pow(t, 2)) + t; }
+    float hermite_01( float t ) { return (3 * pow(t, 2)) - (2 * pow(t, 3)); }
+    float hermite_11( float t ) { return pow(t, 3) - pow(t, 2); }
+};
+
+static float legacyOut[PROFILE_MAX_TIME + 1];
+static float newOut[PROFILE_MAX_TIME + 1];
+static float batchOut[PROFILE_MAX_TIME + 1];
+
+// Keeps the optimiser from dropping the work
+static volatile float sink;
+
+int main( int argc, char **argv )
+{
+  int reps = 50;
+  for ( int i = 1; i < argc; i++ )
+  {
+    if ( strcmp( argv[i], "--reps" ) == 0 && i + 1 < argc )
+      reps = max( 1, atoi( argv[++i] ) );
+    else
+    {
+      printf( "bench_spline [--reps N]\n" );
+      return 2;
+    }
+  }
+
+  printf( "%-20s %8s %12s %12s %12s\n", "profile", "samples", "old value()", "value()", "values()" );
+
+  for ( size_t p = 0; p < ELEMENTS( solderPaste ); p++ )
+  {
+    const ReflowGraph &graph = solderPaste[p];
+    int count = (int)graph.completeTime + 1;
+
+    LegacySpline legacy;
+    legacy.setPoints( graph.reflowTime, graph.reflowTemp, graph.reflowTangents, graph.len );
+    legacy.setDegree( Hermite );
+
+    Spline spline;
+    spline.setPoints( graph.reflowTime, graph.reflowTemp, graph.reflowTangents, graph.len );
+    spline.setDegree( Hermite );
+
+    uint64_t bestLegacy = UINT64_MAX, bestValue = UINT64_MAX, bestBatch = UINT64_MAX;
+    for ( int r = 0; r < reps; r++ )
+    {
+      uint64_t start = BenchClock();
+      for ( int x = 0; x < count; x++ )
+        legacyOut[x] = legacy.value( x );
+      bestLegacy = min( bestLegacy, BenchClock() - start );
+
+      start = BenchClock();
+      for ( int x = 0; x < count; x++ )
+        newOut[x] = spline.value( x );
+      bestValue = min( bestValue, BenchClock() - start );
+
+      start = BenchClock();
+      spline.values( 0, 1, batchOut, count );
+      bestBatch = min( bestBatch, BenchClock() - start );
+
+      sink = legacyOut[r % count] + newOut[r % count] + batchOut[r % count];
+    }
+
+    printf( "%-20s %8d %12.1f %12.1f %12.1f\n", graph.n, count, (double)bestLegacy / count, (double)bestValue / count, (double)bestBatch / count );
+
+    // The same curve, to float rounding
+    for ( int x = 0; x < count; x++ )
+    {
+      CHECK_NEAR( newOut[x], legacyOut[x], 0.01 );
+      CHECK_NEAR( batchOut[x], legacyOut[x], 0.01 );
+    }
+  }
+
+  printf( "%s per sample, best of %d\n", BENCH_UNIT, reps );
+  return CheckResult();
+}
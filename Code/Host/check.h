@@ -0,0 +1,40 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Host Test Checks
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  The few asserts the host tests need. A failed CHECK prints where and what,
+  and the test carries on so one run shows every failure. main() returns
+  CheckResult(), which ctest reads as pass or fail.
+  ---------------------------------------------------------------------------
+*/
+#ifndef check_h
+#define check_h
+
+#include <stdio.h>
+#include <math.h>
+
+static int checkFailures = 0;
+
+#define CHECK( cond ) \
+  do { if ( !( cond ) ) { printf( "%s:%d: FAIL: %s\n", __FILE__, __LINE__, #cond ); checkFailures++; } } while ( 0 )
+
+#define CHECK_NEAR( a, b, tol ) \
+  do { double _a = ( a ), _b = ( b ); if ( !( fabs( _a - _b ) <= ( tol ) ) ) { printf( "%s:%d: FAIL: %s is %g, not %g within %g\n", __FILE__, __LINE__, #a, _a, _b, (double)( tol ) ); checkFailures++; } } while ( 0 )
+
+static int CheckResult()
+{
+  if ( checkFailures > 0 )
+  {
+    printf( "%d checks failed\n", checkFailures );
+    return 1;
+  }
+  printf( "PASS\n" );
+  return 0;
+}
+
+#endif
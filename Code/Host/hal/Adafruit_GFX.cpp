@@ -0,0 +1,144 @@
+#include "Adafruit_GFX.h"
+#include "Adafruit_ILI9341.h"
+#include "SPI.h"
+
+SPIClass SPI;
+
+Adafruit_GFX::Adafruit_GFX( int16_t w, int16_t h ) : WIDTH( w ), HEIGHT( h )
+{
+  _width = w;
+  _height = h;
+  _cursorX = 0;
+  _cursorY = 0;
+  _textColor = 0xFFFF;
+  _textBg = 0xFFFF;
+  _textSize = 1;
+  _rotation = 0;
+  _wrap = true;
+  _pixels = 0;
+}
+
+size_t Adafruit_GFX::write( uint8_t c )
+{
+  if ( c == '\n' )
+  {
+    _cursorX = 0;
+    _cursorY += _textSize * 8;
+  }
+  else if ( c != '\r' )
+  {
+    if ( _wrap && _cursorX + _textSize * 6 > _width )
+    {
+      _cursorX = 0;
+      _cursorY += _textSize * 8;
+    }
+    drawChar( _cursorX, _cursorY, c, _textColor, _textBg, _textSize );
+    _cursorX += _textSize * 6;
+  }
+  return 1;
+}
+
+void Adafruit_GFX::drawPixel( int16_t x, int16_t y, uint16_t color )
+{
+  (void)color;
+  if ( x >= 0 && y >= 0 && x < _width && y < _height )
+    _pixels++;
+}
+
+void Adafruit_GFX::drawLine( int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color )
+{
+  int16_t steps = max( abs( x1 - x0 ), abs( y1 - y0 ) );
+  for ( int16_t i = 0; i <= steps; i++ )
+    drawPixel( x0 + ( steps ? ( x1 - x0 ) * i / steps : 0 ), y0 + ( steps ? ( y1 - y0 ) * i / steps : 0 ), color );
+}
+
+void Adafruit_GFX::drawFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color )
+{
+  fillRect( x, y, 1, h, color );
+}
+
+void Adafruit_GFX::drawFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color )
+{
+  fillRect( x, y, w, 1, color );
+}
+
+void Adafruit_GFX::drawRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color )
+{
+  drawFastHLine( x, y, w, color );
+  drawFastHLine( x, y + h - 1, w, color );
+  drawFastVLine( x, y, h, color );
+  drawFastVLine( x + w - 1, y, h, color );
+}
+
+void Adafruit_GFX::fillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color )
+{
+  (void)color;
+  long cw = min( x + w, (int)_width ) - max( x, (int16_t)0 );
+  long ch = min( y + h, (int)_height ) - max( y, (int16_t)0 );
+  if ( cw > 0 && ch > 0 )
+    _pixels += cw * ch;
+}
+
+void Adafruit_GFX::fillScreen( uint16_t color )
+{
+  fillRect( 0, 0, _width, _height, color );
+}
+
+// Every font pixel on its own, the way the Adafruit library sends them
+void Adafruit_GFX::drawChar( int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size )
+{
+  (void)c;
+  if ( bg != color )
+    fillRect( x, y, 6 * size, 8 * size, bg );
+}
+
+void Adafruit_GFX::getTextBounds( const char *str, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h )
+{
+  *x1 = x;
+  *y1 = y;
+  *w = strlen( str ) * 6 * _textSize;
+  *h = 8 * _textSize;
+}
+
+void Adafruit_GFX::getTextBounds( const String &str, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h )
+{
+  getTextBounds( str.c_str(), x, y, x1, y1, w, h );
+}
+
+void Adafruit_GFX::setRotation( uint8_t r )
+{
+  _rotation = r & 3;
+  _width = ( _rotation & 1 ) ? HEIGHT : WIDTH;
+  _height = ( _rotation & 1 ) ? WIDTH : HEIGHT;
+}
+
+Adafruit_ILI9341::Adafruit_ILI9341( int8_t cs, int8_t dc, int8_t rst ) : Adafruit_GFX( ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT )
+{
+  (void)cs;
+  (void)dc;
+  (void)rst;
+}
+
+void Adafruit_ILI9341::begin( uint32_t freq )
+{
+  (void)freq;
+}
+
+void Adafruit_ILI9341::setAddrWindow( uint16_t x, uint16_t y, uint16_t w, uint16_t h )
+{
+  (void)x;
+  (void)y;
+  (void)w;
+  (void)h;
+}
+
+void Adafruit_ILI9341::writePixel( int16_t x, int16_t y, uint16_t color )
+{
+  drawPixel( x, y, color );
+}
+
+void Adafruit_ILI9341::writeColor( uint16_t color, uint32_t len )
+{
+  (void)color;
+  _pixels += len;
+}
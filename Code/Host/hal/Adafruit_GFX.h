@@ -0,0 +1,70 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Host GFX
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  The Adafruit GFX calls the sketch makes. Nothing is drawn, only the
+  pixels that would be sent are counted. The text cursor and the size of
+  the screen are kept, so anything laid out from them comes out where it
+  would on the TFT.
+  ---------------------------------------------------------------------------
+*/
+#ifndef Adafruit_GFX_h
+#define Adafruit_GFX_h
+
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print
+{
+  public:
+    Adafruit_GFX( int16_t w, int16_t h );
+
+    size_t write( uint8_t c ) override;
+    using Print::write;
+
+    void drawPixel( int16_t x, int16_t y, uint16_t color );
+    void drawLine( int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color );
+    void drawFastVLine( int16_t x, int16_t y, int16_t h, uint16_t color );
+    void drawFastHLine( int16_t x, int16_t y, int16_t w, uint16_t color );
+    void drawRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color );
+    void fillRect( int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color );
+    void fillScreen( uint16_t color );
+    void drawChar( int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size );
+
+    void setCursor( int16_t x, int16_t y ) { _cursorX = x; _cursorY = y; }
+    int16_t getCursorX() const { return _cursorX; }
+    int16_t getCursorY() const { return _cursorY; }
+    void setTextColor( uint16_t c ) { _textColor = c; _textBg = c; }
+    void setTextColor( uint16_t c, uint16_t bg ) { _textColor = c; _textBg = bg; }
+    void setTextSize( uint8_t s ) { _textSize = s > 0 ? s : 1; }
+    void setTextWrap( bool w ) { _wrap = w; }
+
+    // The 6x8 built in font
+    void getTextBounds( const char *str, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h );
+    void getTextBounds( const String &str, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h );
+
+    void setRotation( uint8_t r );
+    uint8_t getRotation() const { return _rotation; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    // Pixels sent since the last reset, to see what a screen costs
+    unsigned long getPixels() const { return _pixels; }
+    void resetPixels() { _pixels = 0; }
+
+  protected:
+    const int16_t WIDTH, HEIGHT;
+    int16_t _width, _height;
+    int16_t _cursorX, _cursorY;
+    uint16_t _textColor, _textBg;
+    uint8_t _textSize;
+    uint8_t _rotation;
+    bool _wrap;
+    unsigned long _pixels;
+};
+
+#endif
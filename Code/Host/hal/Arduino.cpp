@@ -0,0 +1,538 @@
+#include "Arduino.h"
+#include "HostBoard.h"
+#include <ctype.h>
+#include <chrono>
+
+// Virtual time, only moved on by waiting
+static unsigned long long nowMicros = 0;
+static unsigned long yields = 0;
+static bool inHook = false;
+
+static HostHook hooks[HOST_MAX_HOOKS];
+static uint8_t hookCount = 0;
+
+static uint8_t pinLevel[NUM_DIGITAL_PINS];
+static uint8_t pinModes[NUM_DIGITAL_PINS];
+static unsigned long pinChangedAt[NUM_DIGITAL_PINS];
+static void (*pinIsr[NUM_DIGITAL_PINS])( void );
+
+typedef struct {
+  uint8_t sclk;
+  uint8_t cs;
+  uint8_t miso;
+  HostFrameFunc frameFunc;
+  uint32_t frame;
+  int8_t bit;
+} HostChip;
+
+static HostChip chips[HOST_MAX_CHIPS];
+static uint8_t chipCount = 0;
+
+static char serialIn[256];
+static uint16_t serialHead = 0;
+static uint16_t serialTail = 0;
+static bool serialEcho = false;
+
+HardwareSerial Serial;
+
+void HostReset( void )
+{
+  nowMicros = 0;
+  yields = 0;
+  hookCount = 0;
+  chipCount = 0;
+  serialHead = 0;
+  serialTail = 0;
+
+  for ( uint8_t p = 0; p < NUM_DIGITAL_PINS; p++ )
+  {
+    pinLevel[p] = LOW;
+    pinModes[p] = INPUT;
+    pinChangedAt[p] = 0;
+    pinIsr[p] = NULL;
+  }
+}
+
+bool HostAddTickHook( HostHook hook )
+{
+  if ( hookCount >= HOST_MAX_HOOKS )
+    return false;
+
+  hooks[hookCount++] = hook;
+  return true;
+}
+
+void HostAdvance( unsigned long us )
+{
+  unsigned long long end = nowMicros + us;
+
+  // Time spent inside a hook is just time, the hooks don't break in on themselves
+  if ( inHook )
+  {
+    nowMicros = end;
+    return;
+  }
+
+  while ( true )
+  {
+    unsigned long long tick = ( nowMicros / 1000 + 1 ) * 1000;
+    if ( tick > end )
+      break;
+
+    nowMicros = tick;
+    inHook = true;
+    for ( uint8_t i = 0; i < hookCount; i++ )
+      hooks[i]();
+    inHook = false;
+  }
+
+  nowMicros = end;
+}
+
+unsigned long HostYields( void )
+{
+  return yields;
+}
+
+unsigned long millis( void )
+{
+  return (unsigned long)( nowMicros / 1000 );
+}
+
+unsigned long micros( void )
+{
+  return (unsigned long)nowMicros;
+}
+
+unsigned long HostWallMicros( void )
+{
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+void delay( unsigned long ms )
+{
+  HostAdvance( ms * 1000 );
+}
+
+void delayMicroseconds( unsigned int us )
+{
+  HostAdvance( us );
+}
+
+// Nothing to do until the next interrupt, which is the next ms tick at the latest
+void yield( void )
+{
+  yields++;
+  HostAdvance( 1000 - nowMicros % 1000 );
+}
+
+static bool validPin( uint8_t pin )
+{
+  return pin < NUM_DIGITAL_PINS;
+}
+
+static void setLevel( uint8_t pin, uint8_t value )
+{
+  value = value ? HIGH : LOW;
+  if ( pinLevel[pin] == value )
+    return;
+
+  pinLevel[pin] = value;
+  pinChangedAt[pin] = micros();
+
+  if ( pinIsr[pin] != NULL )
+    pinIsr[pin]();
+}
+
+// The MAX31855 has D31 out as soon as CS goes low, and moves to the next bit on each rising edge of SCK
+static void chipPins( uint8_t pin, uint8_t value )
+{
+  for ( uint8_t i = 0; i < chipCount; i++ )
+  {
+    HostChip &chip = chips[i];
+
+    if ( pin == chip.cs )
+    {
+      if ( value == LOW )
+      {
+        chip.frame = chip.frameFunc( chip.cs );
+        chip.bit = 31;
+        setLevel( chip.miso, ( chip.frame >> 31 ) & 1 );
+      }
+      else
+      {
+        chip.bit = -1;
+      }
+    }
+    else if ( pin == chip.sclk && value == HIGH && chip.bit > 0 && pinLevel[chip.cs] == LOW )
+    {
+      chip.bit--;
+      setLevel( chip.miso, ( chip.frame >> chip.bit ) & 1 );
+    }
+  }
+}
+
+bool HostAddMax31855( uint8_t sclk, uint8_t cs, uint8_t miso, HostFrameFunc frameFunc )
+{
+  if ( chipCount >= HOST_MAX_CHIPS || !validPin( sclk ) || !validPin( cs ) || !validPin( miso ) )
+    return false;
+
+  HostChip &chip = chips[chipCount++];
+  chip.sclk = sclk;
+  chip.cs = cs;
+  chip.miso = miso;
+  chip.frameFunc = frameFunc;
+  chip.frame = 0;
+  chip.bit = -1;
+  return true;
+}
+
+void HostSetPin( uint8_t pin, uint8_t value )
+{
+  if ( validPin( pin ) )
+    setLevel( pin, value );
+}
+
+uint8_t HostGetPin( uint8_t pin )
+{
+  return validPin( pin ) ? pinLevel[pin] : LOW;
+}
+
+unsigned long HostPinChanged( uint8_t pin )
+{
+  return validPin( pin ) ? pinChangedAt[pin] : 0;
+}
+
+void pinMode( uint8_t pin, uint8_t mode )
+{
+  if ( !validPin( pin ) )
+    return;
+
+  pinModes[pin] = mode;
+  if ( mode == INPUT_PULLUP )
+    setLevel( pin, HIGH );
+}
+
+void digitalWrite( uint8_t pin, uint8_t value )
+{
+  if ( !validPin( pin ) )
+    return;
+
+  value = value ? HIGH : LOW;
+  bool changed = pinLevel[pin] != value;
+  setLevel( pin, value );
+
+  if ( changed )
+    chipPins( pin, value );
+}
+
+int digitalRead( uint8_t pin )
+{
+  return validPin( pin ) ? pinLevel[pin] : LOW;
+}
+
+void analogWrite( uint8_t pin, int value )
+{
+  digitalWrite( pin, value > 127 ? HIGH : LOW );
+}
+
+int analogRead( uint8_t pin )
+{
+  (void)pin;
+  return 0;
+}
+
+void tone( uint8_t pin, unsigned int frequency, unsigned long duration )
+{
+  (void)pin;
+  (void)frequency;
+  (void)duration;
+}
+
+void noTone( uint8_t pin )
+{
+  (void)pin;
+}
+
+void attachInterrupt( uint8_t pin, void (*isr)( void ), int mode )
+{
+  (void)mode;
+  if ( validPin( pin ) )
+    pinIsr[pin] = isr;
+}
+
+void detachInterrupt( uint8_t pin )
+{
+  if ( validPin( pin ) )
+    pinIsr[pin] = NULL;
+}
+
+/////////////////////////////////////////////////////////
+//
+// Serial
+//
+void HostSerialInput( const char *text )
+{
+  while ( *text )
+  {
+    uint16_t next = ( serialHead + 1 ) % sizeof( serialIn );
+    if ( next == serialTail )
+      break;
+
+    serialIn[serialHead] = *text++;
+    serialHead = next;
+  }
+}
+
+void HostSerialEcho( bool echo )
+{
+  serialEcho = echo;
+}
+
+int HardwareSerial::available()
+{
+  return ( serialHead + sizeof( serialIn ) - serialTail ) % sizeof( serialIn );
+}
+
+int HardwareSerial::peek()
+{
+  return serialHead == serialTail ? -1 : (uint8_t)serialIn[serialTail];
+}
+
+int HardwareSerial::read()
+{
+  int c = peek();
+  if ( c >= 0 )
+    serialTail = ( serialTail + 1 ) % sizeof( serialIn );
+  return c;
+}
+
+size_t HardwareSerial::write( uint8_t c )
+{
+  if ( serialEcho )
+    fputc( c, stdout );
+  return 1;
+}
+
+size_t HardwareSerial::write( const uint8_t *buffer, size_t size )
+{
+  if ( serialEcho )
+    fwrite( buffer, 1, size, stdout );
+  return size;
+}
+
+/////////////////////////////////////////////////////////
+//
+// Print
+//
+size_t Print::write( const uint8_t *buffer, size_t size )
+{
+  size_t n = 0;
+  while ( size-- )
+    n += write( *buffer++ );
+  return n;
+}
+
+size_t Print::print( long n, int base )
+{
+  if ( base == DEC )
+  {
+    char buf[24];
+    snprintf( buf, sizeof( buf ), "%ld", n );
+    return write( buf );
+  }
+  return print( (unsigned long)n, base );
+}
+
+size_t Print::print( unsigned long n, int base )
+{
+  char buf[8 * sizeof( long ) + 1];
+  char *str = &buf[sizeof( buf ) - 1];
+  *str = '\0';
+
+  if ( base < 2 )
+    base = 10;
+
+  do
+  {
+    unsigned long digit = n % base;
+    n /= base;
+    *--str = digit < 10 ? '0' + digit : 'A' + digit - 10;
+  } while ( n );
+
+  return write( str );
+}
+
+size_t Print::print( double n, int digits )
+{
+  char buf[48];
+  snprintf( buf, sizeof( buf ), "%.*f", digits, n );
+  return write( buf );
+}
+
+/////////////////////////////////////////////////////////
+//
+// String
+//
+String::String( const char *str ) : _buf( NULL ), _len( 0 )
+{
+  assign( str, str == NULL ? 0 : strlen( str ) );
+}
+
+String::String( const String &str ) : _buf( NULL ), _len( 0 )
+{
+  assign( str._buf, str._len );
+}
+
+String::String( char c ) : _buf( NULL ), _len( 0 )
+{
+  assign( &c, 1 );
+}
+
+String::String( int value, unsigned char base ) : String( (long)value, base ) {}
+String::String( unsigned int value, unsigned char base ) : String( (unsigned long)value, base ) {}
+
+String::String( long value, unsigned char base ) : _buf( NULL ), _len( 0 )
+{
+  char buf[8 * sizeof( long ) + 2];
+  if ( base == DEC )
+    snprintf( buf, sizeof( buf ), "%ld", value );
+  else
+    snprintf( buf, sizeof( buf ), base == HEX ? "%lx" : "%lo", (unsigned long)value );
+  assign( buf, strlen( buf ) );
+}
+
+String::String( unsigned long value, unsigned char base ) : _buf( NULL ), _len( 0 )
+{
+  char buf[8 * sizeof( long ) + 2];
+  snprintf( buf, sizeof( buf ), base == HEX ? "%lx" : base == OCT ? "%lo" : "%lu", value );
+  assign( buf, strlen( buf ) );
+}
+
+String::String( float value, unsigned char decimals ) : String( (double)value, decimals ) {}
+
+String::String( double value, unsigned char decimals ) : _buf( NULL ), _len( 0 )
+{
+  char buf[48];
+  snprintf( buf, sizeof( buf ), "%.*f", decimals, value );
+  assign( buf, strlen( buf ) );
+}
+
+String::~String()
+{
+  free( _buf );
+}
+
+void String::assign( const char *str, unsigned int len )
+{
+  char *buf = (char *)realloc( _buf, len + 1 );
+  if ( buf == NULL )
+    return;
+
+  _buf = buf;
+  if ( len > 0 )
+    memmove( _buf, str, len );
+  _buf[len] = '\0';
+  _len = len;
+}
+
+void String::append( const char *str, unsigned int len )
+{
+  char *buf = (char *)realloc( _buf, _len + len + 1 );
+  if ( buf == NULL )
+    return;
+
+  _buf = buf;
+  memcpy( _buf + _len, str, len );
+  _len += len;
+  _buf[_len] = '\0';
+}
+
+String &String::operator=( const String &rhs )
+{
+  if ( this != &rhs )
+    assign( rhs._buf, rhs._len );
+  return *this;
+}
+
+String &String::operator+=( const String &rhs )
+{
+  String copy( rhs ); // in case it's this one
+  append( copy._buf, copy._len );
+  return *this;
+}
+
+String &String::operator+=( const char *rhs )
+{
+  if ( rhs != NULL )
+    append( rhs, strlen( rhs ) );
+  return *this;
+}
+
+String &String::operator+=( char c )
+{
+  append( &c, 1 );
+  return *this;
+}
+
+int String::indexOf( char c ) const
+{
+  const char *p = strchr( _buf, c );
+  return p == NULL ? -1 : p - _buf;
+}
+
+String String::substring( unsigned int from, unsigned int to ) const
+{
+  if ( from > to )
+  {
+    unsigned int t = from;
+    from = to;
+    to = t;
+  }
+  to = min( to, _len );
+  from = min( from, to );
+
+  String out;
+  out.assign( _buf + from, to - from );
+  return out;
+}
+
+void String::trim()
+{
+  unsigned int start = 0;
+  while ( start < _len && isspace( (unsigned char)_buf[start] ) )
+    start++;
+
+  unsigned int end = _len;
+  while ( end > start && isspace( (unsigned char)_buf[end - 1] ) )
+    end--;
+
+  assign( _buf + start, end - start );
+}
+
+void String::toUpperCase()
+{
+  for ( unsigned int i = 0; i < _len; i++ )
+    _buf[i] = toupper( (unsigned char)_buf[i] );
+}
+
+String operator+( const String &lhs, const String &rhs )
+{
+  String out( lhs );
+  out += rhs;
+  return out;
+}
+
+String operator+( const String &lhs, const char *rhs )
+{
+  String out( lhs );
+  out += rhs;
+  return out;
+}
+
+String operator+( const char *lhs, const String &rhs )
+{
+  String out( lhs );
+  out += rhs;
+  return out;
+}
@@ -0,0 +1,205 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Host Arduino Core
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Just enough of the Arduino core for the sketch to build and run on a PC.
+
+  Time is virtual. millis() and micros() only move when the code waits, in
+  delay(), delayMicroseconds() or yield(), which is what the scheduler calls
+  when nothing is due. Running code takes no time at all, so a 6 minute
+  reflow runs through in a fraction of a second.
+
+  Every virtual ms the hooks set in HostBoard.h are called, they stand in for
+  the timer interrupts and the hardware on the other side of the pins.
+  ---------------------------------------------------------------------------
+*/
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <ctype.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 2
+#define FALLING 3
+#define RISING 4
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define F(s) (s)
+
+// Pin numbers as the Feather M0 has them
+#define PIN_A0 14
+#define PIN_A1 15
+#define PIN_A2 16
+#define PIN_A3 17
+#define PIN_A4 18
+#define PIN_A5 19
+static const uint8_t A0 = PIN_A0;
+static const uint8_t A1 = PIN_A1;
+static const uint8_t A2 = PIN_A2;
+static const uint8_t A3 = PIN_A3;
+static const uint8_t A4 = PIN_A4;
+static const uint8_t A5 = PIN_A5;
+#define LED_BUILTIN 13
+#define NUM_DIGITAL_PINS 26
+
+// Functions, not macros, so they don't get in the way of the standard library
+template<class T, class L> inline auto min( const T &a, const L &b ) -> decltype( ( b < a ) ? b : a ) { return ( b < a ) ? b : a; }
+template<class T, class L> inline auto max( const T &a, const L &b ) -> decltype( ( b < a ) ? a : b ) { return ( b < a ) ? a : b; }
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+unsigned long millis( void );
+unsigned long micros( void );
+void delay( unsigned long ms );
+void delayMicroseconds( unsigned int us );
+void yield( void );
+
+// The PC's own clock in us, for timing the code rather than the sketch's time
+unsigned long HostWallMicros( void );
+
+void pinMode( uint8_t pin, uint8_t mode );
+void digitalWrite( uint8_t pin, uint8_t value );
+int digitalRead( uint8_t pin );
+void analogWrite( uint8_t pin, int value );
+int analogRead( uint8_t pin );
+
+void tone( uint8_t pin, unsigned int frequency, unsigned long duration = 0 );
+void noTone( uint8_t pin );
+
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt( uint8_t pin, void (*isr)( void ), int mode );
+void detachInterrupt( uint8_t pin );
+
+// The hooks run between instructions, never in the middle of one
+inline void noInterrupts( void ) {}
+inline void interrupts( void ) {}
+
+class String
+{
+  public:
+    String( const char *str = "" );
+    String( const String &str );
+    explicit String( char c );
+    explicit String( int value, unsigned char base = DEC );
+    explicit String( unsigned int value, unsigned char base = DEC );
+    explicit String( long value, unsigned char base = DEC );
+    explicit String( unsigned long value, unsigned char base = DEC );
+    explicit String( float value, unsigned char decimals = 2 );
+    explicit String( double value, unsigned char decimals = 2 );
+    ~String();
+
+    String &operator=( const String &rhs );
+    String &operator+=( const String &rhs );
+    String &operator+=( const char *rhs );
+    String &operator+=( char c );
+
+    bool operator==( const String &rhs ) const { return strcmp( _buf, rhs._buf ) == 0; }
+    bool operator==( const char *rhs ) const { return strcmp( _buf, rhs ) == 0; }
+    bool operator!=( const String &rhs ) const { return !( *this == rhs ); }
+
+    const char *c_str() const { return _buf; }
+    unsigned int length() const { return _len; }
+    char charAt( unsigned int index ) const { return index < _len ? _buf[index] : 0; }
+    char operator[]( unsigned int index ) const { return charAt( index ); }
+    int indexOf( char c ) const;
+    String substring( unsigned int from, unsigned int to ) const;
+    String substring( unsigned int from ) const { return substring( from, _len ); }
+    long toInt() const { return atol( _buf ); }
+    float toFloat() const { return atof( _buf ); }
+    void trim();
+    void toUpperCase();
+
+  private:
+    char *_buf;
+    unsigned int _len;
+
+    void assign( const char *str, unsigned int len );
+    void append( const char *str, unsigned int len );
+};
+
+String operator+( const String &lhs, const String &rhs );
+String operator+( const String &lhs, const char *rhs );
+String operator+( const char *lhs, const String &rhs );
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write( uint8_t c ) = 0;
+    virtual size_t write( const uint8_t *buffer, size_t size );
+    size_t write( const char *str ) { return str == NULL ? 0 : write( (const uint8_t *)str, strlen( str ) ); }
+    size_t write( const char *buffer, size_t size ) { return write( (const uint8_t *)buffer, size ); }
+
+    size_t print( const char str[] ) { return write( str ); }
+    size_t print( char c ) { return write( (uint8_t)c ); }
+    size_t print( const String &s ) { return write( s.c_str() ); }
+    size_t print( unsigned char n, int base = DEC ) { return print( (unsigned long)n, base ); }
+    size_t print( int n, int base = DEC ) { return print( (long)n, base ); }
+    size_t print( unsigned int n, int base = DEC ) { return print( (unsigned long)n, base ); }
+    size_t print( long n, int base = DEC );
+    size_t print( unsigned long n, int base = DEC );
+    size_t print( double n, int digits = 2 );
+
+    size_t println( void ) { return write( "\r\n" ); }
+    template<class T> size_t println( const T &value ) { size_t n = print( value ); return n + println(); }
+    template<class T> size_t println( const T &value, int format ) { size_t n = print( value, format ); return n + println(); }
+    size_t println( const char str[] ) { size_t n = print( str ); return n + println(); }
+
+    virtual void flush() {}
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+// Input is queued up by the test, output goes to stdout if echo is on
+class HardwareSerial : public Stream
+{
+  public:
+    void begin( unsigned long baud ) { (void)baud; }
+    void end() {}
+
+    int available() override;
+    int read() override;
+    int peek() override;
+
+    size_t write( uint8_t c ) override;
+    size_t write( const uint8_t *buffer, size_t size ) override;
+    using Print::write;
+
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
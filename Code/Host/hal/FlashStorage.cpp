@@ -0,0 +1,57 @@
+// Host stand in for the SAMD21 NVM, the flash regions are const arrays in RAM
+// made writable. Erase sets a row to 0xFF and writes can only clear bits, as on
+// the chip, so code that forgets to erase first gets the same garbage it would.
+
+#include "FlashStorage.h"
+#include <sys/mman.h>
+#include <unistd.h>
+
+FlashClass::FlashClass(const void *flash_addr, uint32_t size) :
+  PAGE_SIZE(64),
+  PAGES(4096),
+  MAX_FLASH(PAGE_SIZE * PAGES),
+  ROW_SIZE(PAGE_SIZE * 4),
+  flash_address((volatile void *)flash_addr),
+  flash_size(size)
+{
+  if (flash_addr == NULL || size == 0)
+    return;
+
+  uintptr_t page = sysconf(_SC_PAGESIZE);
+  uintptr_t start = (uintptr_t)flash_addr & ~(page - 1);
+  uintptr_t end = ((uintptr_t)flash_addr + size + page - 1) & ~(page - 1);
+  mprotect((void *)start, end - start, PROT_READ | PROT_WRITE);
+}
+
+void FlashClass::write(const volatile void *flash_ptr, const void *data, uint32_t size)
+{
+  volatile uint8_t *dst = (volatile uint8_t *)flash_ptr;
+  const uint8_t *src = (const uint8_t *)data;
+
+  for (uint32_t i = 0; i < size; i++)
+    dst[i] &= src[i];
+}
+
+void FlashClass::erase(const volatile void *flash_ptr, uint32_t size)
+{
+  const uint8_t *ptr = (const uint8_t *)flash_ptr;
+  while (size > ROW_SIZE) {
+    erase(ptr);
+    ptr += ROW_SIZE;
+    size -= ROW_SIZE;
+  }
+  erase(ptr);
+}
+
+void FlashClass::erase(const volatile void *flash_ptr)
+{
+  // The whole row the address is in
+  volatile uint8_t *row = (volatile uint8_t *)((uintptr_t)flash_ptr & ~(uintptr_t)(ROW_SIZE - 1));
+  for (uint32_t i = 0; i < ROW_SIZE; i++)
+    row[i] = 0xFF;
+}
+
+void FlashClass::read(const volatile void *flash_ptr, void *data, uint32_t size)
+{
+  memcpy(data, (const void *)flash_ptr, size);
+}
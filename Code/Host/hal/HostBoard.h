@@ -0,0 +1,59 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Host Board
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  The test side of the host Arduino core, for moving the virtual clock on,
+  driving the input pins, hanging a MAX31855 off the bit bang pins and
+  talking to the serial port.
+
+  The tick hooks are called once a virtual ms, in the order they were added,
+  the same way the SysTick and timer interrupts would break in on the board.
+  ---------------------------------------------------------------------------
+*/
+#ifndef HostBoard_h
+#define HostBoard_h
+
+#include <Arduino.h>
+
+#define HOST_MAX_HOOKS 8
+#define HOST_MAX_CHIPS 4
+
+typedef void (*HostHook)( void );
+
+// What a MAX31855 would shift out right now, called as CS goes low
+typedef uint32_t (*HostFrameFunc)( uint8_t cs );
+
+// Move the clock on, running the hooks for every ms boundary passed
+void HostAdvance( unsigned long us );
+
+// Called every virtual ms, false if there is no room
+bool HostAddTickHook( HostHook hook );
+
+// Forget the hooks, chips and serial input, and start the clock at 0 again
+void HostReset( void );
+
+// How many times the code has waited in yield() since the last reset
+unsigned long HostYields( void );
+
+// Drive an input pin from outside, runs the pin change interrupt if there is one
+void HostSetPin( uint8_t pin, uint8_t value );
+uint8_t HostGetPin( uint8_t pin );
+
+// Time of the last change of an output pin, us
+unsigned long HostPinChanged( uint8_t pin );
+
+// Emulate a MAX31855 on the bit bang pins
+bool HostAddMax31855( uint8_t sclk, uint8_t cs, uint8_t miso, HostFrameFunc frameFunc );
+
+// Queue up bytes for Serial.read()
+void HostSerialInput( const char *text );
+
+// Send what the sketch prints to stdout, off by default
+void HostSerialEcho( bool echo );
+
+#endif
@@ -0,0 +1,58 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Host SPI
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  An SPI port with nothing on it, every byte read back is 0, unless a test
+  attaches a device to answer the bytes sent.
+  ---------------------------------------------------------------------------
+*/
+#ifndef SPI_h
+#define SPI_h
+
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define SPI_MODE0 0x02
+
+class SPISettings
+{
+  public:
+    SPISettings() {}
+    SPISettings( uint32_t clock, uint8_t bitOrder, uint8_t dataMode ) { (void)clock; (void)bitOrder; (void)dataMode; }
+};
+
+// Given each byte sent, returns the byte read back
+typedef uint8_t (*HostSPIDevice)( uint8_t data );
+
+class SPIClass
+{
+  public:
+    void begin() {}
+    void end() {}
+    void beginTransaction( SPISettings settings ) { (void)settings; _transaction = true; }
+    void endTransaction() { _transaction = false; }
+    uint8_t transfer( uint8_t data ) { return _device != NULL ? _device( data ) : 0; }
+    uint16_t transfer16( uint16_t data )
+    {
+      uint16_t high = transfer( data >> 8 );
+      return ( high << 8 ) | transfer( data & 0xFF );
+    }
+
+    // For tests, the device on the bus and whether a transaction is open
+    void hostAttach( HostSPIDevice device ) { _device = device; }
+    bool hostInTransaction() const { return _transaction; }
+
+  private:
+    HostSPIDevice _device = NULL;
+    bool _transaction = false;
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Reflow Master sketch to C++
+
+Does what the Arduino builder does to the sketch before compiling it: adds
+the Arduino.h include and a prototype for every function ahead of the first
+one, so functions can be called before they're defined. Default arguments
+stay on the prototypes and come off the definitions.
+
+  python3 ino2cpp.py Reflow_Master_v2.ino Reflow_Master_v2.cpp [--wrap NAME]...
+
+--wrap renames the definition of NAME to NAME_wrapped and leaves the calls
+alone, so a test can define NAME itself, count the calls and pass them on.
+"""
+import re
+import sys
+
+KEYWORDS = ("if", "else", "while", "for", "switch", "case", "return", "do", "sizeof")
+
+# A definition starts in the first column, with the body brace on the same line or the next
+FUNCTION = re.compile(r"^([A-Za-z_][\w:<>\*&\s]*?)\s+([\*&]*)(\w+)\s*\(([^;{}()]*)\)\s*\n?\s*\{", re.M)
+
+
+def convert(source, path, wrap=()):
+    functions = []
+    for m in FUNCTION.finditer(source):
+        ret, name = m.group(1).strip(), m.group(3)
+        if ret in KEYWORDS or name in KEYWORDS or ret.startswith(("class", "struct", "typedef", "enum")):
+            continue
+        functions.append(m)
+
+    header = '#include <Arduino.h>\n#line 1 "%s"\n' % path
+    if not functions:
+        return header + source
+
+    prototypes = []
+    for m in functions:
+        names = [m.group(3)] + ([m.group(3) + "_wrapped"] if m.group(3) in wrap else [])
+        prototypes += ["%s %s%s(%s);" % (m.group(1).strip(), m.group(2), n, m.group(4)) for n in names]
+
+    # Defaults off the definitions, from the end so the offsets still hold
+    body = source
+    for m in reversed(functions):
+        if "=" in m.group(4):
+            start, end = m.span(4)
+            body = body[:start] + re.sub(r"\s*=\s*[^,]+", "", m.group(4)) + body[end:]
+        if m.group(3) in wrap:
+            start, end = m.span(3)
+            body = body[:start] + m.group(3) + "_wrapped" + body[end:]
+
+    first = functions[0].start()
+    line = source.count("\n", 0, first) + 1
+    return (header + body[:first] + "\n".join(prototypes) + "\n" +
+            '#line %d "%s"\n' % (line, path) + body[first:])
+
+
+def main():
+    args = sys.argv[1:]
+    wrap = []
+    while "--wrap" in args:
+        i = args.index("--wrap")
+        if i + 1 >= len(args):
+            break
+        wrap.append(args[i + 1])
+        del args[i:i + 2]
+
+    if len(args) != 2:
+        print(__doc__)
+        return 1
+
+    with open(args[0]) as f:
+        source = f.read()
+    with open(args[1], "w") as f:
+        f.write(convert(source, args[0], wrap))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
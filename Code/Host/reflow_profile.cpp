@@ -0,0 +1,83 @@
+// Runs the profiler's scenarios on the host build and prints each one's section timings as it ends.
+//
+//   reflow_profile [--paste N] > host.log
+//   python3 ../Tools/profile_diff.py old.log host.log
+//
+// Built with PROFILER, timed on the PC's clock. Goes through menu idle, a
+// profile switch over every built in paste, a whole reflow (warmup and
+// reflow), and a few minutes of bake, pressing the buttons the way a user
+// would where it can. The output is what the board prints over serial, so
+// two builds can be compared with profile_diff.py the same way.
+//
+// Exits 0 if every scenario ran and the reflow finished.
+
+#include "Reflow_Master_v2.cpp"
+#include "SimHarness.h"
+
+static bool RunOver()
+{
+  return state == FINISHED || state == ABORT || state == MENU;
+}
+
+int main( int argc, char **argv )
+{
+  int paste = 4;
+  for ( int i = 1; i < argc; i++ )
+  {
+    if ( strcmp( argv[i], "--paste" ) == 0 && i + 1 < argc )
+      paste = atoi( argv[++i] );
+    else
+    {
+      printf( "reflow_profile [--paste N]\n" );
+      return 2;
+    }
+  }
+
+  // The reports go out over serial as each scenario ends, profile_diff.py skips anything else printed
+  HostSerialEcho( true );
+  SimBegin();
+  profiler.setReport( &Serial );
+
+  // menu idle
+  SimRunFor( 10000 );
+
+  // profile switch, through every paste and back to the one to run
+  ShowPaste();
+  for ( int i = 0; i < (int)ELEMENTS( solderPaste ); i++ )
+  {
+    SetCurrentGraph( i );
+    SimRunFor( 200 );
+  }
+  set.paste = paste;
+  SetCurrentGraph( paste );
+  ShowMenu();
+  SimRunFor( 1000 );
+
+  // warmup and reflow
+  SimPress( BUTTON0 );
+  if ( state != WARMUP )
+  {
+    printf( "FAIL: START didn't start a reflow, state %d\n", state );
+    return 1;
+  }
+  SimRunUntil( RunOver, 3600000UL );
+  bool finished = state == FINISHED;
+
+  // bake, a few minutes of it
+  ShowMenu();
+  SimRunFor( 1000 );
+  set.bakeTime = 300;
+  state = BAKE;
+  StartBake();
+  SimRunFor( 180000 );
+
+  // The bake is still going, so it hasn't been reported yet
+  profiler.print( Serial );
+
+  if ( !finished )
+  {
+    printf( "FAIL: the reflow didn't finish\n" );
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+// Runs a reflow headless on the host build, against the simulated oven, as fast as the PC goes.
+//
+//   reflow_sim [--paste N] [--pid] [--trace]
+//
+// Exits 0 if the run went from START to FINISHED without an abort.
+
+#include "Reflow_Master_v2.cpp"
+#include "SimHarness.h"
+
+#include <chrono>
+
+static bool RunOver()
+{
+  return state == FINISHED || state == ABORT || state == MENU;
+}
+
+int main( int argc, char **argv )
+{
+  int paste = 0;
+  bool pid = false;
+  bool trace = false;
+
+  for ( int i = 1; i < argc; i++ )
+  {
+    if ( strcmp( argv[i], "--paste" ) == 0 && i + 1 < argc )
+      paste = atoi( argv[++i] );
+    else if ( strcmp( argv[i], "--pid" ) == 0 )
+      pid = true;
+    else if ( strcmp( argv[i], "--trace" ) == 0 )
+      trace = true;
+    else
+    {
+      printf( "reflow_sim [--paste N] [--pid] [--trace]\n" );
+      return 2;
+    }
+  }
+
+  auto wallStart = std::chrono::steady_clock::now();
+
+  SimBegin();
+  SimRunFor( 3000 );
+
+  set.controller = pid ? CONTROLLER_PID : CONTROLLER_HEURISTIC;
+  set.paste = paste;
+  SetCurrentGraph( paste );
+
+  printf( "%s, %s controller\n", CurrentGraph().n, pid ? "PID" : "heuristic" );
+
+  // Start it the way a user would
+  SimPress( BUTTON0 );
+  if ( state != WARMUP )
+  {
+    printf( "FAIL: START didn't start a reflow, state %d\n", state );
+    return 1;
+  }
+
+  unsigned long start = millis();
+  float peak = 0;
+  while ( !RunOver() && millis() - start < 3600000UL )
+  {
+    SimRunFor( 1000 );
+    peak = max( peak, simOven.getTemperature() );
+
+    if ( trace )
+      printf( "%6.1f state %2d time %5.1f temp %6.2f wanted %6.2f relay %u fan %u\n", ( millis() - start ) / 1000.0, state, timeX, currentTemp, currentWantedTemp, (unsigned)relayOutput.getDuty(), HostGetPin( FAN ) );
+  }
+
+  double wall = std::chrono::duration<double>( std::chrono::steady_clock::now() - wallStart ).count();
+  printf( "State %d after %.0fs of oven time, %.3fs on the PC\n", state, ( millis() - start ) / 1000.0, wall );
+  printf( "Peak %.1fc, liquidus %dc\n", peak, CurrentGraph().tempDeg );
+
+  if ( state != FINISHED )
+  {
+    printf( "FAIL: the run didn't finish\n" );
+    return 1;
+  }
+
+  printf( "PASS\n" );
+  return 0;
+}
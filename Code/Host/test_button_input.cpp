@@ -0,0 +1,207 @@
+// Steps ButtonInput::tick() a ms at a time against pins driven from here, and checks the events it queues.
+
+#include "ButtonInput.h"
+#include "HostBoard.h"
+#include "check.h"
+
+#define DEBOUNCE 20
+#define LONG_PRESS 800
+#define REPEAT 100
+
+static const uint8_t pins[] = { 14, 15, 16, 17 };
+
+static unsigned long now = 0;
+
+// A tick every ms up to ms from now, as the SysTick hook does
+static void Run( ButtonInput &input, unsigned long ms )
+{
+  for ( unsigned long end = now + ms; now < end; )
+  {
+    now++;
+    input.tick( now );
+  }
+}
+
+static int Count( ButtonInput &input, uint8_t type, uint8_t button = 0xFF )
+{
+  int count = 0;
+  ButtonEvent event;
+  while ( input.read( event ) )
+  {
+    if ( event.type == type && ( button == 0xFF || event.button == button ) )
+      count++;
+  }
+  return count;
+}
+
+static bool Empty( ButtonInput &input )
+{
+  ButtonEvent event;
+  return !input.read( event );
+}
+
+int main()
+{
+  HostReset();
+  ButtonInput input( pins, 4 );
+  input.begin( DEBOUNCE, LONG_PRESS, REPEAT );
+  Run( input, 100 );
+  CHECK( Empty( input ) );
+
+  // A click goes in when the button is let go, not before. A pin change is
+  // seen on the next tick, and settles DEBOUNCE ms after that
+  HostSetPin( pins[1], HIGH );
+  Run( input, 100 );
+  CHECK( Empty( input ) );
+  HostSetPin( pins[1], LOW );
+  Run( input, DEBOUNCE );
+  CHECK( Empty( input ) );
+  Run( input, 1 );
+  ButtonEvent event;
+  CHECK( input.read( event ) );
+  CHECK( event.button == 1 && event.type == BUTTON_CLICK );
+  CHECK( Empty( input ) );
+
+  // Contact bounce on the way down and up is still one click
+  for ( int i = 0; i < 6; i++ )
+  {
+    HostSetPin( pins[0], i % 2 == 0 ? HIGH : LOW );
+    Run( input, 3 );
+  }
+  HostSetPin( pins[0], HIGH );
+  Run( input, 100 );
+  for ( int i = 0; i < 6; i++ )
+  {
+    HostSetPin( pins[0], i % 2 == 0 ? LOW : HIGH );
+    Run( input, 3 );
+  }
+  HostSetPin( pins[0], LOW );
+  Run( input, 100 );
+  CHECK( Count( input, BUTTON_CLICK, 0 ) == 1 );
+
+  // A glitch shorter than the debounce is nothing
+  HostSetPin( pins[2], HIGH );
+  Run( input, DEBOUNCE / 2 );
+  HostSetPin( pins[2], LOW );
+  Run( input, 100 );
+  CHECK( Empty( input ) );
+
+  // Held, the long press starts LONG_PRESS after it settled, then repeats every REPEAT
+  HostSetPin( pins[3], HIGH );
+  Run( input, DEBOUNCE + LONG_PRESS );
+  CHECK( Empty( input ) );
+  Run( input, 1 );
+  CHECK( input.read( event ) );
+  CHECK( event.button == 3 && event.type == BUTTON_LONG_START );
+  Run( input, REPEAT - 1 );
+  CHECK( Empty( input ) );
+  Run( input, 1 );
+  CHECK( input.read( event ) );
+  CHECK( event.button == 3 && event.type == BUTTON_REPEAT );
+
+  // At the fixed rate, however the reading keeps up
+  Run( input, REPEAT * 5 );
+  CHECK( Count( input, BUTTON_REPEAT, 3 ) == 5 );
+
+  // Letting go of a long press isn't a click
+  HostSetPin( pins[3], LOW );
+  Run( input, 100 );
+  CHECK( Empty( input ) );
+
+  // Idle, the tick does nothing until a pin change wakes it, so with the
+  // interrupt off a press goes unseen until something calls wake()
+  detachInterrupt( pins[0] );
+  HostSetPin( pins[0], HIGH );
+  Run( input, 100 );
+  HostSetPin( pins[0], LOW );
+  Run( input, 100 );
+  CHECK( Empty( input ) );
+  HostSetPin( pins[0], HIGH );
+  Run( input, 100 );
+  input.wake();
+  Run( input, 100 );
+  HostSetPin( pins[0], LOW );
+  Run( input, 100 );
+  CHECK( Count( input, BUTTON_CLICK, 0 ) == 1 );
+  input.begin( DEBOUNCE, LONG_PRESS, REPEAT );
+
+  // Two buttons at once are kept apart, and come out in the order they happened
+  HostSetPin( pins[0], HIGH );
+  Run( input, 50 );
+  HostSetPin( pins[2], HIGH );
+  Run( input, 50 );
+  HostSetPin( pins[2], LOW );
+  Run( input, 50 );
+  HostSetPin( pins[0], LOW );
+  Run( input, 50 );
+  CHECK( input.read( event ) && event.button == 2 && event.type == BUTTON_CLICK );
+  CHECK( input.read( event ) && event.button == 0 && event.type == BUTTON_CLICK );
+  CHECK( Empty( input ) );
+
+  // A held button only fills half the queue with repeats, so clicks still get in
+  HostSetPin( pins[1], HIGH );
+  Run( input, DEBOUNCE + LONG_PRESS + REPEAT * 20 );
+  CHECK( input.getDropped() > 0 );
+  unsigned long dropped = input.getDropped();
+  HostSetPin( pins[2], HIGH );
+  Run( input, 50 );
+  HostSetPin( pins[2], LOW );
+  Run( input, 50 );
+  HostSetPin( pins[1], LOW );
+  Run( input, 50 );
+  int events = 0, clicks = 0;
+  while ( input.read( event ) )
+  {
+    events++;
+    if ( event.type == BUTTON_CLICK && event.button == 2 )
+      clicks++;
+  }
+  CHECK( events == BUTTON_QUEUE / 2 + 1 );
+  CHECK( clicks == 1 );
+  CHECK( input.getDropped() > dropped );
+
+  // Clicks fill it to one short of full, and the rest are counted as dropped
+  dropped = input.getDropped();
+  for ( int i = 0; i < BUTTON_QUEUE + 4; i++ )
+  {
+    HostSetPin( pins[0], HIGH );
+    Run( input, 50 );
+    HostSetPin( pins[0], LOW );
+    Run( input, 50 );
+  }
+  CHECK( Count( input, BUTTON_CLICK, 0 ) == BUTTON_QUEUE - 1 );
+  CHECK( input.getDropped() - dropped == 5 );
+
+  // Active low buttons, pressed is LOW
+  HostReset();
+  for ( uint8_t pin : pins )
+    HostSetPin( pin, HIGH );
+  ButtonInput low( pins, 4, true );
+  low.begin( DEBOUNCE, LONG_PRESS, REPEAT );
+  Run( low, 100 );
+  CHECK( Empty( low ) );
+  HostSetPin( pins[2], LOW );
+  Run( low, 100 );
+  HostSetPin( pins[2], HIGH );
+  Run( low, 100 );
+  CHECK( low.read( event ) && event.button == 2 && event.type == BUTTON_CLICK );
+  CHECK( Empty( low ) );
+
+  // Boards without the SysTick hook call poll() from the loop, which ticks once per ms of the clock
+  HostSetPin( pins[1], LOW );
+  for ( int ms = 0; ms < DEBOUNCE + LONG_PRESS + REPEAT * 3 + 50; ms++ )
+  {
+    HostAdvance( 1000 );
+    low.poll();
+  }
+  HostSetPin( pins[1], HIGH );
+  for ( int ms = 0; ms < 100; ms++ )
+  {
+    HostAdvance( 1000 );
+    low.poll();
+  }
+  CHECK( low.read( event ) && event.button == 1 && event.type == BUTTON_LONG_START );
+  CHECK( Count( low, BUTTON_REPEAT, 1 ) == 3 );
+
+  return CheckResult();
+}
@@ -0,0 +1,189 @@
+// Decodes canned MAX31855 frames through a mock transport, and reads them back through the bit bang and hardware SPI transports.
+//
+// The readings are the datasheet's examples of the thermocouple and cold
+// junction words.
+
+#include "MAX31855.h"
+#include "HostBoard.h"
+#include "check.h"
+
+// Hands out the frames it's given, one per read
+class MockTransport : public MAX31855Transport
+{
+  public:
+    void begin() { began = true; }
+    uint32_t read32() { reads++; return frame; }
+
+    uint32_t frame = 0;
+    int reads = 0;
+    bool began = false;
+};
+
+// The chip's frame, temp in 1/4C, internal in 1/16C, both two's complement
+static uint32_t Frame( int16_t temp, int16_t internal, uint8_t status = STATUS_OK )
+{
+  uint32_t frame = ( (uint32_t)( temp & 0x3FFF ) << 18 ) | ( (uint32_t)( internal & 0x0FFF ) << 4 ) | ( status & 0x07 );
+  if ( status & 0x07 )
+    frame |= 1ul << 16;
+  return frame;
+}
+
+typedef struct {
+  uint16_t word; // As the datasheet gives it
+  float temp;
+} Example;
+
+// Thermocouple temperature data format, MAX31855 datasheet table 4
+static const Example tcExamples[] = {
+  { 0x1900, 1600 }, { 0x0FA0, 1000 }, { 0x0193, 100.75 }, { 0x0064, 25 },
+  { 0x0000, 0 }, { 0x3FFF, -0.25 }, { 0x3FFC, -1 }, { 0x3C18, -250 },
+};
+
+// Reference junction temperature data format, table 5
+static const Example internalExamples[] = {
+  { 0x7F0, 127 }, { 0x649, 100.5625 }, { 0x190, 25 }, { 0x000, 0 },
+  { 0xFFF, -0.0625 }, { 0xFF0, -1 }, { 0xEC0, -20 }, { 0xC90, -55 },
+};
+
+static uint32_t gpioFrame = 0;
+
+static uint32_t GPIOFrame( uint8_t cs )
+{
+  (void)cs;
+  return gpioFrame;
+}
+
+// The chip on the hardware SPI bus, shifting the frame out MSB first while its CS is low
+static const uint8_t spiCs = 9;
+static uint32_t spiFrame = 0;
+static int spiBytes = 0;
+static bool spiSelected = true;
+
+static uint8_t SPIDevice( uint8_t data )
+{
+  (void)data;
+  spiSelected = spiSelected && HostGetPin( spiCs ) == LOW && SPI.hostInTransaction();
+  uint8_t out = spiFrame >> ( 24 - 8 * ( spiBytes % 4 ) );
+  spiBytes++;
+  return out;
+}
+
+int main()
+{
+  MockTransport mock;
+  MAX31855 tc( mock );
+
+  // Nothing read yet
+  CHECK( tc.getStatus() == STATUS_NOREAD );
+
+  tc.begin();
+  CHECK( mock.began );
+
+  for ( const Example &e : tcExamples )
+  {
+    mock.frame = Frame( e.word, 0x190 );
+    CHECK( tc.read() == STATUS_OK );
+    CHECK_NEAR( tc.getTemperature(), e.temp, 0 );
+    CHECK_NEAR( tc.getRawTemperature(), e.temp * 4, 0 );
+    CHECK_NEAR( tc.getInternal(), 25, 0 );
+  }
+
+  for ( const Example &e : internalExamples )
+  {
+    mock.frame = Frame( 0x0064, e.word );
+    CHECK( tc.read() == STATUS_OK );
+    CHECK_NEAR( tc.getInternal(), e.temp, 0 );
+    CHECK_NEAR( tc.getRawInternal(), e.temp * 16, 0 );
+    CHECK_NEAR( tc.getTemperature(), 25, 0 );
+  }
+  CHECK( mock.reads == 16 );
+
+  // Each fault is its own status bit, the cold junction still reads
+  const uint8_t faults[] = { STATUS_OPEN_CIRCUIT, STATUS_SHORT_TO_GND, STATUS_SHORT_TO_VCC };
+  for ( uint8_t fault : faults )
+  {
+    mock.frame = Frame( 0, 0x190, fault );
+    CHECK( tc.read() == fault );
+    CHECK( tc.getStatus() == fault );
+    CHECK_NEAR( tc.getInternal(), 25, 0 );
+  }
+
+  // readFrame() and decode() are read() in two
+  mock.frame = Frame( 0x0193, 0x190 );
+  CHECK( tc.decode( tc.readFrame() ) == STATUS_OK );
+  CHECK_NEAR( tc.getTemperature(), 100.75, 0 );
+
+  // The offset goes on the decoded temperature
+  tc.setOffset( -2.5 );
+  CHECK( tc.read() == STATUS_OK );
+  CHECK_NEAR( tc.getTemperature(), 98.25, 0 );
+  tc.setOffset( 0 );
+
+  // A linear factor for other thermocouple types, on the read
+  tc.setTCfactor( J_TC );
+  CHECK( tc.read() == STATUS_OK );
+  CHECK_NEAR( tc.getTemperature(), 100.75 * J_TC, 0.001 );
+  tc.setTCfactor( K_TC );
+
+  // With a table the reading goes through the NIST linearization, in 1/64C
+  const TCTable *table = TCTableFor( 'K' );
+  CHECK( table != NULL );
+  tc.setTable( table );
+  mock.frame = Frame( 0x0FA0, 0x190 );
+  CHECK( tc.read() == STATUS_OK );
+  CHECK_NEAR( tc.getTemperature(), TCLinearize( *table, 0x0FA0, 0x190 ) / 64.0, 0 );
+
+  // But not on a fault, which just gives the raw reading back
+  mock.frame = Frame( 0x0FA0, 0x190, STATUS_OPEN_CIRCUIT );
+  CHECK( tc.read() == STATUS_OPEN_CIRCUIT );
+  CHECK_NEAR( tc.getTemperature(), 1000, 0 );
+  tc.setTable( NULL );
+
+  // The bit bang transport clocks the same frames out of an emulated chip
+  const uint8_t sclk = 12, cs = 10, miso = 11;
+  HostReset();
+  HostAddMax31855( sclk, cs, miso, GPIOFrame );
+
+  MAX31855 gpio( sclk, cs, miso );
+  gpio.begin();
+  CHECK( HostGetPin( cs ) == HIGH );
+
+  const uint32_t frames[] = { Frame( 0x0193, 0x649 ), Frame( 0x3C18, 0xC90 ), Frame( 0, 0x190, STATUS_SHORT_TO_VCC ), 0xFFFFFFFF, 0 };
+  for ( uint32_t frame : frames )
+  {
+    gpioFrame = frame;
+    CHECK( gpio.readFrame() == frame );
+    CHECK( HostGetPin( cs ) == HIGH );
+  }
+
+  gpioFrame = Frame( 0x3C18, 0xC90 );
+  CHECK( gpio.read() == STATUS_OK );
+  CHECK_NEAR( gpio.getTemperature(), -250, 0 );
+  CHECK_NEAR( gpio.getInternal(), -55, 0 );
+
+  // The hardware SPI transport reads the frame as 4 bytes in one transaction, CS low for all of it
+  SPI.hostAttach( SPIDevice );
+  MAX31855_HWSPI hwspi( SPI, spiCs );
+  MAX31855 spi( hwspi );
+  spi.begin();
+  CHECK( HostGetPin( spiCs ) == HIGH );
+
+  for ( uint32_t frame : frames )
+  {
+    spiFrame = frame;
+    spiBytes = 0;
+    CHECK( spi.readFrame() == frame );
+    CHECK( spiBytes == 4 );
+    CHECK( HostGetPin( spiCs ) == HIGH );
+    CHECK( !SPI.hostInTransaction() );
+  }
+  CHECK( spiSelected );
+
+  spiFrame = Frame( 0x0193, 0x649 );
+  CHECK( spi.read() == STATUS_OK );
+  CHECK_NEAR( spi.getTemperature(), 100.75, 0 );
+  CHECK_NEAR( spi.getInternal(), 100.5625, 0 );
+  SPI.hostAttach( NULL );
+
+  return CheckResult();
+}
@@ -0,0 +1,176 @@
+// Checks the half cycles RelayPattern turns on, in both modes, and RelayOutput driving a pin from them.
+
+#include "RelayOutput.h"
+#include "HostBoard.h"
+#include "check.h"
+
+#define RELAY_PIN 5
+
+// Run a pattern for ticks, counting the on ticks and the longest runs on and off
+typedef struct {
+  unsigned long on;
+  unsigned long longestOn;
+  unsigned long longestOff;
+} PatternRun;
+
+static PatternRun Run( RelayPattern &pattern, unsigned long ticks )
+{
+  PatternRun run = { 0, 0, 0 };
+  unsigned long onRun = 0, offRun = 0;
+  for ( unsigned long i = 0; i < ticks; i++ )
+  {
+    if ( pattern.next() )
+    {
+      run.on++;
+      onRun++;
+      offRun = 0;
+    }
+    else
+    {
+      offRun++;
+      onRun = 0;
+    }
+    run.longestOn = max( run.longestOn, onRun );
+    run.longestOff = max( run.longestOff, offRun );
+  }
+  return run;
+}
+
+int main()
+{
+  RelayPattern pattern;
+
+  // Burst is exact over 255 ticks for every duty, and spread out as evenly as it can be
+  for ( int duty = 0; duty <= 255; duty++ )
+  {
+    pattern.begin( RELAY_BURST, 100 );
+    pattern.setDuty( duty );
+    PatternRun run = Run( pattern, 255 * 4 );
+    CHECK( run.on == (unsigned long)duty * 4 );
+    if ( duty > 0 )
+      CHECK( run.longestOff <= (unsigned long)( 255 + duty - 1 ) / duty );
+    if ( duty < 255 )
+      CHECK( run.longestOn <= (unsigned long)( 255 + ( 255 - duty ) - 1 ) / ( 255 - duty ) );
+  }
+
+  // Just over half power is every other half cycle, with the odd extra one
+  pattern.begin( RELAY_BURST, 100 );
+  pattern.setDuty( 128 );
+  PatternRun half = Run( pattern, 1000 );
+  CHECK( half.longestOff == 1 );
+  CHECK( half.longestOn <= 2 );
+
+  // The on ticks in the last full window are reported
+  pattern.begin( RELAY_BURST, 100 );
+  pattern.setDuty( 51 );
+  Run( pattern, 100 );
+  CHECK( pattern.getLastOnTicks() == 20 );
+  Run( pattern, 50 );
+  CHECK( pattern.getLastOnTicks() == 20 );
+
+  // Window is on for the first duty/255 of each window, then off
+  for ( int duty = 0; duty <= 255; duty += 5 )
+  {
+    pattern.begin( RELAY_WINDOW, 100 );
+    pattern.setDuty( duty );
+    unsigned long expect = ( duty * 100 + 127 ) / 255;
+    for ( int w = 0; w < 3; w++ )
+    {
+      for ( unsigned long t = 0; t < 100; t++ )
+        CHECK( pattern.next() == ( t < expect ) );
+      CHECK( pattern.getLastOnTicks() == expect );
+    }
+  }
+
+  // And only takes a new duty at the start of a window
+  pattern.begin( RELAY_WINDOW, 10 );
+  pattern.setDuty( 255 );
+  CHECK( Run( pattern, 5 ).on == 5 );
+  pattern.setDuty( 0 );
+  CHECK( Run( pattern, 5 ).on == 5 );
+  CHECK( Run( pattern, 10 ).on == 0 );
+
+  // A window of 0 ticks is 1
+  pattern.begin( RELAY_WINDOW, 0 );
+  CHECK( pattern.getWindow() == 1 );
+  CHECK( pattern.getMode() == RELAY_WINDOW );
+
+  // RelayOutput ticks the pattern every half cycle off the clock, 50Hz mains, 1s window
+  HostReset();
+  RelayOutput relay( RELAY_PIN );
+  relay.begin( RELAY_BURST, 50, 1000 );
+  CHECK( relay.getWindowTime() == 1000 );
+  CHECK( HostGetPin( RELAY_PIN ) == LOW );
+
+  relay.setDuty( 255 );
+  for ( int ms = 0; ms < 1000; ms++ )
+  {
+    HostAdvance( 1000 );
+    relay.poll();
+  }
+  CHECK( HostGetPin( RELAY_PIN ) == HIGH );
+  CHECK( relay.getLastOnTime() == 1000 );
+
+  relay.setDuty( 64 );
+  for ( int ms = 0; ms < 2000; ms++ )
+  {
+    HostAdvance( 1000 );
+    relay.poll();
+  }
+  CHECK_NEAR( relay.getLastOnTime(), 1000 * 64 / 255.0, 10 );
+
+  // off() drops the pin there and then, and it stays down
+  relay.setDuty( 255 );
+  HostAdvance( 10000 );
+  relay.poll();
+  CHECK( HostGetPin( RELAY_PIN ) == HIGH );
+  relay.off();
+  CHECK( HostGetPin( RELAY_PIN ) == LOW );
+  CHECK( relay.getDuty() == 0 );
+  for ( int ms = 0; ms < 1000; ms++ )
+  {
+    HostAdvance( 1000 );
+    relay.poll();
+    CHECK( HostGetPin( RELAY_PIN ) == LOW );
+  }
+
+  // In window mode too, off() ends the window it's in rather than waiting for the next one
+  relay.begin( RELAY_WINDOW, 50, 1000 );
+  relay.setDuty( 255 );
+  for ( int ms = 0; ms < 1500; ms++ )
+  {
+    HostAdvance( 1000 );
+    relay.poll();
+  }
+  CHECK( HostGetPin( RELAY_PIN ) == HIGH );
+  relay.off();
+  CHECK( HostGetPin( RELAY_PIN ) == LOW );
+  for ( int ms = 0; ms < 2000; ms++ )
+  {
+    HostAdvance( 1000 );
+    relay.poll();
+    CHECK( HostGetPin( RELAY_PIN ) == LOW );
+  }
+
+  // And a new duty after it starts a window of its own
+  relay.setDuty( 128 );
+  unsigned long on = 0;
+  for ( int ms = 0; ms < 1000; ms++ )
+  {
+    HostAdvance( 1000 );
+    relay.poll();
+    if ( HostGetPin( RELAY_PIN ) == HIGH )
+      on++;
+  }
+  CHECK_NEAR( on, 500, 20 );
+
+  // RelayPattern on its own, off() part way through a window
+  pattern.begin( RELAY_WINDOW, 100 );
+  pattern.setDuty( 255 );
+  CHECK( Run( pattern, 30 ).on == 30 );
+  pattern.off();
+  CHECK( pattern.getDuty() == 0 );
+  CHECK( Run( pattern, 300 ).on == 0 );
+
+  return CheckResult();
+}
@@ -0,0 +1,141 @@
+// Checks RunHistory against the samples that went into it, for a reflow that fits the base level and a bake that sheds it.
+
+#include "RunHistory.h"
+#include "check.h"
+
+#include <vector>
+
+typedef struct {
+  float seconds;
+  float temp; // as stored, in 1/4 C from 0 to 1023.75
+} Sample;
+
+static float Quantize( float temp )
+{
+  return constrain( (long)( temp * 4 + 0.5f ), 0L, 4094L ) / 4.0f;
+}
+
+// A reflow shaped curve with some noise on it, for however long
+static float Curve( float seconds, float length )
+{
+  float x = seconds / length;
+  return 25 + 220 * sin( x * 3.14159f ) + ( ( (int)seconds * 7919 ) % 13 ) * 0.25f;
+}
+
+static std::vector<Sample> Record( RunHistory &history, float length, float step )
+{
+  std::vector<Sample> samples;
+  for ( float t = 0; t < length; t += step )
+  {
+    float temp = Curve( t, length );
+    history.add( t, temp );
+    samples.push_back( { t, Quantize( temp ) } );
+  }
+  return samples;
+}
+
+// The min and max of the samples from t0 to t1, false if there aren't any
+static bool Actual( const std::vector<Sample> &samples, float t0, float t1, float &lo, float &hi )
+{
+  bool any = false;
+  for ( const Sample &s : samples )
+  {
+    if ( s.seconds < t0 || s.seconds >= t1 )
+      continue;
+    lo = any ? min( lo, s.temp ) : s.temp;
+    hi = any ? max( hi, s.temp ) : s.temp;
+    any = true;
+  }
+  return any;
+}
+
+// span() works in whole buckets no longer than the window, so it has to cover
+// every sample in the window, and can only reach a bucket past either end of it
+static void CheckSpans( const RunHistory &history, const std::vector<Sample> &samples )
+{
+  float length = history.getLength();
+  for ( float window = 0.5f; window <= length; window *= 1.7f )
+  {
+    for ( float t0 = 0; t0 + window <= length; t0 += window * 0.6f + 1 )
+    {
+      float t1 = t0 + window;
+      float lo = 0, hi = 0, inLo = 0, inHi = 0, outLo = 0, outHi = 0;
+      if ( !Actual( samples, t0, t1, inLo, inHi ) )
+        continue;
+
+      CHECK( history.span( t0, t1, lo, hi ) );
+      CHECK( lo <= inLo && hi >= inHi );
+
+      float reach = max( (float)history.getScale(), window );
+      CHECK( Actual( samples, t0 - reach, t1 + reach, outLo, outHi ) );
+      CHECK( lo >= outLo && hi <= outHi );
+    }
+  }
+}
+
+int main()
+{
+  static RunHistory history;
+
+  // Nothing recorded yet
+  float lo = 0, hi = 0;
+  CHECK( !history.hasRun() );
+  CHECK( history.getLength() == 0 );
+  CHECK( !history.span( 0, 100, lo, hi ) );
+
+  // A 6 minute reflow at 4 samples a second stays at 1 second a bucket
+  history.begin( 1, 3 );
+  CHECK( history.getType() == 1 && history.getPaste() == 3 );
+  std::vector<Sample> reflow = Record( history, 360, 0.25f );
+  CHECK( history.hasRun() );
+  CHECK( history.getScale() == 1 );
+  CHECK( history.getLength() == 360 );
+
+  // Each second on its own is exactly its own samples
+  for ( int s = 0; s < 360; s++ )
+  {
+    float inLo = 0, inHi = 0;
+    CHECK( Actual( reflow, s, s + 1, inLo, inHi ) );
+    CHECK( history.span( s, s + 1, lo, hi ) );
+    CHECK( lo == inLo && hi == inHi );
+  }
+
+  // The whole run is the whole run, and past the end is nothing
+  float allLo = 0, allHi = 0;
+  CHECK( Actual( reflow, 0, 360, allLo, allHi ) );
+  CHECK( history.span( 0, history.getLength(), lo, hi ) );
+  CHECK( lo == allLo && hi == allHi );
+  CHECK( !history.span( 400, 500, lo, hi ) );
+  CHECK( !history.span( 100, 100, lo, hi ) );
+
+  CheckSpans( history, reflow );
+
+  // A 3 hour bake at a sample a second sheds the base level down to 32 seconds a bucket
+  history.begin( 2, 0 );
+  CHECK( !history.hasRun() );
+  CHECK( history.getType() == 2 );
+  std::vector<Sample> bake = Record( history, 3 * 3600, 1 );
+  CHECK( history.getScale() == 32 );
+  CHECK( history.getLength() >= 3 * 3600 && history.getLength() < 3 * 3600 + 32 );
+
+  CHECK( Actual( bake, 0, 3 * 3600, allLo, allHi ) );
+  CHECK( history.span( 0, history.getLength(), lo, hi ) );
+  CHECK( lo == allLo && hi == allHi );
+
+  CheckSpans( history, bake );
+
+  // Temps are kept in 1/4 C from 0 to just under 1024 C, anything outside is clamped
+  history.begin( 0, 0 );
+  history.add( 0, 21.3f );
+  history.add( 1, -40 );
+  history.add( 2, 1023.5f );
+  history.add( 3, 1500 );
+  history.add( -1, 500 );
+  CHECK( history.span( 0, 1, lo, hi ) && lo == 21.25f && hi == 21.25f );
+  CHECK( history.span( 1, 2, lo, hi ) && lo == 0 && hi == 0 );
+  CHECK( history.span( 2, 3, lo, hi ) && lo == 1023.5f && hi == 1023.5f );
+  CHECK( history.span( 3, 4, lo, hi ) && lo == 1023.5f && hi == 1023.5f );
+  CHECK( history.getLength() == 4 );
+
+  return CheckResult();
+}
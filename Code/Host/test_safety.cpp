@@ -0,0 +1,108 @@
+// Puts a probe fault in the middle of a reflow and checks the safety supervisor cuts the relay in time.
+//
+//   test_safety open|gnd|vcc|hot|stale
+//
+// The fault goes in during warmup, with the relay driven. The relay has to be
+// off within the bound the supervisor reports, from when the fault went in,
+// stay off, and the run has to end on the ABORT screen and then the menu.
+
+#include "Reflow_Master_v2.cpp"
+#include "SimHarness.h"
+#include "check.h"
+
+// The stale check runs from the sample task, not the sampler interrupt
+#define SAMPLE_TASK_PERIOD 25
+
+static unsigned long tripMicros = 0;
+
+// Straight after the sampler, so a trip in its interrupt is seen at the ms it happened
+static void TripWatch()
+{
+  if ( tripMicros == 0 && safety.isTripped() )
+    tripMicros = micros();
+}
+
+static bool RelayDriven()
+{
+  return relayOutput.getDuty() > 0 && HostGetPin( RELAY );
+}
+
+static bool Tripped()
+{
+  return tripMicros != 0;
+}
+
+int main( int argc, char **argv )
+{
+  const char *fault = argc > 1 ? argv[1] : "";
+
+  uint8_t probe = SIM_PROBE_OK;
+  uint8_t trip = SAFETY_TC_FAULT;
+  if ( strcmp( fault, "open" ) == 0 )
+    probe = STATUS_OPEN_CIRCUIT;
+  else if ( strcmp( fault, "gnd" ) == 0 )
+    probe = STATUS_SHORT_TO_GND;
+  else if ( strcmp( fault, "vcc" ) == 0 )
+    probe = STATUS_SHORT_TO_VCC;
+  else if ( strcmp( fault, "hot" ) == 0 )
+    trip = SAFETY_OVER_TEMP;
+  else if ( strcmp( fault, "stale" ) == 0 )
+    trip = SAFETY_TC_STALE;
+  else
+  {
+    printf( "test_safety open|gnd|vcc|hot|stale\n" );
+    return 2;
+  }
+
+  SimBegin();
+  HostAddTickHook( TripWatch );
+  SimRunFor( 3000 );
+
+  SimPress( BUTTON0 );
+  CHECK( state == WARMUP );
+  CHECK( safety.isArmed() );
+  CHECK( SimRunUntil( RelayDriven, 10000 ) );
+
+  // A sample is up to one period away, and faultSamples of them trip it, which is the bound
+  unsigned long bound = safety.getBound();
+  if ( trip == SAFETY_TC_STALE )
+    bound = ( TC_STALE_TIME + SAMPLE_TASK_PERIOD + 1 ) * 1000UL;
+
+  unsigned long injected = micros();
+  if ( trip == SAFETY_OVER_TEMP )
+    simProbeTemp = SAFETY_CEILING + 10;
+  else if ( trip == SAFETY_TC_STALE )
+    tcSampler.begin( TC_SAMPLE_RATE, NULL ); // the samples just stop
+  else
+    simProbe = probe;
+
+  CHECK( SimRunUntil( Tripped, bound / 1000 + 1000 ) );
+
+  unsigned long latency = tripMicros - injected;
+  printf( "%s: %s after %luus, bound %luus, supervisor latency %luus\n", fault, SafetySupervisor::tripName( safety.getTrip() ), latency, bound, safety.getLastLatency() );
+#ifdef DEBUG
+  safety.print( Serial );
+#endif
+
+  CHECK( safety.getTrip() == trip );
+  if ( trip == SAFETY_TC_FAULT )
+    CHECK( safety.getTripStatus() == probe );
+  CHECK( latency <= bound );
+  CHECK( safety.getLastLatency() <= bound );
+
+  // Off when the trip returned, and never back on
+  CHECK( HostGetPin( RELAY ) == LOW );
+  CHECK( relayOutput.getDuty() == 0 );
+  CHECK( HostPinChanged( RELAY ) <= tripMicros );
+
+  SimRunFor( 500 );
+  CHECK( state == ABORT );
+  CHECK( !safety.isArmed() );
+
+  SimRunFor( 1000 );
+  CHECK( state == MENU );
+  CHECK( HostGetPin( RELAY ) == LOW );
+  CHECK( HostPinChanged( RELAY ) <= tripMicros );
+
+  return CheckResult();
+}
@@ -0,0 +1,108 @@
+// Checks TCLinearize against the NIST ITS-90 reference tables, for readings made the way the MAX31855 makes them.
+//
+// The chip reports the thermocouple voltage over 41.276uV/C plus the cold
+// junction, in 1/4C steps. The voltages here are from the NIST tables, in mV
+// with the reference junction at 0C, so the chip's reading for a hot junction
+// temp is worked out from E(hot) - E(cold) and then taken back through the
+// table. Each result has to be within the chip's 1/4C step plus the table's
+// own error of the reference temp.
+
+#include "TCLinearize.h"
+#include "check.h"
+
+// 1/4C steps from the chip, up to 0.036C from the lookup tables
+#define TC_TOLERANCE 0.3
+
+#define CHIP_UV_PER_C 41.276
+
+typedef struct {
+  float temp; // C
+  float mv;   // NIST EMF, reference junction at 0C
+} NISTPoint;
+
+typedef struct {
+  char type;
+  float cold25;                // mV at 25C, the cold junction used below
+  const NISTPoint *points;
+  int count;
+} NISTTable;
+
+static const NISTPoint nistK[] = {
+  { 0, 0 }, { 50, 2.023 }, { 100, 4.096 }, { 150, 6.138 }, { 200, 8.138 }, { 250, 10.153 },
+  { 300, 12.209 }, { 400, 16.397 }, { 500, 20.644 },
+};
+static const NISTPoint nistJ[] = {
+  { 0, 0 }, { 100, 5.269 }, { 200, 10.779 }, { 300, 16.327 }, { 400, 21.848 }, { 500, 27.393 },
+};
+static const NISTPoint nistT[] = {
+  { 0, 0 }, { 100, 4.279 }, { 200, 9.288 }, { 300, 14.862 }, { 400, 20.872 },
+};
+static const NISTPoint nistE[] = {
+  { 0, 0 }, { 100, 6.319 }, { 200, 13.421 }, { 300, 21.036 }, { 400, 28.946 }, { 500, 36.999 },
+};
+static const NISTPoint nistN[] = {
+  { 0, 0 }, { 100, 2.774 }, { 200, 5.913 }, { 300, 9.341 }, { 400, 12.974 }, { 500, 16.748 },
+};
+
+#define NIST( type, cold, points ) { type, cold, points, sizeof( points ) / sizeof( points[0] ) }
+
+static const NISTTable nist[] = {
+  NIST( 'K', 1.000, nistK ),
+  NIST( 'J', 1.277, nistJ ),
+  NIST( 'T', 0.992, nistT ),
+  NIST( 'E', 1.495, nistE ),
+  NIST( 'N', 0.659, nistN ),
+};
+
+// What the chip reports in 1/4C for a thermocouple voltage and a cold junction in C
+static int16_t ChipReading( float mv, float cold )
+{
+  return (int16_t)lround( ( mv * 1000 / CHIP_UV_PER_C + cold ) * 4 );
+}
+
+int main()
+{
+  CHECK( TCTableFor( 'X' ) == NULL );
+
+  for ( const NISTTable &t : nist )
+  {
+    const TCTable *table = TCTableFor( t.type );
+    CHECK( table != NULL );
+    if ( table == NULL )
+      continue;
+    CHECK( table->type == t.type );
+
+    for ( int i = 0; i < t.count; i++ )
+    {
+      const NISTPoint &p = t.points[i];
+
+      // Cold junction at 0C, the chip reading is the NIST voltage as it is
+      float temp = TCLinearize( *table, ChipReading( p.mv, 0 ), 0 ) / 64.0;
+      CHECK_NEAR( temp, p.temp, TC_TOLERANCE );
+
+      // And at 25C, the cold junction's voltage comes off what the chip sees
+      temp = TCLinearize( *table, ChipReading( p.mv - t.cold25, 25 ), 25 * 16 ) / 64.0;
+      CHECK_NEAR( temp, p.temp, TC_TOLERANCE );
+
+      // The oven simulator's reverse lookup gives the same reading back
+      int16_t reading = TCChipReading( *table, lround( p.temp * 64 ), 25 * 16 );
+      CHECK( abs( reading - ChipReading( p.mv - t.cold25, 25 ) ) <= 1 );
+    }
+
+    // Type K is what the chip assumes, so it is close without the table, the others aren't
+    const NISTPoint &top = t.points[t.count - 1];
+    float linear = ChipReading( top.mv - t.cold25, 25 ) / 4.0;
+    printf( "Type %c at %.0fc, the chip alone reads %.1fc, linearized %.2fc\n", t.type, top.temp, linear,
+            TCLinearize( *table, ChipReading( top.mv - t.cold25, 25 ), 25 * 16 ) / 64.0 );
+  }
+
+  // Every reading from 0 to 500c in 1/4C steps goes back to within a step of where it came from
+  const TCTable &k = *TCTableFor( 'K' );
+  for ( int32_t temp = 0; temp <= 500 * 64; temp += 16 )
+  {
+    int16_t reading = TCChipReading( k, temp, 25 * 16 );
+    CHECK_NEAR( TCLinearize( k, reading, 25 * 16 ) / 64.0, temp / 64.0, TC_TOLERANCE );
+  }
+
+  return CheckResult();
+}
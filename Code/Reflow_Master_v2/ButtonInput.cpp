@@ -0,0 +1,179 @@
+#include "ButtonInput.h"
+
+// Woken by the pin change interrupts, ticked by the SysTick hook
+static ButtonInput *tickInput = NULL;
+
+static void pinChanged()
+{
+  if ( tickInput != NULL )
+    tickInput->wake();
+}
+
+ButtonInput::ButtonInput( const uint8_t pins[], uint8_t count, bool activeLow )
+{
+  _count = min( count, (uint8_t)BUTTONS_MAX );
+  _activeLow = activeLow;
+  _debounce = 20;
+  _longPress = 800;
+  _repeat = 20;
+  _awake = false;
+  _lastPoll = 0;
+  _head = 0;
+  _tail = 0;
+  _dropped = 0;
+
+  for ( uint8_t i = 0; i < _count; i++ )
+  {
+    ButtonState &b = _buttons[i];
+    b.pin = pins[i];
+    b.raw = false;
+    b.pressed = false;
+    b.held = false;
+    b.changed = 0;
+    b.pressedAt = 0;
+    b.nextRepeat = 0;
+  }
+}
+
+void ButtonInput::begin( uint16_t debounce, uint16_t longPress, uint16_t repeat )
+{
+  _debounce = debounce;
+  _longPress = longPress;
+  _repeat = max( repeat, (uint16_t)1 );
+
+  tickInput = this;
+
+  for ( uint8_t i = 0; i < _count; i++ )
+  {
+    pinMode( _buttons[i].pin, _activeLow ? INPUT_PULLUP : INPUT );
+    attachInterrupt( digitalPinToInterrupt( _buttons[i].pin ), pinChanged, CHANGE );
+  }
+
+  // One look at the buttons, in case one is already down
+  wake();
+}
+
+void ButtonInput::poll()
+{
+#if !defined(ARDUINO_ARCH_SAMD)
+  unsigned long now = millis();
+  if ( now != _lastPoll )
+  {
+    _lastPoll = now;
+    wake();
+    tick( now );
+  }
+#endif
+}
+
+bool ButtonInput::isDown( const ButtonState &b ) const
+{
+  return digitalRead( b.pin ) == ( _activeLow ? LOW : HIGH );
+}
+
+void ButtonInput::tick( unsigned long now )
+{
+  if ( !_awake )
+    return;
+
+  // Cleared first, so a pin change from here on wakes it again
+  _awake = false;
+  bool busy = false;
+
+  for ( uint8_t i = 0; i < _count; i++ )
+  {
+    ButtonState &b = _buttons[i];
+
+    bool down = isDown( b );
+    if ( down != b.raw )
+    {
+      b.raw = down;
+      b.changed = now;
+    }
+
+    // Still bouncing
+    if ( now - b.changed < _debounce )
+    {
+      busy = true;
+      continue;
+    }
+
+    if ( down != b.pressed )
+    {
+      b.pressed = down;
+      if ( down )
+      {
+        b.pressedAt = now;
+        b.held = false;
+      }
+      else if ( !b.held )
+      {
+        // Letting go of a long press isn't a click
+        push( i, BUTTON_CLICK );
+      }
+    }
+
+    if ( b.pressed )
+    {
+      // Held down, keep ticking for the long press and repeats
+      busy = true;
+
+      if ( !b.held && now - b.pressedAt >= _longPress )
+      {
+        b.held = true;
+        b.nextRepeat = now + _repeat;
+        push( i, BUTTON_LONG_START );
+      }
+      else if ( b.held && (long)( now - b.nextRepeat ) >= 0 )
+      {
+        b.nextRepeat += _repeat;
+        push( i, BUTTON_REPEAT );
+      }
+    }
+  }
+
+  if ( busy )
+    _awake = true;
+}
+
+void ButtonInput::push( uint8_t button, uint8_t type )
+{
+  uint8_t head = _head;
+  uint8_t used = ( head - _tail ) & ( BUTTON_QUEUE - 1 );
+  uint8_t room = ( type == BUTTON_REPEAT ) ? BUTTON_QUEUE / 2 : BUTTON_QUEUE - 1;
+
+  if ( used >= room )
+  {
+    _dropped++;
+    return;
+  }
+
+  _queue[head].button = button;
+  _queue[head].type = type;
+
+  // Publish the slot only after it has been filled in
+  _head = ( head + 1 ) & ( BUTTON_QUEUE - 1 );
+}
+
+bool ButtonInput::read( ButtonEvent &event )
+{
+  uint8_t tail = _tail;
+  if ( tail == _head )
+    return false;
+
+  event = _queue[tail];
+  _tail = ( tail + 1 ) & ( BUTTON_QUEUE - 1 );
+  return true;
+}
+
+#if defined(ARDUINO_ARCH_SAMD)
+
+// The core calls this from SysTick_Handler every ms, returning 0 lets it carry on and count the ms
+extern "C" int sysTickHook( void )
+{
+  if ( tickInput != NULL )
+    tickInput->tick( millis() );
+  return 0;
+}
+
+#endif
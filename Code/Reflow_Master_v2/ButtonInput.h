@@ -0,0 +1,102 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Button Input
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Reads the buttons from interrupts and queues up what they did, so a press
+  is never lost or late because loop() was busy redrawing the screen.
+
+  A pin change interrupt on any button wakes the 1ms tick, which debounces
+  each button, then queues a click on release, or a long press start once it
+  has been held, followed by repeats at a fixed rate for as long as it stays
+  down. When every button is up and steady the tick goes back to doing nothing
+  until the next pin change, so nothing polls the buttons while they're idle.
+
+  The queue has a single producer (the tick) and a single consumer (read() in
+  the main loop), so it needs no locking. Repeats only go in while it is less
+  than half full, so a held button can't crowd out the clicks.
+
+  On the SAMD21 the tick is the core's SysTick hook. Other boards call poll()
+  from the main loop instead.
+  ---------------------------------------------------------------------------
+*/
+#ifndef ButtonInput_h
+#define ButtonInput_h
+
+#include <Arduino.h>
+
+#define BUTTONS_MAX 4
+// Queue size, must be a power of 2
+#define BUTTON_QUEUE 16
+
+enum buttonEvents {
+  BUTTON_CLICK = 0,
+  BUTTON_LONG_START,
+  BUTTON_REPEAT,
+};
+
+typedef struct {
+  uint8_t button;
+  uint8_t type;
+} ButtonEvent;
+
+typedef void (*ButtonHandler)(void);
+
+typedef struct {
+  uint8_t pin;
+  bool raw;        // Level at the last tick
+  bool pressed;    // Debounced
+  bool held;       // Long press started
+  unsigned long changed;
+  unsigned long pressedAt;
+  unsigned long nextRepeat;
+} ButtonState;
+
+class ButtonInput
+{
+  public:
+    ButtonInput( const uint8_t pins[], uint8_t count, bool activeLow = false );
+
+    // All in ms
+    void begin( uint16_t debounce, uint16_t longPress, uint16_t repeat );
+
+    // Only needed on boards without the tick hook, runs the tick when a ms has gone by
+    void poll();
+
+    // Producer side, every ms from the tick interrupt
+    void tick( unsigned long now );
+
+    // Consumer side, the oldest event, false if there are none
+    bool read( ButtonEvent &event );
+
+    // From the pin change interrupt
+    void wake() { _awake = true; }
+
+    // Events lost because the queue was full
+    unsigned long getDropped() const { return _dropped; }
+
+  private:
+    ButtonState _buttons[BUTTONS_MAX];
+    uint8_t _count;
+    bool _activeLow;
+    uint16_t _debounce;
+    uint16_t _longPress;
+    uint16_t _repeat;
+
+    volatile bool _awake;
+    unsigned long _lastPoll;
+
+    ButtonEvent _queue[BUTTON_QUEUE];
+    volatile uint8_t _head;
+    volatile uint8_t _tail;
+    volatile unsigned long _dropped;
+
+    bool isDown( const ButtonState &b ) const;
+    void push( uint8_t button, uint8_t type );
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include "CoopScheduler.h"
+#include "TextBuffer.h"
+
+CoopScheduler::CoopScheduler( TaskClock clock )
+{
+  _clock = clock;
+  _count = 0;
+  _statsStart = 0;
+  _idleMillis = 0;
+  _idleMicros = 0;
+}
+
+int8_t CoopScheduler::add( const char *name, TaskFunc func, unsigned long period, uint8_t priority )
+{
+  if ( _count >= SCHEDULER_MAX_TASKS )
+    return -1;
+
+  SchedulerTask &task = _tasks[_count];
+  task.name = name;
+  task.func = func;
+  task.period = period;
+  task.priority = priority;
+  task.deadline = _clock();
+  task.active = ( period > 0 );
+
+  return _count++;
+}
+
+void CoopScheduler::start( int8_t id, unsigned long delay )
+{
+  if ( id < 0 || id >= _count )
+    return;
+
+  _tasks[id].deadline = _clock() + delay;
+  _tasks[id].active = true;
+}
+
+void CoopScheduler::stop( int8_t id )
+{
+  if ( id >= 0 && id < _count )
+    _tasks[id].active = false;
+}
+
+bool CoopScheduler::isActive( int8_t id ) const
+{
+  return ( id >= 0 && id < _count && _tasks[id].active );
+}
+
+void CoopScheduler::setPeriod( int8_t id, unsigned long period )
+{
+  if ( id >= 0 && id < _count )
+    _tasks[id].period = period;
+}
+
+void CoopScheduler::run()
+{
+  unsigned long now = _clock();
+  int8_t next = -1;
+
+  // Most urgent due task, lowest priority number first, then whichever has waited longest
+  for ( uint8_t i = 0; i < _count; i++ )
+  {
+    SchedulerTask &task = _tasks[i];
+    if ( !task.active || !reached( now, task.deadline ) )
+      continue;
+
+    if ( next < 0 || task.priority < _tasks[next].priority || ( task.priority == _tasks[next].priority && (long)( task.deadline - _tasks[next].deadline ) < 0 ) )
+      next = i;
+  }
+
+  if ( next < 0 )
+  {
+    idle();
+    return;
+  }
+
+  SchedulerTask &task = _tasks[next];
+
+  unsigned long late = now - task.deadline;
+  task.runs++;
+  task.lateTotal += late;
+  if ( late > task.lateMax )
+    task.lateMax = late;
+
+  // A one shot is done once it runs, it can start() itself again from inside
+  unsigned long deadline = task.deadline;
+  if ( task.period == 0 )
+    task.active = false;
+
+  unsigned long start = micros();
+  task.func();
+  unsigned long runTime = micros() - start;
+
+  if ( runTime > task.runMicrosMax )
+    task.runMicrosMax = runTime;
+
+  // Periodic tasks keep their phase, unless the task moved its own deadline with start()
+  if ( task.period > 0 && task.active && task.deadline == deadline )
+  {
+    task.deadline += task.period;
+
+    // Skip the ticks that have already been missed rather than running them back to back
+    now = _clock();
+    while ( reached( now, task.deadline + task.period ) )
+    {
+      task.deadline += task.period;
+      task.overruns++;
+    }
+  }
+}
+
+void CoopScheduler::idle()
+{
+  unsigned long start = micros();
+
+#if defined(ARDUINO_ARCH_SAMD)
+  // Any interrupt wakes us, the 1ms SysTick at the latest
+  __WFI();
+#else
+  // Lets the core get on with its own work, the host build moves its clock on here
+  yield();
+#endif
+
+  _idleMicros += micros() - start;
+  if ( _idleMicros >= 1000 )
+  {
+    _idleMillis += _idleMicros / 1000;
+    _idleMicros %= 1000;
+  }
+}
+
+void CoopScheduler::printStats( Print &out )
+{
+  out.println( "Task runs late avg/max ms, overruns, max us" );
+
+  for ( uint8_t i = 0; i < _count; i++ )
+  {
+    SchedulerTask &task = _tasks[i];
+
+    TextBuffer line;
+    line.add( task.name ).add( " " ).add( task.runs ).add( " " );
+    line.add( task.runs > 0 ? (double)task.lateTotal / task.runs : 0.0 ).add( "/" ).add( task.lateMax );
+    line.add( " " ).add( task.overruns ).add( " " ).add( task.runMicrosMax );
+    out.println( line.c_str() );
+  }
+
+  unsigned long elapsed = millis() - _statsStart;
+  TextBuffer idle;
+  idle.add( "Idle " ).add( elapsed > 0 ? _idleMillis * 100.0 / elapsed : 0.0, 1 ).add( "% of " ).add( elapsed / 1000 ).add( "s" );
+  out.println( idle.c_str() );
+}
+
+void CoopScheduler::resetStats()
+{
+  for ( uint8_t i = 0; i < _count; i++ )
+  {
+    _tasks[i].runs = 0;
+    _tasks[i].overruns = 0;
+    _tasks[i].lateMax = 0;
+    _tasks[i].lateTotal = 0;
+    _tasks[i].runMicrosMax = 0;
+  }
+
+  _statsStart = millis();
+  _idleMillis = 0;
+  _idleMicros = 0;
+}
@@ -0,0 +1,89 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Cooperative Scheduler
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Runs the work loop() used to poll for, each as a task with its own deadline.
+
+  Periodic tasks are rescheduled from their last deadline, not from when they
+  ran, so a slow screen update doesn't push every later control tick back.
+  Deadlines are compared as a signed difference, so they keep working when the
+  ms clock wraps after 49 days.
+
+  Only one task runs per call to run(). When more than one is due the lowest
+  priority number goes first, so the control tick never waits behind more than
+  one other task. With nothing due the CPU sleeps until the next interrupt.
+
+  Each task keeps how late it started (jitter), how many periods it had to skip
+  (overruns) and its longest run time.
+  ---------------------------------------------------------------------------
+*/
+#ifndef CoopScheduler_h
+#define CoopScheduler_h
+
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_TASKS 12
+
+typedef void (*TaskFunc)(void);
+typedef unsigned long (*TaskClock)(void);
+
+typedef struct {
+  const char *name = NULL;
+  TaskFunc func = NULL;
+  unsigned long period = 0; // ms, 0 for a one shot
+  unsigned long deadline = 0;
+  uint8_t priority = 0; // Lower runs first
+  bool active = false;
+
+  unsigned long runs = 0;
+  unsigned long overruns = 0;
+  unsigned long lateMax = 0; // ms
+  unsigned long lateTotal = 0;
+  unsigned long runMicrosMax = 0;
+} SchedulerTask;
+
+class CoopScheduler
+{
+  public:
+    CoopScheduler( TaskClock clock );
+
+    // Add a task, periodic ones are due straight away, one shots wait for start()
+    // Returns the task id, or -1 if there is no room
+    int8_t add( const char *name, TaskFunc func, unsigned long period, uint8_t priority );
+
+    // Run the task delay ms from now, periodic tasks carry on from there
+    void start( int8_t id, unsigned long delay = 0 );
+    void stop( int8_t id );
+    bool isActive( int8_t id ) const;
+
+    // Takes effect from the next deadline
+    void setPeriod( int8_t id, unsigned long period );
+
+    // Run the most urgent task that is due, or sleep if none are
+    void run();
+
+    void printStats( Print &out );
+    void resetStats();
+
+    // True once deadline has been reached, works across the clock wrapping
+    static bool reached( unsigned long now, unsigned long deadline ) { return (long)( now - deadline ) >= 0; }
+
+  private:
+    void idle();
+
+    TaskClock _clock;
+    SchedulerTask _tasks[SCHEDULER_MAX_TASKS];
+    uint8_t _count;
+
+    // Real time, not the task clock, so the idle share is right when simulating
+    unsigned long _statsStart;
+    unsigned long _idleMillis;
+    unsigned long _idleMicros;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "GraphPlot.h"
+#include "TFTWidgets.h"
+
+GraphPlot::GraphPlot( void )
+{
+  setArea( 0, 0, 1, 1 );
+  setRange( 0, 1, 0, 1 );
+  moveTo( 0, 0 );
+  resetStats();
+}
+
+void GraphPlot::setArea( int16_t gx, int16_t gy, int16_t w, int16_t h )
+{
+  _gx = gx;
+  _gy = gy;
+  _w = w;
+  _h = h;
+}
+
+void GraphPlot::setRange( float xlo, float xhi, float ylo, float yhi )
+{
+  _xlo = xlo;
+  _xhi = ( xhi != xlo ) ? xhi : xlo + 1;
+  _ylo = ylo;
+  _yhi = ( yhi != ylo ) ? yhi : ylo + 1;
+}
+
+int16_t GraphPlot::toX( float x ) const
+{
+  return (int16_t)( ( x - _xlo ) * _w / ( _xhi - _xlo ) + _gx );
+}
+
+int16_t GraphPlot::toY( float y ) const
+{
+  return (int16_t)( ( y - _ylo ) * ( -_h ) / ( _yhi - _ylo ) + _gy );
+}
+
+void GraphPlot::moveTo( int16_t x, int16_t y )
+{
+  _penX = x;
+  _penY = y;
+}
+
+void GraphPlot::resetStats()
+{
+  _bytes = 0;
+  _legacyBytes = 0;
+}
+
+// One address window and a run of pixels, clipped to the screen like writePixel() does
+void GraphPlot::span( Adafruit_ILI9341 &d, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color )
+{
+  if ( x < 0 )
+  {
+    w += x;
+    x = 0;
+  }
+  if ( y < 0 )
+  {
+    h += y;
+    y = 0;
+  }
+  w = min( w, (int16_t)( d.width() - x ) );
+  h = min( h, (int16_t)( d.height() - y ) );
+
+  if ( w <= 0 || h <= 0 )
+    return;
+
+  d.setAddrWindow( x, y, w, h );
+  d.writeColor( color, (uint32_t)w * h );
+
+  unsigned long bytes = TFTFillBytes( w, h );
+  _bytes += bytes;
+  tftStats.bytes += bytes;
+}
+
+void GraphPlot::lineTo( Adafruit_ILI9341 &d, int16_t x1, int16_t y1, uint16_t color )
+{
+  int16_t x0 = _penX;
+  int16_t y0 = _penY;
+  moveTo( x1, y1 );
+
+  // Same walk as Adafruit_GFX::writeLine(), steep lines step along y
+  bool steep = abs( y1 - y0 ) > abs( x1 - x0 );
+  if ( steep )
+  {
+    int16_t t = x0; x0 = y0; y0 = t;
+    t = x1; x1 = y1; y1 = t;
+  }
+  if ( x0 > x1 )
+  {
+    int16_t t = x0; x0 = x1; x1 = t;
+    t = y0; y0 = y1; y1 = t;
+  }
+
+  int16_t dx = x1 - x0;
+  int16_t dy = abs( y1 - y0 );
+  int16_t err = dx / 2;
+  int16_t ystep = ( y0 < y1 ) ? 1 : -1;
+
+  // Three drawLine() calls, horizontal and vertical ones get a single fast line each
+  if ( dx == 0 || dy == 0 )
+    _legacyBytes += 3 * TFTFillBytes( dx + 1, 1 );
+  else
+    _legacyBytes += 3UL * ( dx + 1 ) * ( 11 + 2 );
+
+  d.startWrite();
+
+  // Each run is a stretch of pixels along the major axis that share the same minor coordinate
+  int16_t runStart = x0;
+  for ( ; x0 <= x1; x0++ )
+  {
+    err -= dy;
+    bool endOfRun = ( err < 0 || x0 == x1 );
+
+    if ( endOfRun )
+    {
+      int16_t len = x0 - runStart + 1;
+
+      if ( steep )
+      {
+        // A column, with the lines above and below it just make it 2 pixels taller
+        span( d, y0, runStart - 1, 1, len + 2, color );
+      }
+      else
+      {
+        span( d, runStart, y0 - 1, len, 1, color );
+        span( d, runStart, y0, len, 1, color );
+        span( d, runStart, y0 + 1, len, 1, color );
+      }
+
+      runStart = x0 + 1;
+    }
+
+    if ( err < 0 )
+    {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+
+  d.endWrite();
+}
@@ -0,0 +1,78 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Graph Plotting
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Draws the 3 pixel thick profile and temperature lines on the reflow graph.
+
+  The old way was three drawLine() calls per segment, one pixel above and one
+  below. The Adafruit library sends each pixel of a sloped line with its own
+  address window, which is 13 bytes per pixel. Here the Bresenham line is walked
+  once and turned into runs: shallow lines become rows of pixels, drawn once for
+  each of the 3 offsets, and steep lines become columns, which already cover all
+  3 offsets. Each run is one address window and a block of pixels.
+
+  The pixels are the same ones the three drawLine() calls set. The panel can't
+  be read back, so only the line pixels are written, not whole tiles, or the
+  grid under the line would be lost.
+  ---------------------------------------------------------------------------
+*/
+#ifndef GraphPlot_h
+#define GraphPlot_h
+
+#include <Arduino.h>
+#include "Adafruit_ILI9341.h"
+
+class GraphPlot
+{
+  public:
+    GraphPlot( void );
+
+    // Graph area on screen, gx,gy is the bottom left corner
+    void setArea( int16_t gx, int16_t gy, int16_t w, int16_t h );
+
+    // Data values at the edges of the graph area
+    void setRange( float xlo, float xhi, float ylo, float yhi );
+
+    // Data to screen coordinates, truncated the same way drawLine() truncated the old double maths
+    int16_t toX( float x ) const;
+    int16_t toY( float y ) const;
+
+    // Move the pen without drawing
+    void moveTo( int16_t x, int16_t y );
+    int16_t getPenX() const { return _penX; }
+    int16_t getPenY() const { return _penY; }
+
+    // Draw a thick line from the pen to x,y and move the pen there
+    void lineTo( Adafruit_ILI9341 &d, int16_t x, int16_t y, uint16_t color );
+
+    // Bytes sent, and what three drawLine() calls would have sent for the same segments
+    unsigned long getBytes() const { return _bytes; }
+    unsigned long getLegacyBytes() const { return _legacyBytes; }
+    void resetStats();
+
+  private:
+    void span( Adafruit_ILI9341 &d, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color );
+
+    int16_t _gx;
+    int16_t _gy;
+    int16_t _w;
+    int16_t _h;
+
+    float _xlo;
+    float _xhi;
+    float _ylo;
+    float _yhi;
+
+    int16_t _penX;
+    int16_t _penY;
+
+    unsigned long _bytes;
+    unsigned long _legacyBytes;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "HeapStats.h"
+
+#if defined(ARDUINO_ARCH_SAMD)
+#include <malloc.h>
+extern "C" char* sbrk( int incr );
+#endif
+
+static HeapStats heapStats;
+
+void HeapSample()
+{
+#if defined(ARDUINO_ARCH_SAMD)
+  struct mallinfo info = mallinfo();
+
+  // The stack grows down from the top of RAM, so a local is near the stack pointer
+  char stackTop;
+  long gap = (long)( &stackTop - sbrk( 0 ) );
+
+  heapStats.used = info.uordblks;
+  heapStats.heapSize = info.arena;
+  heapStats.freeInHeap = info.fordblks;
+  heapStats.freeChunks = info.ordblks;
+  heapStats.stackGap = gap;
+
+  if ( heapStats.samples == 0 || gap < heapStats.minStackGap )
+    heapStats.minStackGap = gap;
+#endif
+
+  if ( heapStats.used > heapStats.maxUsed )
+    heapStats.maxUsed = heapStats.used;
+
+  if ( heapStats.freeChunks > heapStats.maxFreeChunks )
+    heapStats.maxFreeChunks = heapStats.freeChunks;
+
+  heapStats.samples++;
+}
+
+const HeapStats& GetHeapStats()
+{
+  return heapStats;
+}
+
+void PrintHeapStats( Print &out )
+{
+  out.print( "Heap used " );
+  out.print( heapStats.used );
+  out.print( " max " );
+  out.println( heapStats.maxUsed );
+
+  out.print( "Heap size " );
+  out.print( heapStats.heapSize );
+  out.print( " free inside " );
+  out.print( heapStats.freeInHeap );
+  out.print( " in " );
+  out.print( heapStats.freeChunks );
+  out.print( " chunks, max chunks " );
+  out.println( heapStats.maxFreeChunks );
+
+  out.print( "Stack gap " );
+  out.print( heapStats.stackGap );
+  out.print( " min " );
+  out.println( heapStats.minStackGap );
+}
@@ -0,0 +1,44 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Heap Stats
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Keeps an eye on the heap, so we can see if it is growing or breaking up over
+  a long bake. HeapSample() is called from loop(), and the HEAP serial command
+  prints what it has seen.
+
+  Free bytes that are inside the heap but broken up into many small chunks are
+  what fragmentation looks like. The gap between the top of the heap and the
+  stack is what is really left.
+  ---------------------------------------------------------------------------
+*/
+#ifndef HeapStats_h
+#define HeapStats_h
+
+#include <Arduino.h>
+
+typedef struct {
+  unsigned long samples = 0;
+  unsigned long used = 0;         // Bytes allocated right now
+  unsigned long maxUsed = 0;      // Most bytes ever allocated at once
+  unsigned long heapSize = 0;     // Size of the heap, it never shrinks so this is also its high water mark
+  unsigned long freeInHeap = 0;   // Freed bytes inside the heap waiting to be reused
+  unsigned long freeChunks = 0;   // How many pieces those free bytes are in
+  unsigned long maxFreeChunks = 0;
+  long stackGap = 0;              // Bytes between the top of the heap and the stack
+  long minStackGap = 0;
+} HeapStats;
+
+// Take a sample, cheap enough to call every loop
+void HeapSample();
+
+const HeapStats& GetHeapStats();
+
+// Print the stats to a serial port or anything else that can print
+void PrintHeapStats( Print &out );
+
+#endif
@@ -1,12 +1,15 @@
 //
 //    FILE: MAX31855.cpp
 //  AUTHOR: Rob Tillaart
-// VERSION: 0.1.9
+// VERSION: 0.2.1
 // PURPOSE: MAX31855 - Thermocouple
 //    DATE: 2014-01-01
 //     URL: http://forum.arduino.cc/index.php?topic=208061
 //
 // HISTORY:
+// 0.2.1  NIST linearization tables, raw readings
+// 0.2.0  pluggable transports: GPIO, SAMD direct port and hardware SPI, read time
+//        split read() into readFrame() and decode()
 // 0.1.9  2017-07-27 reverted double -> float (issue33)
 // 0.1.08 2015-12-06 replaced all temperature calls with one TCfactor + update demos.
 // 0.1.07 2015-12-06 updated TC factors from the MAX31855 datasheet
@@ -24,30 +27,52 @@
 #include "MAX31855.h"
 
 MAX31855::MAX31855(const uint8_t sclk, const uint8_t cs, const uint8_t miso)
+    : _gpio(sclk, cs, miso)
+{
+    _transport = &_gpio;
+    _init();
+}
+
+MAX31855::MAX31855(MAX31855Transport &transport)
+    : _gpio(0, 0, 0)
+{
+    _transport = &transport;
+    _init();
+}
+
+void MAX31855::_init()
 {
-    _sclk = sclk;
-    _cs = cs;
-    _miso = miso;
     _offset = 0;
     _TCfactor = K_TC;
     _status = STATUS_NOREAD;
     _temperature = -999;
     _internal = -999;
+    _readTime = 0;
+    _rawTemperature = 0;
+    _rawInternal = 0;
+    _table = NULL;
 }
 
 void MAX31855::begin()
 {
-    pinMode(_cs, OUTPUT);
-    digitalWrite(_cs, HIGH);
-
-    pinMode(_sclk, OUTPUT);
-    pinMode(_miso, INPUT);
+    _transport->begin();
 }
 
 uint8_t MAX31855::read()
 {
-    uint32_t value = _read();
+    return decode(readFrame());
+}
+
+uint32_t MAX31855::readFrame()
+{
+    uint32_t start = micros();
+    uint32_t value = _transport->read32();
+    _readTime = micros() - start;
+    return value;
+}
 
+uint8_t MAX31855::decode(uint32_t value)
+{
     // process status bit 0-2
     _status = value & 0x0007;
     value >>= 3;
@@ -56,11 +81,8 @@ uint8_t MAX31855::read()
     value >>= 1;
 
     // process internal bit 4-15
-    _internal = (value & 0x07FF) * 0.0625;
-    if (value & 0x0800)
-    {
-        _internal = -128 + _internal;  // fix neg temp
-    }
+    _rawInternal = (value & 0x0800) ? (int16_t)(value & 0x0FFF) - 0x1000 : (int16_t)(value & 0x0FFF);
+    _internal = _rawInternal * 0.0625;
     value >>= 12;
 
     // Fault bit ignored as we have the 3 status bits
@@ -71,18 +93,40 @@ uint8_t MAX31855::read()
     value >>= 1;
 
     // process temperature bit 18-30 + sign bit = 31
-    _temperature = (value & 0x1FFF) * 0.25;
-    if (value & 0x2000) // negative flag
-    {
-        _temperature = -2048 + _temperature;  // fix neg temp
-    }
+    _rawTemperature = (value & 0x2000) ? (int16_t)(value & 0x3FFF) - 0x4000 : (int16_t)(value & 0x3FFF);
+
+    // the table works the voltage back out with integer maths, 1/64C out
+    if (_table != NULL && _status == STATUS_OK)
+        _temperature = TCLinearize(*_table, _rawTemperature, _rawInternal) * 0.015625;
+    else
+        _temperature = _rawTemperature * 0.25;
+
     if (_offset != 0) _temperature += _offset;
 
     return _status;
 }
 
-// TODO:  optimize performance by direct port manipulation?
-uint32_t MAX31855::_read(void)
+/////////////////////////////////////////////////////////
+//
+// GPIO transport
+//
+MAX31855_GPIO::MAX31855_GPIO(const uint8_t sclk, const uint8_t cs, const uint8_t miso)
+{
+    _sclk = sclk;
+    _cs = cs;
+    _miso = miso;
+}
+
+void MAX31855_GPIO::begin()
+{
+    pinMode(_cs, OUTPUT);
+    digitalWrite(_cs, HIGH);
+
+    pinMode(_sclk, OUTPUT);
+    pinMode(_miso, INPUT);
+}
+
+uint32_t MAX31855_GPIO::read32()
 {
     uint32_t value = 0;
 
@@ -103,4 +147,99 @@ uint32_t MAX31855::_read(void)
     return value;
 }
 
+/////////////////////////////////////////////////////////
+//
+// SAMD direct port transport
+//
+#if defined(ARDUINO_ARCH_SAMD)
+
+// The MAX31855 needs SCK high and low for at least 100ns, and the CS fall to SCK
+// rise is 100ns, a few nops at 48MHz keep us inside that
+#define MAX31855_NOP_DELAY() __asm__ __volatile__ ("nop\n\tnop\n\tnop\n\tnop\n\t")
+
+MAX31855_FastGPIO::MAX31855_FastGPIO(const uint8_t sclk, const uint8_t cs, const uint8_t miso)
+{
+    _sclk = sclk;
+    _cs = cs;
+    _miso = miso;
+}
+
+void MAX31855_FastGPIO::begin()
+{
+    pinMode(_cs, OUTPUT);
+    digitalWrite(_cs, HIGH);
+
+    pinMode(_sclk, OUTPUT);
+    pinMode(_miso, INPUT);
+}
+
+uint32_t MAX31855_FastGPIO::read32()
+{
+    PortGroup *sclkPort = &PORT->Group[g_APinDescription[_sclk].ulPort];
+    PortGroup *misoPort = &PORT->Group[g_APinDescription[_miso].ulPort];
+    PortGroup *csPort   = &PORT->Group[g_APinDescription[_cs].ulPort];
+    const uint32_t sclkMask = 1ul << g_APinDescription[_sclk].ulPin;
+    const uint32_t misoMask = 1ul << g_APinDescription[_miso].ulPin;
+    const uint32_t csMask   = 1ul << g_APinDescription[_cs].ulPin;
+
+    uint32_t value = 0;
+
+    csPort->OUTCLR.reg = csMask;
+    MAX31855_NOP_DELAY();
+
+    for (int8_t i = 31; i >= 0; i--)
+    {
+        value <<= 1;
+        sclkPort->OUTCLR.reg = sclkMask;
+        MAX31855_NOP_DELAY();
+        if ( misoPort->IN.reg & misoMask ) value += 1;
+        sclkPort->OUTSET.reg = sclkMask;
+        MAX31855_NOP_DELAY();
+    }
+
+    csPort->OUTSET.reg = csMask;
+
+    return value;
+}
+
+#endif
+
+/////////////////////////////////////////////////////////
+//
+// Hardware SPI transport
+//
+MAX31855_HWSPI::MAX31855_HWSPI(SPIClass &spi, const uint8_t cs, const uint32_t clock)
+    : _spi(spi)
+{
+    _cs = cs;
+    _clock = clock;
+}
+
+void MAX31855_HWSPI::begin()
+{
+    pinMode(_cs, OUTPUT);
+    digitalWrite(_cs, HIGH);
+
+    _spi.begin();
+}
+
+uint32_t MAX31855_HWSPI::read32()
+{
+    uint32_t value = 0;
+
+    _spi.beginTransaction(SPISettings(_clock, MSBFIRST, SPI_MODE0));
+    digitalWrite(_cs, LOW);
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        value <<= 8;
+        value |= _spi.transfer(0x00);
+    }
+
+    digitalWrite(_cs, HIGH);
+    _spi.endTransaction();
+
+    return value;
+}
+
 // END OF FILE
@@ -1,7 +1,7 @@
 //
 //    FILE: MAX31855.h
 //  AUTHOR: Rob Tillaart
-// VERSION: 0.1.9
+// VERSION: 0.2.1
 // PURPOSE: MAX31855 - Thermocouple
 //    DATE: 2014-01-01
 //     URL: http://forum.arduino.cc/index.php?topic=208061
@@ -16,8 +16,10 @@
 #else
 #include "Arduino.h"
 #endif
+#include <SPI.h>
+#include "TCLinearize.h"
 
-#define MAX31855_VERSION "0.1.9"
+#define MAX31855_VERSION "0.2.1"
 
 #define STATUS_OK               0x00
 #define STATUS_OPEN_CIRCUIT     0x01
@@ -33,6 +35,8 @@
 //  the factor needed to convert other sensors measurements.
 //  note this is only a linear approximation.
 //
+//  setTable() with a NIST table from TCLinearize.h does it properly instead.
+//
 //  E_TC = 61   =>    41/61 = 0.6721311475
 //  J_TC = 52   =>    41/52 = 0.7884615385
 //  K_TC = 41   =>    41/41 = 1
@@ -51,14 +55,75 @@
 #define T_TC    (41.276/52.18)
 
 
+//  Transports clock the raw 32 bit frame out of the chip.
+//  The decoding in MAX31855::read() is the same for all of them, so a mock
+//  transport returning canned frames can be used to test it off target.
+class MAX31855Transport
+{
+public:
+    virtual void     begin() = 0;
+    virtual uint32_t read32() = 0;
+};
+
+//  Bit bang using digitalWrite/digitalRead, works on any pins
+class MAX31855_GPIO : public MAX31855Transport
+{
+public:
+    MAX31855_GPIO(uint8_t SCLK, uint8_t CS, uint8_t MISO);
+    void     begin();
+    uint32_t read32();
+
+private:
+    uint8_t _sclk;
+    uint8_t _miso;
+    uint8_t _cs;
+};
+
+#if defined(ARDUINO_ARCH_SAMD)
+//  Bit bang by writing the SAMD PORT registers directly, works on any pins
+class MAX31855_FastGPIO : public MAX31855Transport
+{
+public:
+    MAX31855_FastGPIO(uint8_t SCLK, uint8_t CS, uint8_t MISO);
+    void     begin();
+    uint32_t read32();
+
+private:
+    uint8_t _sclk;
+    uint8_t _miso;
+    uint8_t _cs;
+};
+#endif
+
+//  Hardware SPI, the chip must be wired to the SCK/MISO pins of the SPI port
+class MAX31855_HWSPI : public MAX31855Transport
+{
+public:
+    MAX31855_HWSPI(SPIClass &spi, uint8_t CS, uint32_t clock = 4000000);
+    void     begin();
+    uint32_t read32();
+
+private:
+    SPIClass &_spi;
+    uint8_t  _cs;
+    uint32_t _clock;
+};
+
+
 class MAX31855
 {
 public:
     MAX31855(uint8_t SCLK, uint8_t CS, uint8_t MISO);
+    MAX31855(MAX31855Transport &transport);
     void begin();
 
     uint8_t read();
 
+    //  read() split in two, so the frame can be clocked out in an interrupt
+    //  and decoded later on the main loop
+    uint32_t readFrame();
+    uint8_t decode(uint32_t frame);
+
     float   getInternal(void) const     { return _internal; };
     float   getTemperature(void) const  { return _temperature * _TCfactor; }
 
@@ -70,17 +135,32 @@ public:
     void    setTCfactor(const float  TCfactor) { _TCfactor = TCfactor; };
     float   getTCfactor() const         { return _TCfactor; };
 
+    //  NIST linearization for the thermocouple type, NULL for the chip's own
+    //  linear reading. TCfactor still applies on top, leave it at 1 with a table
+    void    setTable(const TCTable *table) { _table = table; };
+    const TCTable *getTable() const     { return _table; };
+
+    //  last reading as the chip gave it, in 1/4C, and the cold junction in 1/16C
+    int16_t getRawTemperature() const   { return _rawTemperature; };
+    int16_t getRawInternal() const      { return _rawInternal; };
+
+    // time in micros the last frame took to read from the chip
+    uint32_t getReadTime() const        { return _readTime; };
+
 private:
-    uint32_t _read();
+    void    _init();
     float   _internal;
     float   _temperature;
     uint8_t _status;
     float   _offset;
     float   _TCfactor;
+    uint32_t _readTime;
+    int16_t _rawTemperature;
+    int16_t _rawInternal;
+    const TCTable *_table;
 
-    uint8_t _sclk;
-    uint8_t _miso;
-    uint8_t _cs;
+    MAX31855_GPIO _gpio;
+    MAX31855Transport *_transport;
 };
 
 #endif
@@ -0,0 +1,102 @@
+#include "OvenModel.h"
+#include <math.h>
+
+int ModelLookAhead( const OvenModel &model )
+{
+  // Look past the dead time plus the 1 second control tick
+  return constrain( (int)round( model.deadTime ) + 1, 1, 15 );
+}
+
+void ModelPIDTunings( const OvenModel &model, float &kp, float &ki, float &kd, float &kff )
+{
+  // Degrees per unit of duty, duty runs 0-256
+  float process = model.gain / 256;
+  // The 1 second control tick adds to the dead time the controller sees
+  float deadTime = model.deadTime + 1;
+  float closedLoop = 2 * deadTime;
+
+  kp = model.tau / ( process * ( closedLoop + deadTime ) );
+  ki = kp / min( model.tau, 4 * ( closedLoop + deadTime ) );
+  kd = kp * deadTime / 2;
+
+  // Duty that holds a ramp of 1 degree per second
+  kff = model.tau / process;
+}
+
+void OvenModelFit::begin( float startTemp )
+{
+  _startTemp = startTemp;
+  _count = 0;
+  _maxSlope = 0;
+  _maxSlopeTime = 0;
+  _maxSlopeTemp = startTemp;
+  _peakTemp = startTemp;
+  _peakTime = 0;
+  _endTemp = startTemp;
+  _endTime = 0;
+}
+
+void OvenModelFit::heating( float t, float temp )
+{
+  // Slide the window along and measure the slope across it
+  if ( _count == OVENMODEL_SLOPE_WINDOW )
+  {
+    for ( int i = 1; i < OVENMODEL_SLOPE_WINDOW; i++ )
+    {
+      _window[i - 1] = _window[i];
+      _windowTime[i - 1] = _windowTime[i];
+    }
+    _count--;
+  }
+  _window[_count] = temp;
+  _windowTime[_count] = t;
+  _count++;
+
+  if ( _count == OVENMODEL_SLOPE_WINDOW )
+  {
+    float span = _windowTime[_count - 1] - _windowTime[0];
+    float slope = ( span > 0 ) ? ( _window[_count - 1] - _window[0] ) / span : 0;
+
+    if ( slope > _maxSlope )
+    {
+      _maxSlope = slope;
+      _maxSlopeTime = ( _windowTime[_count - 1] + _windowTime[0] ) / 2;
+      _maxSlopeTemp = ( _window[_count - 1] + _window[0] ) / 2;
+    }
+  }
+
+  cooling( t, temp );
+}
+
+void OvenModelFit::cooling( float t, float temp )
+{
+  // The oven keeps rising for a bit after the element turns off, the decay is measured from the peak
+  if ( temp >= _peakTemp )
+  {
+    _peakTemp = temp;
+    _peakTime = t;
+  }
+
+  _endTemp = temp;
+  _endTime = t;
+}
+
+bool OvenModelFit::solve( OvenModel &model ) const
+{
+  model.valid = false;
+
+  float rise = _peakTemp - _startTemp;
+  float left = _endTemp - _startTemp;
+
+  if ( _maxSlope <= 0 || _endTime <= _peakTime || left <= 0 || left >= rise )
+    return false;
+
+  model.tau = ( _endTime - _peakTime ) / log( rise / left );
+  model.gain = _maxSlope * model.tau;
+
+  // Where the tangent at the steepest point crosses the starting temp
+  model.deadTime = max( 0.0f, _maxSlopeTime - ( _maxSlopeTemp - _startTemp ) / _maxSlope );
+
+  model.valid = true;
+  return true;
+}
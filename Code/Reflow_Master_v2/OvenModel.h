@@ -0,0 +1,75 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Oven Model
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  A first order plus dead time model of the oven, fitted from the Oven Check run.
+
+  The Oven Check heats the empty oven at full power, then lets it cool with the
+  element off. The dead time and the fastest rate of rise come from the heating
+  step, using the tangent at the steepest point. The time constant comes from the
+  exponential decay while cooling. Gain is the rise above ambient the oven would
+  settle at with the element on full, which is the steepest rate times the time
+  constant.
+
+  The model is then used to pick the look ahead and PID tunings for the oven.
+  ---------------------------------------------------------------------------
+*/
+#ifndef OvenModel_h
+#define OvenModel_h
+
+#include <Arduino.h>
+
+// Number of 1 second samples the heating slope is measured over
+#define OVENMODEL_SLOPE_WINDOW 5
+
+typedef struct {
+  bool valid = false;
+  float gain = 0;     // Degrees C above ambient at full power
+  float tau = 0;      // Time constant in seconds
+  float deadTime = 0; // Seconds before the oven responds
+} OvenModel;
+
+// Look ahead in seconds for the heuristic controller
+int ModelLookAhead( const OvenModel &model );
+
+// PID tunings for the oven, from the SIMC rules with a closed loop time constant of twice the dead time
+void ModelPIDTunings( const OvenModel &model, float &kp, float &ki, float &kd, float &kff );
+
+class OvenModelFit
+{
+  public:
+    // Start a new fit, with the oven at startTemp when full power is applied
+    void begin( float startTemp );
+
+    // Add a sample, t is seconds since full power was applied
+    void heating( float t, float temp );
+    void cooling( float t, float temp );
+
+    // Returns false if the run didn't give enough to fit a model
+    bool solve( OvenModel &model ) const;
+
+    float getMaxSlope() const { return _maxSlope; }
+
+  private:
+    float _startTemp;
+
+    float _window[OVENMODEL_SLOPE_WINDOW];
+    float _windowTime[OVENMODEL_SLOPE_WINDOW];
+    int _count;
+
+    float _maxSlope;
+    float _maxSlopeTime;
+    float _maxSlopeTemp;
+
+    float _peakTemp;
+    float _peakTime;
+    float _endTemp;
+    float _endTime;
+};
+
+#endif
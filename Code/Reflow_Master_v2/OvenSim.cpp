@@ -0,0 +1,51 @@
+#include "OvenSim.h"
+
+// Largest integration step in seconds, keeps the Euler steps stable for small sensor lags
+#define OVENSIM_MAX_STEP 0.1
+
+OvenSim::OvenSim( void )
+{
+  // Defaults roughly match a 1500W 25L toaster oven
+  heaterPower = 1500;
+  thermalMass = 1000;
+  lossCoeff = 5;
+  fanLossCoeff = 15;
+  sensorLag = 4;
+
+  reset();
+}
+
+void OvenSim::reset( float amb )
+{
+  ambient = amb;
+  _air = amb;
+  _sensor = amb;
+  _duty = 0;
+  _fan = false;
+  _lastUpdate = 0;
+  _started = false;
+}
+
+void OvenSim::update( unsigned long now )
+{
+  if ( !_started )
+  {
+    _started = true;
+    _lastUpdate = now;
+    return;
+  }
+
+  float elapsed = ( now - _lastUpdate ) / 1000.0;
+  _lastUpdate = now;
+
+  float loss = lossCoeff + ( _fan ? fanLossCoeff : 0 );
+
+  while ( elapsed > 0 )
+  {
+    float dt = min( elapsed, (float)OVENSIM_MAX_STEP );
+    elapsed -= dt;
+
+    _air += ( heaterPower * _duty - loss * ( _air - ambient ) ) / thermalMass * dt;
+    _sensor += ( _air - _sensor ) * min( dt / sensorLag, 1.0f );
+  }
+}
@@ -0,0 +1,61 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Oven Simulator
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  A lumped thermal model of a toaster oven, used in place of the thermocouple and SSR
+  when SIMULATE_OVEN is defined in the sketch, and by the host build in Code/Host, so
+  controller changes can be tried without heating a real oven.
+
+  The oven air is a single thermal mass heated by the element and losing heat to
+  ambient, with the probe reading following the air temperature through a first
+  order lag:
+
+      mass * dT/dt   = power * duty - loss * ( T - ambient )
+      lag  * dTs/dt  = T - Ts
+  ---------------------------------------------------------------------------
+*/
+#ifndef OvenSim_h
+#define OvenSim_h
+
+#include <Arduino.h>
+
+class OvenSim
+{
+  public:
+    OvenSim( void );
+
+    // Restore the oven, element and probe to ambient
+    void reset( float ambient = 25 );
+
+    // Advance the model up to the time in ms on the supplied clock
+    void update( unsigned long now );
+
+    // Duty is 0-1 of full element power
+    void setDuty( float duty ) { _duty = constrain( duty, 0.0f, 1.0f ); }
+    void setFan( bool on )     { _fan = on; }
+
+    float getTemperature() const { return _sensor; }
+    float getAirTemperature() const { return _air; }
+
+    float heaterPower;  // Element power in W
+    float thermalMass;  // Heat capacity of the oven in J/C
+    float lossCoeff;    // Loss to ambient in W/C with the door closed
+    float fanLossCoeff; // Extra loss to ambient in W/C when the fan is running
+    float sensorLag;    // Probe time constant in seconds
+    float ambient;      // Room temperature in C
+
+  private:
+    float _air;
+    float _sensor;
+    float _duty;
+    bool _fan;
+    unsigned long _lastUpdate;
+    bool _started;
+};
+
+#endif
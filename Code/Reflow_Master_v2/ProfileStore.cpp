@@ -0,0 +1,160 @@
+#include "ProfileStore.h"
+#include "FlashStorage.h"
+#include "Telemetry.h"
+#include "ReflowMasterProfile.h"
+
+static_assert( sizeof( ProfileRecord ) == PROFILE_RECORD_SIZE, "ProfileRecord is part of the upload format" );
+
+#define PROFILESTORE_SIZE ( PROFILESTORE_SLOTS * PROFILESTORE_ROW )
+
+// Reserved flash for the profiles, the same way FlashStorage reserves its space
+__attribute__((__aligned__(256)))
+static const uint8_t profileFlashData[PROFILESTORE_SIZE] = { };
+static FlashClass profileFlash( profileFlashData, PROFILESTORE_SIZE );
+
+static const uint8_t *slotAddress( uint8_t slot )
+{
+  return profileFlashData + slot * PROFILESTORE_ROW;
+}
+
+static int8_t hexDigit( char c )
+{
+  if ( c >= '0' && c <= '9' )
+    return c - '0';
+  if ( c >= 'a' && c <= 'f' )
+    return c - 'a' + 10;
+  if ( c >= 'A' && c <= 'F' )
+    return c - 'A' + 10;
+  return -1;
+}
+
+ProfileStore::ProfileStore( void )
+{
+  _count = 0;
+}
+
+void ProfileStore::begin()
+{
+  // Slot order, so a profile keeps its place in the list when others are added
+  _count = 0;
+  for ( uint8_t slot = 0; slot < PROFILESTORE_SLOTS; slot++ )
+  {
+    ProfileRecord record;
+    if ( read( slot, record ) )
+      _index[_count++] = slot;
+  }
+}
+
+int8_t ProfileStore::slotAt( uint8_t position ) const
+{
+  return ( position < _count ) ? _index[position] : -1;
+}
+
+int8_t ProfileStore::positionOf( uint8_t slot ) const
+{
+  for ( uint8_t i = 0; i < _count; i++ )
+  {
+    if ( _index[i] == slot )
+      return i;
+  }
+  return -1;
+}
+
+bool ProfileStore::read( uint8_t slot, ProfileRecord &record ) const
+{
+  if ( slot >= PROFILESTORE_SLOTS )
+    return false;
+
+  profileFlash.read( slotAddress( slot ), &record, sizeof( ProfileRecord ) );
+  return isValid( record );
+}
+
+int8_t ProfileStore::add( const ProfileRecord &record )
+{
+  if ( !isValid( record ) )
+    return -1;
+
+  // Same name replaces, otherwise the first free row
+  int8_t slot = -1;
+  bool used[PROFILESTORE_SLOTS] = { };
+
+  for ( uint8_t i = 0; i < _count; i++ )
+  {
+    ProfileRecord stored;
+    used[_index[i]] = true;
+    if ( slot < 0 && read( _index[i], stored ) && strncmp( stored.name, record.name, PROFILE_NAME_SIZE ) == 0 )
+      slot = _index[i];
+  }
+
+  for ( uint8_t i = 0; slot < 0 && i < PROFILESTORE_SLOTS; i++ )
+  {
+    if ( !used[i] )
+      slot = i;
+  }
+
+  if ( slot < 0 )
+    return -1;
+
+  profileFlash.erase( slotAddress( slot ), PROFILESTORE_ROW );
+  profileFlash.write( slotAddress( slot ), &record, sizeof( ProfileRecord ) );
+
+  ProfileRecord check;
+  bool ok = read( slot, check );
+  begin();
+
+  return ok ? slot : -1;
+}
+
+bool ProfileStore::remove( uint8_t slot )
+{
+  if ( positionOf( slot ) < 0 )
+    return false;
+
+  profileFlash.erase( slotAddress( slot ), PROFILESTORE_ROW );
+  begin();
+  return true;
+}
+
+uint16_t ProfileStore::crc( const ProfileRecord &record )
+{
+  return Telemetry::crc16( (const uint8_t*)&record, sizeof( ProfileRecord ) - sizeof( record.crc ) );
+}
+
+bool ProfileStore::isValid( const ProfileRecord &record )
+{
+  if ( record.magic != PROFILE_MAGIC || record.version != PROFILE_VERSION || record.crc != crc( record ) )
+    return false;
+
+  if ( record.points < 4 || record.points > PROFILE_POINTS )
+    return false;
+
+  if ( record.name[0] == 0 || memchr( record.name, 0, PROFILE_NAME_SIZE ) == NULL || memchr( record.type, 0, PROFILE_TYPE_SIZE ) == NULL )
+    return false;
+
+  // Loaded the same way LoadStoredGraph() does, and checked the same way as the built in profiles
+  float time[PROFILE_POINTS];
+  float temp[PROFILE_POINTS];
+  for ( uint8_t i = 0; i < record.points; i++ )
+  {
+    time[i] = record.time[i];
+    temp[i] = record.temp[i] / 10.0;
+  }
+
+  return ProfileValid( time, temp, record.points, record.liquidus, record.fanTime, record.offTime );
+}
+
+bool ProfileStore::fromHex( const char *hex, ProfileRecord &record )
+{
+  uint8_t *bytes = (uint8_t*)&record;
+
+  for ( uint8_t i = 0; i < sizeof( ProfileRecord ); i++ )
+  {
+    int8_t high = hexDigit( hex[i * 2] );
+    int8_t low = ( high < 0 ) ? -1 : hexDigit( hex[i * 2 + 1] );
+    if ( low < 0 )
+      return false;
+    bytes[i] = ( high << 4 ) | low;
+  }
+
+  return ( hex[sizeof( ProfileRecord ) * 2] == 0 || hex[sizeof( ProfileRecord ) * 2] == ' ' );
+}
@@ -0,0 +1,103 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Profile Store
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Solder paste profiles uploaded over serial, kept in flash alongside the ones
+  built into the firmware.
+
+  Each profile is a fixed 128 byte record, little endian, version 1:
+    0   uint16  magic 0x5052
+    2   uint8   version
+    3   uint8   number of points, 4-10
+    4   uint16  liquidus C
+    6   uint16  fan on time s
+    8   uint16  heat off time s
+    10  char    name[24], 0 terminated
+    34  char    type[32], 0 terminated
+    66  uint16  time[10] s
+    86  int16   temp[10] in 1/10 C
+    106 int16   tangent[10] in 1/1000 C/s
+    126 uint16  CRC-16/CCITT-FALSE of bytes 0-125
+
+  Each record has a flash row of its own, so adding or deleting one never
+  touches the others. The index of used rows is built once at boot, so picking
+  the Nth stored profile is a lookup, and only that record is read from flash.
+
+  Code/Tools/profile_compile.py turns a JSON or CSV profile into a record and
+  the serial command that uploads it.
+  ---------------------------------------------------------------------------
+*/
+#ifndef ProfileStore_h
+#define ProfileStore_h
+
+#include <Arduino.h>
+
+#define PROFILE_MAGIC 0x5052
+#define PROFILE_VERSION 1
+#define PROFILE_RECORD_SIZE 128
+#define PROFILE_POINTS 10
+#define PROFILE_NAME_SIZE 24
+#define PROFILE_TYPE_SIZE 32
+
+// One profile per 256 byte flash row
+#define PROFILESTORE_SLOTS 32
+#define PROFILESTORE_ROW 256
+
+typedef struct {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t points;
+  uint16_t liquidus;
+  uint16_t fanTime;
+  uint16_t offTime;
+  char name[PROFILE_NAME_SIZE];
+  char type[PROFILE_TYPE_SIZE];
+  uint16_t time[PROFILE_POINTS];
+  int16_t temp[PROFILE_POINTS];
+  int16_t tangent[PROFILE_POINTS];
+  uint16_t crc;
+} ProfileRecord;
+
+class ProfileStore
+{
+  public:
+    ProfileStore( void );
+
+    // Build the index of stored profiles
+    void begin();
+
+    uint8_t count() const { return _count; }
+
+    // Slot of the Nth stored profile, -1 if there isn't one
+    int8_t slotAt( uint8_t position ) const;
+
+    // Position of a slot in the index, -1 if it is empty
+    int8_t positionOf( uint8_t slot ) const;
+
+    // Read and check the profile in a slot
+    bool read( uint8_t slot, ProfileRecord &record ) const;
+
+    // Store a profile, over the top of one with the same name if there is one
+    // Returns the slot, or -1 if the record isn't valid or the store is full
+    int8_t add( const ProfileRecord &record );
+
+    bool remove( uint8_t slot );
+
+    // Checks the CRC and the layout, then the profile with ProfileValid(), the check every profile gets
+    static bool isValid( const ProfileRecord &record );
+    static uint16_t crc( const ProfileRecord &record );
+
+    // 256 hex digits to a record
+    static bool fromHex( const char *hex, ProfileRecord &record );
+
+  private:
+    int8_t _index[PROFILESTORE_SLOTS];
+    uint8_t _count;
+};
+
+#endif
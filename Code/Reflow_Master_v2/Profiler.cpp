@@ -0,0 +1,137 @@
+#include "Profiler.h"
+#include "TextBuffer.h"
+
+// Interrupts off, then back the way they were, so it's safe in an interrupt or with them already off
+static inline uint32_t ProfilerLock()
+{
+#if defined(ARDUINO_ARCH_SAMD)
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  return primask;
+#else
+  noInterrupts();
+  return 0;
+#endif
+}
+
+static inline void ProfilerUnlock( uint32_t primask )
+{
+#if defined(ARDUINO_ARCH_SAMD)
+  __set_PRIMASK( primask );
+#else
+  (void)primask;
+  interrupts();
+#endif
+}
+
+Profiler::Profiler( void )
+{
+  _count = 0;
+  _scenario = "boot";
+  _report = NULL;
+  reset();
+}
+
+int8_t Profiler::section( const char *name )
+{
+  int8_t id = -1;
+
+  // The first run of a section can be in an interrupt
+  uint32_t primask = ProfilerLock();
+  for ( uint8_t i = 0; i < _count && id < 0; i++ )
+  {
+    if ( strcmp( _sections[i].name, name ) == 0 )
+      id = i;
+  }
+
+  if ( id < 0 && _count < PROFILER_SECTIONS )
+  {
+    id = _count;
+    _sections[id].name = name;
+    _count++;
+  }
+  ProfilerUnlock( primask );
+
+  return id;
+}
+
+void Profiler::record( int8_t id, unsigned long micros )
+{
+  if ( id < 0 )
+    return;
+
+  ProfileSection &s = _sections[id];
+  s.count++;
+  s.totalMicros += micros;
+  if ( micros < s.minMicros )
+    s.minMicros = micros;
+  if ( micros > s.maxMicros )
+    s.maxMicros = micros;
+
+  // Bucket is the number of bits in the time
+  uint8_t bucket = ( micros == 0 ) ? 0 : 32 - __builtin_clz( (uint32_t)micros );
+  if ( bucket >= PROFILER_BUCKETS )
+    bucket = PROFILER_BUCKETS - 1;
+  if ( s.histogram[bucket] < 0xFFFF )
+    s.histogram[bucket]++;
+}
+
+void Profiler::setScenario( const char *name )
+{
+  // Nothing to report if nothing ran
+  bool ran = false;
+  for ( uint8_t i = 0; i < _count; i++ )
+    ran |= ( _sections[i].count > 0 );
+
+  if ( _report != NULL && ran )
+    print( *_report );
+
+  _scenario = name;
+  reset();
+}
+
+void Profiler::reset()
+{
+  uint32_t primask = ProfilerLock();
+  for ( uint8_t i = 0; i < PROFILER_SECTIONS; i++ )
+  {
+    ProfileSection &s = _sections[i];
+    s.count = 0;
+    s.minMicros = 0xFFFFFFFF;
+    s.maxMicros = 0;
+    s.totalMicros = 0;
+    memset( s.histogram, 0, sizeof( s.histogram ) );
+  }
+  _start = millis();
+  ProfilerUnlock( primask );
+}
+
+void Profiler::print( Print &out ) const
+{
+  TextBuffer line;
+  line.add( "# scenario " ).add( _scenario ).add( " " ).add( millis() - _start ).add( "ms" );
+  out.println( line.c_str() );
+
+  for ( uint8_t i = 0; i < _count; i++ )
+  {
+    const ProfileSection &s = _sections[i];
+    if ( s.count == 0 )
+      continue;
+
+    line.clear();
+    line.add( _scenario ).add( "," ).add( s.name ).add( "," ).add( s.count ).add( "," ).add( s.minMicros ).add( "," );
+    out.print( line.c_str() );
+
+    line.clear();
+    line.add( (unsigned long)( s.totalMicros / s.count ) ).add( "," ).add( s.maxMicros );
+    out.print( line.c_str() );
+
+    for ( uint8_t b = 0; b < PROFILER_BUCKETS; b++ )
+    {
+      line.clear();
+      line.add( "," ).add( (unsigned)s.histogram[b] );
+      out.print( line.c_str() );
+    }
+    out.println();
+  }
+}
@@ -0,0 +1,112 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Profiler
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Times named sections of code with micros(), to see where loop() spends its
+  time. Each section keeps its count, min, mean and max, and a histogram with
+  one bucket per power of 2 us, so the odd slow run shows up next to the usual.
+
+  PROFILE_SCOPE( "name" ) at the top of a block times the rest of the block,
+  and is safe in an interrupt. The section is looked up once, the first time
+  the line runs. Without PROFILER defined before this header is included the
+  macros are empty, and nothing is compiled in.
+
+  Results are grouped by scenario, set with PROFILE_SCENARIO( "name" ), which
+  starts the stats again. print() writes one comma separated line per section,
+  and Code/Tools/profile_diff.py compares two of those dumps, from different
+  firmware builds say.
+  ---------------------------------------------------------------------------
+*/
+#ifndef Profiler_h
+#define Profiler_h
+
+#include <Arduino.h>
+
+// The clock sections are timed on, in us
+// The host build times on the PC's clock, its micros() only moves when the sketch waits
+#ifndef PROFILER_CLOCK
+#define PROFILER_CLOCK micros
+#endif
+
+#define PROFILER_SECTIONS 16
+// Bucket b counts times of 2^(b-1) to 2^b - 1 us, the last bucket everything longer
+#define PROFILER_BUCKETS 16
+
+typedef struct {
+  const char *name;
+  unsigned long count;
+  unsigned long minMicros;
+  unsigned long maxMicros;
+  uint64_t totalMicros;
+  uint16_t histogram[PROFILER_BUCKETS];
+} ProfileSection;
+
+class Profiler
+{
+  public:
+    Profiler( void );
+
+    // Id for a section name, added the first time it's seen, -1 if there is no room
+    int8_t section( const char *name );
+
+    // Safe to call from an interrupt
+    void record( int8_t id, unsigned long micros );
+
+    // Label for what the board is doing, clears the stats
+    // With a report set, the stats for the last scenario are printed to it first
+    void setScenario( const char *name );
+    void setReport( Print *out ) { _report = out; }
+    const char *getScenario() const { return _scenario; }
+
+    // Clear the stats, the sections stay
+    void reset();
+
+    // One line per section that has run: scenario,section,count,min,mean,max,buckets...
+    void print( Print &out ) const;
+
+  private:
+    ProfileSection _sections[PROFILER_SECTIONS];
+    uint8_t _count;
+    const char *_scenario;
+    unsigned long _start;
+    Print *_report;
+};
+
+// Times the scope it's made in
+class ProfileTimer
+{
+  public:
+    ProfileTimer( Profiler &profiler, int8_t id ) : _profiler( profiler ), _id( id ), _start( PROFILER_CLOCK() ) {}
+    ~ProfileTimer() { _profiler.record( _id, PROFILER_CLOCK() - _start ); }
+
+  private:
+    Profiler &_profiler;
+    int8_t _id;
+    unsigned long _start;
+};
+
+#ifdef PROFILER
+
+// The sketch makes the one Profiler
+extern Profiler profiler;
+
+#define PROFILE_JOIN2( a, b ) a##b
+#define PROFILE_JOIN( a, b ) PROFILE_JOIN2( a, b )
+#define PROFILE_SCOPE( name ) \
+  static int8_t PROFILE_JOIN( profileId, __LINE__ ) = profiler.section( name ); \
+  ProfileTimer PROFILE_JOIN( profileTimer, __LINE__ )( profiler, PROFILE_JOIN( profileId, __LINE__ ) )
+#define PROFILE_SCENARIO( name ) profiler.setScenario( name )
+
+#else
+
+#define PROFILE_SCOPE( name )
+#define PROFILE_SCENARIO( name )
+
+#endif
+
+#endif
@@ -23,107 +23,139 @@
   19/12/2020 v2.00 - Simplified constructor and initialisation
 
   ---------------------------------------------------------------------------
-  Each profile is initialised with the follow data:
+  Each profile is a constexpr table in flash, declared with the follow data:
 
-      Paste name ( String )
-      Paste type ( String )
+      Paste name ( const char* )
+      Paste type ( const char* )
       Paste Reflow Temperature ( int )
-      Profile graph X values - time
-      Profile graph Y values - temperature
-      Size of the time array
+      Profile graph X values - time, a constexpr float array
+      Profile graph Y values - temperature, a constexpr float array the same size
+
+  The last 3 times are when the fan comes on, the heat goes off and the reflow
+  is complete. Everything else about the profile is worked out by the compiler,
+  so a profile costs flash but no RAM and no time at boot.
 */
 #define ELEMENTS(x)   (sizeof(x) / sizeof(x[0]))
 
+// Most points a profile can have
+#define PROFILE_MAX_POINTS 10
+
+// Longest profile in seconds, the most a stored profile's uint16 times can hold
+// The wanted curve is sized to the profile when it's picked, so beyond this it's only RAM
+#define PROFILE_MAX_TIME 65535
+
+// Spline tangent at each point, every profile uses the same ones
+constexpr float profileTangents[PROFILE_MAX_POINTS] = { 1, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+// These are all C++11 constexpr, so they are single expressions with recursion in place of loops,
+// and spell out min and max as those aren't constexpr on every core
+
+constexpr float ProfileBigger( float a, float b )
+{
+  return a > b ? a : b;
+}
+
+constexpr float ProfileMax( const float *v, int len )
+{
+  return len == 1 ? v[0] : ProfileBigger( v[len - 1], ProfileMax( v, len - 1 ) );
+}
+
+// Smallest value above 0
+constexpr float ProfileMinAbove0( const float *v, int len, float minV = 1000 )
+{
+  return len == 0 ? minV : ProfileMinAbove0( v, len - 1, ( v[len - 1] > 0 && v[len - 1] < minV ) ? v[len - 1] : minV );
+}
+
+constexpr bool ProfileTimesIncrease( const float *x, int len )
+{
+  return len < 2 || ( x[len - 1] > x[len - 2] && ProfileTimesIncrease( x, len - 1 ) );
+}
+
+constexpr bool ProfileTempsInRange( const float *y, int len )
+{
+  return len == 0 || ( y[len - 1] > 0 && y[len - 1] <= 300 && ProfileTempsInRange( y, len - 1 ) );
+}
+
+// Every profile is checked with this, built in or stored, so one the store takes is one that loads
+// The fan comes on, then the heat goes off, both by the end, and the paste has to get to liquidus
+constexpr bool ProfileValid( const float *x, const float *y, int len, int liquidus, int fan, int off )
+{
+  return len >= 4 && len <= PROFILE_MAX_POINTS && x[0] >= 0 && ProfileTimesIncrease( x, len ) && x[len - 1] <= PROFILE_MAX_TIME
+         && ProfileTempsInRange( y, len ) && liquidus > 0 && liquidus <= ProfileMax( y, len )
+         && fan > 0 && fan < off && off <= x[len - 1];
+}
+
 class ReflowGraph
 {
 
   public:
-    String n;
-    String t;
+    const char *n;
+    const char *t;
     int tempDeg;
-    float reflowTime[10];
-    float reflowTemp[10];
-    float reflowTangents[10] { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
-    float wantedCurve[480];
-    int len = -1;
-    int fanTime = -1;
-    int offTime = -1;
-    int completeTime = -1;
-
-    float maxWantedDelta = 0;
-
-    ReflowGraph()
+    const float *reflowTime;
+    const float *reflowTemp;
+    const float *reflowTangents;
+    int len;
+    int fanTime;
+    int offTime;
+    int completeTime;
+
+    float maxTemp;
+    float minTemp;
+    float maxTime;
+
+    template<size_t N>
+    constexpr ReflowGraph( const char *nm, const char *tp, int temp, const float (&flowX)[N], const float (&flowY)[N] ) :
+      n( nm ), t( tp ), tempDeg( temp ),
+      reflowTime( flowX ), reflowTemp( flowY ), reflowTangents( profileTangents ), len( N ),
+      fanTime( flowX[ N - 3 ] ), offTime( flowX[ N - 2 ] ), completeTime( flowX[ N - 1 ] ),
+      maxTemp( ProfileMax( flowY, N ) ), minTemp( ProfileMinAbove0( flowY, N ) ), maxTime( ProfileMax( flowX, N ) )
     {
+      static_assert( N >= 4 && N <= PROFILE_MAX_POINTS, "A profile needs 4 to 10 points" );
     }
 
-    ReflowGraph(String nm, String tp, int temp, float flowX[], float flowY[], int arraySize )
+    constexpr ReflowGraph() :
+      n( "" ), t( "" ), tempDeg( 0 ), reflowTime( profileTangents ), reflowTemp( profileTangents ), reflowTangents( profileTangents ),
+      len( 0 ), fanTime( 0 ), offTime( 0 ), completeTime( 0 ), maxTemp( 0 ), minTemp( 0 ), maxTime( 0 )
     {
-      n = nm;
-      t = tp;
-      tempDeg = temp;
-
-      len = min( 10, arraySize );
-
-      Serial.print( nm );
-      Serial.print(" len? ");
-      Serial.println(len);
-
-      fanTime = flowX[ len - 3 ];
-      offTime = flowX[ len - 2 ];
-      completeTime = flowX[ len - 1 ];
-
-      for ( int i = 0; i < len; i++ )
-      {
-        reflowTime[i] = flowX[i];
-        reflowTemp[i] = flowY[i];
-
-        if ( i == 0 )
-          reflowTangents[i] = 1;
-        else if ( i >= fanTime )
-          reflowTangents[i] = 1;
-        else
-          reflowTangents[i] = 0;
-      }
-
-      for ( size_t i = 0; i < ELEMENTS(wantedCurve); i++ )
-        wantedCurve[i] = -1;
     }
 
-    ~ReflowGraph()
+    // A profile loaded at runtime, the arrays have to outlive it
+    ReflowGraph( const char *nm, const char *tp, int temp, const float *flowX, const float *flowY, const float *tangents, int count, int fan, int off ) :
+      n( nm ), t( tp ), tempDeg( temp ),
+      reflowTime( flowX ), reflowTemp( flowY ), reflowTangents( tangents ), len( count ),
+      fanTime( fan ), offTime( off ), completeTime( flowX[ count - 1 ] ),
+      maxTemp( ProfileMax( flowY, count ) ), minTemp( ProfileMinAbove0( flowY, count ) ), maxTime( ProfileMax( flowX, count ) )
     {
     }
 
-    float MaxTempValue()
+    constexpr float MaxTempValue() const
     {
-      float maxV = -1;
-      for ( int i = 0; i < len; i++ )
-        maxV = max( maxV, reflowTemp[i] );
-
-      return maxV;
+      return maxTemp;
     }
 
-    float MinTempValue()
+    constexpr float MinTempValue() const
     {
-      float minV = 1000;
-      for ( int i = 0; i < len; i++ )
-      {
-        if ( reflowTemp[i] > 0 )
-          minV = min( minV, reflowTemp[i] );
-      }
-
-      return minV;
+      return minTemp;
     }
 
-    float MaxTime()
+    constexpr float MaxTime() const
     {
-      float maxV = -1;
-      for ( int i = 0; i < len; i++ )
-        maxV = max( maxV, reflowTime[i] );
+      return maxTime;
+    }
 
-      return maxV;
+    // Checked with a static_assert where the profiles are declared
+    constexpr bool IsValid() const
+    {
+      return ProfileValid( reflowTime, reflowTemp, len, tempDeg, fanTime, offTime );
     }
 };
 
+constexpr bool ProfilesValid( const ReflowGraph *profiles, int count )
+{
+  return count == 0 || ( profiles[0].IsValid() && ProfilesValid( profiles + 1, count - 1 ) );
+}
+
 
 /*
    End ReflowGraphs
@@ -56,9 +56,25 @@
 #include "Adafruit_GFX.h" // Add from Library Manager
 #include "Adafruit_ILI9341.h" // Add from Library Manager
 #include "MAX31855.h"
-#include "OneButton.h" // Add from Library Manager
+#include "ButtonInput.h"
 #include "ReflowMasterProfile.h"
-#include "FlashStorage.h"
+#include "OvenSim.h"
+#include "SetpointCurve.h"
+#include "TCSampler.h"
+#include "TempController.h"
+#include "OvenModel.h"
+#include "TFTWidgets.h"
+#include "GraphPlot.h"
+#include "TextBuffer.h"
+#include "HeapStats.h"
+#include "Telemetry.h"
+#include "RunRecorder.h"
+#include "RunHistory.h"
+#include "SettingsStore.h"
+#include "CoopScheduler.h"
+#include "ProfileStore.h"
+#include "SafetySupervisor.h"
+#include "RelayOutput.h"
 
 // used to obtain the size of an array of any type
 #define ELEMENTS(x)   (sizeof(x) / sizeof(x[0]))
@@ -66,6 +82,30 @@
 // used to show or hide serial debug output
 #define DEBUG
 
+// used to send one binary record per control tick instead of the ASCII debug output
+// decode it with Code/Tools/telemetry_decode.py, the two can't share the serial port so this turns DEBUG off
+//#define TELEMETRY
+
+#ifdef TELEMETRY
+#undef DEBUG
+#endif
+
+// used to time the graph plotting against the old per pixel drawLine() path, over serial debug
+// the old path is drawn on top of the new one, so it doubles the drawing time while enabled
+//#define PLOT_TIMING
+
+// used to time the hot paths with PROFILE_SCOPE(), PROF over serial prints the results
+// each scenario (menu idle, warmup, reflow, bake, profile switch...) is also printed over serial debug as it ends
+// compare two builds' output with Code/Tools/profile_diff.py
+//#define PROFILER
+
+// After PROFILER, so the macros know whether to compile in
+#include "Profiler.h"
+
+// used to run the controller against a simulated oven instead of the thermocouple and SSR, in real time
+// for faster than real time runs use the host build in Code/Host
+//#define SIMULATE_OVEN
+
 // TFT SPI pins
 #define TFT_DC 0
 #define TFT_CS 3
@@ -76,15 +116,46 @@
 #define MAXCS   10
 #define MAXCLK  12
 
+// Extra MAX31855 boards share MAXDO and MAXCLK with the oven probe, each on its own CS pin
+// Uncomment them in order for the probes fitted, e.g. one taped to the board being reflowed
+//#define MAXCS2  9
+//#define MAXCS3  6
+//#define MAXCS4  5
+
+// Thermocouple sample rate in Hz
+// The MAX31855 takes up to 100ms per conversion and reading it aborts a conversion in progress, so don't go above 10
+#define TC_SAMPLE_RATE 10
+// How old in ms the newest good sample can get before the probe is treated as failed
+#define TC_STALE_TIME 500
+// Fastest PID control tick in Hz, half the sample rate so every tick has a new sample to act on
+#define CONTROL_RATE_MAX 5
+
+// Hard ceiling in C on every probe, above the 300c a profile can ask for
+#define SAFETY_CEILING 310
+// Bad samples in a row that cut the relay, so it's off within this many sample periods of a probe fault
+#define SAFETY_FAULT_SAMPLES 3
+
 #define BUTTON0 A0 // menu buttons
 #define BUTTON1 A1 // menu buttons
 #define BUTTON2 A2 // menu buttons
 #define BUTTON3 A3 // menu buttons
 
+// Button timing in ms, steady for BUTTON_DEBOUNCE to count, held for BUTTON_LONG_PRESS then repeating every BUTTON_REPEAT
+#define BUTTON_DEBOUNCE 20
+#define BUTTON_LONG_PRESS 800
+#define BUTTON_REPEAT 20
+
 #define BUZZER A4  // buzzer
 #define RELAY 5    // relay control
 #define FAN A5     // fan control
 
+// The SSR is switched in whole mains half cycles from a timer
+// RELAY_BURST spreads the on half cycles out evenly, RELAY_WINDOW turns it on for the start of each window
+#define RELAY_MODE RELAY_BURST
+#define MAINS_HZ 50
+// ms, the time proportioning window, and what the delivered on-time is reported over
+#define RELAY_WINDOW_TIME 1000
+
 // Just a bunch of re-defined colours
 #define BLUE      0x001F
 #define TEAL      0x0438
@@ -126,18 +197,31 @@ typedef struct {
   int bakeTempGap = 3; // Aim for the desired temp minus this value to compensate for overrun
   bool startFullBlast = false;
   bool beep = true;
+  byte controller = CONTROLLER_HEURISTIC;
+  byte controlRate = 1; // Hz, PID only, up to CONTROL_RATE_MAX
+  float pidKp = PID_DEFAULT_KP;
+  float pidKi = PID_DEFAULT_KI;
+  float pidKd = PID_DEFAULT_KD;
+  float pidKff = PID_DEFAULT_KFF;
+  bool autoTune = false; // Use the oven model from Oven Check for the look ahead and PID tunings
+  OvenModel model;
 } Settings;
 
+// The settings are saved as a single record in the settings store
+static_assert( sizeof( Settings ) + sizeof( StoreHeader ) <= STORE_RECORD_MAX, "Settings too big for the settings store" );
+
 // UI and runtime states
 enum states {
   BOOT = 0,
   WARMUP = 1,
   REFLOW = 2,
   FINISHED = 3,
+  REVIEW = 4,
   MENU = 10,
   SETTINGS = 11,
   SETTINGS_PASTE = 12,
   SETTINGS_RESET = 13,
+  SETTINGS_CONTROL = 14,
   OVENCHECK = 15,
   OVENCHECK_START = 16,
   BAKE_MENU = 20,
@@ -149,10 +233,28 @@ enum states {
 const String ver = "2.05";
 bool newSettings = false;
 
-// TC variables
-unsigned long nextTempRead;
-unsigned long nextTempAvgRead;
-int avgReadCount = 0;
+// Boot work still to finish in the background once the menu is up
+#define BOOT_CHIME 0x01
+#define BOOT_CURVE 0x02
+#define BOOT_FIRST_TEMP 0x04
+byte bootPending = 0;
+
+// Boot phase timestamps, reported over serial
+#define BOOT_MARKS 10
+const char *bootMarkName[BOOT_MARKS];
+unsigned long bootMarkTime[BOOT_MARKS];
+byte bootMarks = 0;
+
+// Set by the control task when there is something new for the screen task to show
+bool screenPending = false;
+
+// A whole screen for the screen task to draw, when a higher priority task changes state
+typedef void (*ScreenDraw)(void);
+ScreenDraw screenChange = NULL;
+
+// A heading for the screen task to show in place of the reflow temps
+const char *headingPending = NULL;
+unsigned int headingPendingColor = WHITE;
 
 unsigned long keepFanOnTime = 0;
 
@@ -171,12 +273,14 @@ float maxBakeTemp = 150; // 100 Degrees C
 // Current index in the settings screen
 int settings_pointer = 0;
 
-// Initialise an array to hold 5 profiles
-// Increase this array if you plan to add more
-ReflowGraph solderPaste[5];
-// Index into the current profile
+// Profiles uploaded over serial, listed after the built in ones
+ProfileStore profileStore;
 
-int currentGraphIndex = 0;
+// set.paste is the index of a built in profile, or this plus the flash slot of a stored one
+#define PROFILE_STORED_ID 64
+
+// Profiles per page on the paste screen
+#define PASTE_PER_PAGE 5
 
 // Calibration data - currently diabled in this version
 int calibrationState = 0;
@@ -188,20 +292,22 @@ bool calibrationDownMatch = false;
 float calibrationDropVal = 0;
 float calibrationRiseVal = 0;
 
+// Oven model fit from the Oven Check run
+OvenModelFit ovenFit;
+long calibrationStepTime = 0; // Seconds since full power was applied
+
 // Runtime reflow variables
 int tcError = 0;
 bool tcWasError = false;
 bool tcWasGood = true;
 float currentDuty = 0;
 float currentTemp = 0;
+float currentWantedTemp = 0;
 float cachedCurrentTemp = 0;
-float currentTempAvg = 0;
-float lastTemp = -1;
 float currentDetla = 0;
 unsigned int currentPlotColor = GREEN;
 bool isCuttoff = false;
 bool isFanOn = false;
-float lastWantedTemp = -1;
 int buzzerCount = 5;
 
 // Graph Size for UI
@@ -215,67 +321,217 @@ int graphRangeStep_Y = 15;
 // Create a spline reference for converting profile values to a spline for the graph
 Spline baseCurve;
 
+// Wanted temperature for each second of the current profile
+SetpointCurve wantedCurve;
+bool wantedCurveBuilt = false;
+
+// Temperature controllers for reflow, picked in settings
+HeuristicController heuristicController;
+PIDController pidController;
+
 // Initialise the TFT screen
 Adafruit_ILI9341 tft = Adafruit_ILI9341(TFT_CS, TFT_DC, TFT_RESET);
 
 // Initialise the MAX31855 IC for thermocouple tempterature reading
-MAX31855 tc(MAXCLK, MAXCS, MAXDO);
+// Direct port access clocks the frame out far quicker than digitalWrite/digitalRead
+#if defined(ARDUINO_ARCH_SAMD)
+typedef MAX31855_FastGPIO TCTransport;
+#else
+typedef MAX31855_GPIO TCTransport;
+#endif
+TCTransport tcBus(MAXCLK, MAXCS, MAXDO);
+MAX31855 tc(tcBus);
+
+#ifdef MAXCS2
+TCTransport tcBus2(MAXCLK, MAXCS2, MAXDO);
+MAX31855 tc2(tcBus2);
+#endif
+#ifdef MAXCS3
+TCTransport tcBus3(MAXCLK, MAXCS3, MAXDO);
+MAX31855 tc3(tcBus3);
+#endif
+#ifdef MAXCS4
+TCTransport tcBus4(MAXCLK, MAXCS4, MAXDO);
+MAX31855 tc4(tcBus4);
+#endif
+
+// Channel 0 is the oven's own air probe
+MAX31855 *tcChannels[] = {
+  &tc,
+#ifdef MAXCS2
+  &tc2,
+#endif
+#ifdef MAXCS3
+  &tc3,
+#endif
+#ifdef MAXCS4
+  &tc4,
+#endif
+};
+
+#define TC_CHANNELS ELEMENTS( tcChannels )
+static_assert( TC_CHANNELS <= TCSAMPLER_CHANNELS, "Too many thermocouples for the sampler" );
+
+// Defined further down, the objects below are built with it
+void RelayCutoff();
+
+// Samples all the MAX31855 in one burst from a timer and filters the readings
+TCSampler tcSampler( tcChannels, TC_CHANNELS );
+
+// Cuts the relay from the sampler interrupt on a probe fault or over the ceiling, and runs the watchdog during a run
+SafetySupervisor safety( RelayCutoff );
+
+// Burst fire or time proportioned SSR output
+RelayOutput relayOutput( RELAY );
+
+#ifdef PROFILER
+// Timings of the PROFILE_SCOPE() sections
+Profiler profiler;
+#endif
+
+// Per probe calibration, and which probe the temperature is controlled on
+// Kept in the settings store under its own key, so the main settings don't change shape
+typedef struct {
+  float offset[TCSAMPLER_CHANNELS] = { 0, 0, 0, 0 };
+  float factor[TCSAMPLER_CHANNELS] = { K_TC, K_TC, K_TC, K_TC };
+  byte control = 0;
+  char type[TCSAMPLER_CHANNELS] = { 'K', 'K', 'K', 'K' }; // NIST table for each, L for the chip's linear reading
+} ProbeSettings;
+
+ProbeSettings probes;
+
+// Latest filtered temperature of every probe, for plotting and logging
+float probeTemp[TCSAMPLER_CHANNELS];
+uint16_t probeColors[TCSAMPLER_CHANNELS] = { GREEN, CYAN, MAGENTA, ORANGE };
 
-// Initialise the buttons using OneButton library
-OneButton button0(BUTTON0, false);
-OneButton button1(BUTTON1, false);
-OneButton button2(BUTTON2, false);
-OneButton button3(BUTTON3, false);
+#ifdef SIMULATE_OVEN
+// Thermal model that stands in for the oven, SSR and thermocouple
+OvenSim ovenSim;
+#endif
+
+// The buttons are read from interrupts into a queue, ButtonTask() works through it
+const uint8_t buttonPins[] = { BUTTON0, BUTTON1, BUTTON2, BUTTON3 };
+ButtonInput buttons( buttonPins, ELEMENTS( buttonPins ) );
 
 // UI button positions and sizes
 int buttonPosY[] = { 19, 74, 129, 184 };
 int buttonHeight = 16;
 int buttonWidth = 4;
 
+// Retained widgets for text that gets redrawn every tick, only the glyphs that change are sent to the TFT
+TFTLabel headingLabel( 0, 0, 4, WHITE, BLACK );
+TFTLabel menuTempLabel( 20, 95, 6, GREEN, BLACK );
+TFTLabel warmupTempLabel( 160, 130, 5, YELLOW, BLACK, ALIGN_CENTER );
+TFTLabel bakeTitleLabel( 20, 20, 3, BLUE, BLACK );
+TFTLabel bakeTempLabel( 20, 82, 5, YELLOW, BLACK );
+TFTLabel bakeTimeLabel( 20, 157, 5, YELLOW, BLACK );
+TFTButtonHint bakeHint( buttonPosY[0], buttonWidth, buttonHeight );
+
 // Initiliase a reference for the settings file that we store in flash storage
 Settings set;
-// Initialise flash storage
-FlashStorage(flash_store, Settings);
 
-// This is where we initialise each of the profiles that will get loaded into the Reflkow Master
-void LoadPaste()
-{
-  /*
-    Each profile is initialised with the follow data:
+// Journaled settings, and any other small records that need to survive a power cycle
+SettingsStore settingsStore;
+
+// Binary telemetry records, sent when TELEMETRY is defined
+Telemetry telemetry( Serial );
+
+// Every reflow, bake and oven check is recorded and kept in flash
+RunRecorder runRecorder;
+
+// Temperature of the last reflow or bake at every zoom, for the review graph
+RunHistory runHistory;
+float reviewStart = 0; // Seconds
+float reviewSpan = 0;
+
+// Everything loop() does is a task, timed off the control clock
+CoopScheduler scheduler( millis );
+int8_t controlTask = -1;
+int8_t fanTask = -1;
+int8_t bootTask = -1;
+int8_t menuTask = -1;
+int8_t beepTask = -1;
+int8_t secondBeepTask = -1;
+
+// These are the profiles that will get loaded into the Reflow Master
+// They live in flash, add more to the end of solderPaste
+constexpr float chipquikTime[] = { 1, 90, 180, 210, 240, 270, 300 };
+constexpr float chipquikTemp[] = { 27, 90, 130, 138, 165, 138, 27 };
+
+constexpr float chemtoolsLTime[] = { 1, 90, 180, 225, 240, 270, 300 };
+constexpr float chemtoolsLTemp[] = { 25, 150, 175, 190, 210, 125, 50 };
+
+constexpr float chemtoolsSTime[] = { 1, 75, 130, 180, 210, 250 };
+constexpr float chemtoolsSTemp[] = { 25, 150, 175, 210, 150, 50 };
+
+constexpr float docSolderTime[] = { 1, 60, 120, 160, 210, 260, 310 };
+constexpr float docSolderTemp[] = { 25, 105, 150, 150, 220, 150, 20 };
+
+constexpr float sac305Time[] = { 1, 90, 165, 225, 330, 360 };
+constexpr float sac305Temp[] = { 25, 150, 175, 235, 100, 25 };
 
-        Paste name ( String )
-        Paste type ( String )
-        Paste Reflow Temperature ( int )
-        Profile graph X values - time
-        Profile graph Y values - temperature
-        Length of the graph  ( int, how long if the graph array )
-  */
-  float baseGraphX[7] = { 1, 90, 180, 210, 240, 270, 300 }; // time
-  float baseGraphY[7] = { 27, 90, 130, 138, 165, 138, 27 }; // value
+constexpr ReflowGraph solderPaste[] = {
+  ReflowGraph( "CHIPQUIK", "No-Clean Sn42/Bi57.6/Ag0.4", 138, chipquikTime, chipquikTemp ),
+  ReflowGraph( "CHEMTOOLS L", "No Clean 63CR218 Sn63/Pb37", 183, chemtoolsLTime, chemtoolsLTemp ),
+  ReflowGraph( "CHEMTOOLS S", "No Clean 63CR218 Sn63/Pb37", 183, chemtoolsSTime, chemtoolsSTemp ),
+  ReflowGraph( "DOC SOLDER", "No Clean Sn63/Pb36/Ag2", 187, docSolderTime, docSolderTemp ),
+  ReflowGraph( "CHEMTOOLS SAC305 HD", "Sn96.5/Ag3.0/Cu0.5", 225, sac305Time, sac305Temp ),
+};
 
-  solderPaste[0] = ReflowGraph( "CHIPQUIK", "No-Clean Sn42/Bi57.6/Ag0.4", 138, baseGraphX, baseGraphY, ELEMENTS(baseGraphX) );
+static_assert( ProfilesValid( solderPaste, ELEMENTS( solderPaste ) ), "A profile's times must go up from 0 to PROFILE_MAX_TIME, temps must be 1-300c and reach the liquidus" );
 
-  float baseGraphX1[7] = { 1, 90, 180, 225, 240, 270, 300 }; // time
-  float baseGraphY1[7] = { 25, 150, 175, 190, 210, 125, 50 }; // value
+// The current profile, either one of solderPaste or the stored one loaded into RAM
+const ReflowGraph *currentGraph = &solderPaste[0];
 
-  solderPaste[1] = ReflowGraph( "CHEMTOOLS L", "No Clean 63CR218 Sn63/Pb37", 183, baseGraphX1, baseGraphY1, ELEMENTS(baseGraphX1) );
+// Only the stored profile in use is kept in RAM, the record holds its name and type
+ProfileRecord storedRecord;
+float storedTime[PROFILE_POINTS];
+float storedTemp[PROFILE_POINTS];
+float storedTangents[PROFILE_POINTS];
+ReflowGraph storedGraph;
 
-  float baseGraphX2[6] = { 1, 75, 130, 180, 210, 250 }; // time
-  float baseGraphY2[6] = { 25, 150, 175, 210, 150, 50 }; // value
+int ProfileCount()
+{
+  return ELEMENTS( solderPaste ) + profileStore.count();
+}
 
-  solderPaste[2] = ReflowGraph( "CHEMTOOLS S", "No Clean 63CR218 Sn63/Pb37", 183, baseGraphX2, baseGraphY2, ELEMENTS(baseGraphX2) );
+// Profile id at a place in the paste list
+int ProfileIdAt( int position )
+{
+  if ( position < (int) ELEMENTS( solderPaste ) )
+    return position;
 
-  float baseGraphX3[7] = { 1, 60, 120, 160, 210, 260, 310 }; // time
-  float baseGraphY3[7] = { 25, 105, 150, 150, 220, 150, 20 }; // value
+  return PROFILE_STORED_ID + profileStore.slotAt( position - ELEMENTS( solderPaste ) );
+}
 
-  solderPaste[3] = ReflowGraph( "DOC SOLDER", "No Clean Sn63/Pb36/Ag2", 187, baseGraphX3, baseGraphY3, ELEMENTS(baseGraphX3) );
+// Place in the paste list of a profile id, the first one if it has gone
+int ProfilePosition( int id )
+{
+  if ( id < (int) ELEMENTS( solderPaste ) )
+    return id;
 
-  float baseGraphX4[6] = { 1, 90, 165, 225, 330, 360 }; // time
-  float baseGraphY4[6] = { 25, 150, 175, 235, 100, 25 }; // value
+  int position = ( id >= PROFILE_STORED_ID ) ? profileStore.positionOf( id - PROFILE_STORED_ID ) : -1;
+  return ( position < 0 ) ? 0 : ELEMENTS( solderPaste ) + position;
+}
 
-  solderPaste[4] = ReflowGraph( "CHEMTOOLS SAC305 HD", "Sn96.5/Ag3.0/Cu0.5", 225, baseGraphX4, baseGraphY4, ELEMENTS(baseGraphX4) );
+bool LoadStoredGraph( uint8_t slot )
+{
+  if ( !profileStore.read( slot, storedRecord ) )
+    return false;
 
-  //TODO: Think of a better way to initalise these baseGraph arrays to not need unique array creation
+  for ( uint8_t i = 0; i < storedRecord.points; i++ )
+  {
+    storedTime[i] = storedRecord.time[i];
+    storedTemp[i] = storedRecord.temp[i] / 10.0;
+    storedTangents[i] = storedRecord.tangent[i] / 1000.0;
+  }
+
+  ReflowGraph graph( storedRecord.name, storedRecord.type, storedRecord.liquidus, storedTime, storedTemp, storedTangents, storedRecord.points, storedRecord.fanTime, storedRecord.offTime );
+  if ( !graph.IsValid() )
+    return false;
+
+  storedGraph = graph;
+  return true;
 }
 
 // Obtain the temp value of the current profile at time X
@@ -290,15 +546,33 @@ int GetGraphTime( int x )
 }
 
 // Obtain the current profile
-ReflowGraph CurrentGraph()
+// Returned by reference, the profile holds the full wanted curve and copying it every control tick is expensive
+const ReflowGraph& CurrentGraph()
 {
-  return solderPaste[ currentGraphIndex ];
+  return *currentGraph;
 }
 
-// Set the current profile via the array index
-void SetCurrentGraph( int index )
+// Set the current profile via its id
+// The wanted curve can be left to BuildWantedCurve() later, so boot doesn't wait on it
+void SetCurrentGraph( int id, bool deferCurve = false )
 {
-  currentGraphIndex = index;
+  PROFILE_SCOPE( "set profile" );
+  if ( id < (int) ELEMENTS( solderPaste ) )
+  {
+    currentGraph = &solderPaste[ id ];
+  }
+  else if ( id >= PROFILE_STORED_ID && LoadStoredGraph( id - PROFILE_STORED_ID ) )
+  {
+    currentGraph = &storedGraph;
+  }
+  else
+  {
+    // The stored profile was deleted or is damaged, so go back to the first one
+    debug_println("Stored paste missing, using the first one");
+    set.paste = 0;
+    currentGraph = &solderPaste[ 0 ];
+  }
+
   graphRangeMax_X = CurrentGraph().MaxTime();
   graphRangeMax_Y = CurrentGraph().MaxTempValue() + 5; // extra padding
   graphRangeMin_Y = CurrentGraph().MinTempValue();
@@ -307,32 +581,27 @@ void SetCurrentGraph( int index )
   debug_println( CurrentGraph().n );
   debug_println( CurrentGraph().t );
 
-  // Initialise the spline for the profile to allow for smooth graph display on UI
   timeX = 0;
+  wantedCurveBuilt = false;
+
+  if ( !deferCurve )
+    BuildWantedCurve();
+}
+
+// False if the profile is too long for the wanted curve to fit in RAM
+bool BuildWantedCurve()
+{
+  PROFILE_SCOPE( "build curve" );
+  // Initialise the spline for the profile to allow for smooth graph display on UI
   baseCurve.setPoints(CurrentGraph().reflowTime, CurrentGraph().reflowTemp, CurrentGraph().reflowTangents, CurrentGraph().len);
   baseCurve.setDegree( Hermite );
 
   // Re-interpolate data based on spline
-  for ( int ii = 0; ii <= graphRangeMax_X; ii += 1 )
-  {
-    solderPaste[ currentGraphIndex ].wantedCurve[ii] = baseCurve.value(ii);
-  }
-
-  // calculate the biggest graph movement delta
-  float lastWanted = -1;
-  for ( int i = 0; i < solderPaste[ currentGraphIndex ].offTime; i++ )
-  {
-    float wantedTemp = solderPaste[ currentGraphIndex ].wantedCurve[ i ];
+  wantedCurveBuilt = wantedCurve.build( baseCurve, graphRangeMax_X );
+  if ( !wantedCurveBuilt )
+    debug_println("Not enough RAM for the wanted curve!");
 
-    if ( lastWanted > -1 )
-    {
-      float wantedDiff = (wantedTemp - lastWanted );
-
-      if ( wantedDiff > solderPaste[ currentGraphIndex ].maxWantedDelta )
-        solderPaste[ currentGraphIndex ].maxWantedDelta = wantedDiff;
-    }
-    lastWanted  = wantedTemp;
-  }
+  return wantedCurveBuilt;
 }
 
 void setup()
@@ -350,392 +619,567 @@ void setup()
   pinMode( 13, INPUT );
 
   // Turn off the SSR - duty cycle of 0
+  relayOutput.begin( RELAY_MODE, MAINS_HZ, RELAY_WINDOW_TIME );
   SetRelayFrequency( 0 );
 
 #ifdef DEBUG
   Serial.begin(115200);
 #endif
 
-  // just wait a bit before we try to load settings from FLASH
-  delay(500);
+  BootMark( "setup" );
 
-  // load settings from FLASH
-  set = flash_store.read();
+#if defined(PROFILER) && defined(DEBUG)
+  profiler.setReport( &Serial );
+#endif
+
+  // Lower priority numbers run first when more than one task is due
+  scheduler.add( "sample", SampleTask, 25, 0 );
+  controlTask = scheduler.add( "control", ControlTask, 1000, 1 );
+  scheduler.add( "buttons", ButtonTask, 10, 2 );
+  fanTask = scheduler.add( "fan", KeepFanOnCheck, 0, 3 );
+  scheduler.add( "screen", ScreenTask, 100, 4 );
+  scheduler.add( "serial", CheckSerial, 20, 5 );
+  bootTask = scheduler.add( "boot", BootUpdate, 10, 6 );
+  scheduler.add( "heap", HeapTask, 100, 7 );
+  menuTask = scheduler.add( "menu", AbortDone, 0, 4 );
+  beepTask = scheduler.add( "beep", DoneBeep, 0, 3 );
+  secondBeepTask = scheduler.add( "beep 2", ShortBeep, 0, 3 );
+#ifdef SIMULATE_OVEN
+  scheduler.add( "oven sim", SimulateOvenTask, 100, 0 );
+#endif
 
-  // If no settings were loaded, initialise data and save
-  if ( !set.valid )
+  // load settings from FLASH, the NVM can be read straight out of reset
+  settingsStore.begin();
+
+  // Nothing in the settings store yet, so start from the defaults
+  // Settings saved by firmware from before the store aren't read, the layout has changed, so they reset on upgrade
+  if ( !LoadSettings() )
   {
     SetDefaults();
     newSettings = true;
-    flash_store.write(set);
+    SaveSettings();
   }
 
-  // Attatch button IO for OneButton
-  button0.attachClick(button0Press);
-  button1.attachClick(button1Press);
-  button2.attachClick(button2Press);
-  button3.attachClick(button3Press);
+  BootMark( "settings" );
 
-  // New long press buttons for changing bake time and temp values
-  button2.attachLongPressStart(button2LongPressStart);
-  button2.attachDuringLongPress(button2LongPress);
-  button3.attachLongPressStart(button3LongPressStart);
-  button3.attachDuringLongPress(button3LongPress);
+  // Button presses queue up from here on, HandleButton() says what they do
+  buttons.begin( BUTTON_DEBOUNCE, BUTTON_LONG_PRESS, BUTTON_REPEAT );
 
   debug_println("TFT Begin...");
 
-  // Start up the TFT and show the boot screen
+  // Start up the TFT, the menu is drawn over the top as soon as the rest is ready
   tft.begin(32000000);
-  BootScreen();
-  BuzzerStart();
+  tft.setRotation(1);
+  BootMark( "tft" );
 
-  delay(200);
+  // The chime plays out from loop() while the menu is in use
+  BuzzerStart();
 
-  // Start up the MAX31855
+  // Start up the MAX31855, the first conversion turns up in the background
   debug_println("Thermocouple Begin...");
-  tc.begin();
+  LoadProbeSettings();
+  for ( uint8_t c = 0; c < TC_CHANNELS; c++ )
+    tcChannels[c]->begin();
+  safety.begin( TC_SAMPLE_RATE, SAFETY_CEILING, SAFETY_FAULT_SAMPLES );
+  tcSampler.setWatcher( SafetyCheck );
+  tcSampler.begin( TC_SAMPLE_RATE, SampleTC );
+  BootMark( "tc" );
 
-  // delay for initial temp probe read to be garbage
-  delay(500);
+  if ( SafetySupervisor::wasWatchdogReset() )
+    debug_println("Reset by the watchdog, the main loop hung during a run");
 
-  // Load up the profiles
-  LoadPaste();
-  // Set the current profile based on last selected
-  SetCurrentGraph( set.paste );
+  // Set the current profile based on last selected, the wanted curve is built after the menu is up
+  profileStore.begin();
+  SetCurrentGraph( set.paste, true );
 
-  delay(500);
+  // Don't show a temp until there is a real one, but show the TC error if nothing turns up
+  scheduler.start( controlTask, 1000 );
+  bootPending = BOOT_CHIME | BOOT_CURVE | BOOT_FIRST_TEMP;
 
   // Show the main menu
   ShowMenu();
+  BootMark( "menu" );
+}
+
+// Note the time since reset of a boot phase
+void BootMark( const char *name )
+{
+  if ( bootMarks < BOOT_MARKS )
+  {
+    bootMarkName[bootMarks] = name;
+    bootMarkTime[bootMarks] = millis();
+    bootMarks++;
+  }
+}
+
+void PrintBootTimes( Print &out )
+{
+  for ( int i = 0; i < bootMarks; i++ )
+  {
+    TextBuffer line;
+    line.add( "Boot " ).add( bootMarkName[i] ).add( " " ).add( bootMarkTime[i] ).add( "ms" );
+    out.println( line.c_str() );
+  }
+
+  if ( bootPending )
+    out.println( "Boot still finishing" );
+}
+
+// The boot steps that don't need to hold up the menu, one at a time from loop()
+void BootUpdate()
+{
+  if ( !bootPending )
+    return;
+
+  if ( ( bootPending & BOOT_FIRST_TEMP ) && tcSampler.hasReading( probes.control ) )
+  {
+    bootPending &= ~BOOT_FIRST_TEMP;
+    scheduler.start( controlTask ); // show it now
+    BootMark( "first temp" );
+  }
+  else if ( ( bootPending & BOOT_CHIME ) && !BuzzerStartUpdate() )
+  {
+    bootPending &= ~BOOT_CHIME;
+    BootMark( "chime" );
+  }
+  else if ( bootPending & BOOT_CURVE )
+  {
+    if ( !wantedCurveBuilt )
+      BuildWantedCurve();
+    bootPending &= ~BOOT_CURVE;
+    BootMark( "curve" );
+  }
+
+  if ( !bootPending )
+  {
+    scheduler.stop( bootTask );
+#ifdef DEBUG
+    PrintBootTimes( Serial );
+#endif
+  }
 }
 
 // Helper method to display the temperature on the TFT
 void DisplayTemp( bool center = false )
 {
+  char buf[TFTWIDGET_MAX_CHARS + 1];
+
   if ( center )
   {
-    tft.setTextColor( YELLOW, BLACK );
-    tft.setTextSize(5);
-    println_Center( tft, "  " + String( round( currentTemp ) ) + "c  ", tft.width() / 2, ( tft.height() / 2 ) + 10 );
+    snprintf( buf, sizeof( buf ), "  %ldc  ", (long)round( currentTemp ) );
+    warmupTempLabel.print( tft, buf );
   }
   else
   {
-    if ( round( currentTemp ) != round( cachedCurrentTemp ) )
-    {
-      // display the previous temp in black to clear it
-      tft.setTextColor( BLACK, BLACK );
-      tft.setTextSize(6);
-      tft.setCursor( 20,  ( tft.height() / 2 ) - 25 );
-      tft.println( String( round( cachedCurrentTemp ) ) + "c" );
-
-      // display the new temp in green
-      tft.setTextColor( GREEN, BLACK );
-      tft.setCursor( 20,  ( tft.height() / 2 ) - 25 );
-      tft.println( String( round( currentTemp ) ) + "c" );
+    // The label only sends the digits that changed
+    snprintf( buf, sizeof( buf ), "%ldc", (long)round( currentTemp ) );
+    menuTempLabel.print( tft, buf );
 
-      // cache the current temp
-      cachedCurrentTemp = currentTemp;
-    }
+    // cache the current temp
+    cachedCurrentTemp = currentTemp;
   }
 }
 
 void loop()
 {
-  // Used by OneButton to poll for button inputs
-  button0.tick();
-  button1.tick();
-  button2.tick();
-  button3.tick();
+  // The watchdog resets the board if loop() stops getting back here during a run
+  safety.feed();
+
+  // Only does anything on boards without timer support
+  relayOutput.poll();
+
+  // Run whichever task is due, or sleep until one is
+  scheduler.run();
+}
+
+// Decode and filter any new thermocouple samples, and poll for them on boards without timer support
+void SampleTask()
+{
+  PROFILE_SCOPE( "tc update" );
+  tcSampler.poll();
+  tcSampler.update();
 
-  // Current activity state machine
-  if ( state == BOOT ) // BOOT
+  // The relay is already off if the supervisor tripped, this ends the run
+  safety.checkStale( tcSampler.getSampleAge( millis(), probes.control ), TC_STALE_TIME );
+  if ( safety.isArmed() && safety.isTripped() )
   {
-    return;
+    AbortReflow();
+    safety.disarm(); // in case it was a state AbortReflow() leaves alone
   }
-  else if ( state == WARMUP ) // WARMUP - We sit here until the probe reaches the starting temp for the profile
-  {
-    if ( nextTempRead < millis() ) // we only read the probe every second
-    {
-      nextTempRead = millis() + 1000;
+}
 
-      ReadCurrentTemp();
-      MatchTemp();
+// Act on the button presses queued since the last time, however long ago that was
+void ButtonTask()
+{
+  PROFILE_SCOPE( "buttons" );
+  buttons.poll();
 
-      if ( currentTemp >= GetGraphValue(0) )
-      {
-        // We have reached the starting temp for the profile, so lets start baking our boards!
-        lastTemp = currentTemp;
-        avgReadCount = 0;
-        currentTempAvg = 0;
+  ButtonEvent event;
+  while ( buttons.read( event ) )
+    HandleButton( event );
+}
 
-        StartReflow();
-      }
-      else if ( currentTemp > 0 )
-      {
-        // Show the current probe temp so we can watch as it reaches the minimum starting value
-        DisplayTemp( true );
-      }
+// The control tick for the current state, every second, or at the PID rate while reflowing
+void ControlTask()
+{
+  PROFILE_SCOPE( "control" );
+  if ( state == WARMUP ) // WARMUP - We sit here until the probe reaches the starting temp for the profile
+  {
+    ReadCurrentTemp();
+    MatchTemp( 1 );
+    LogTick();
+
+    if ( currentTemp >= GetGraphValue(0) )
+    {
+      // We have reached the starting temp for the profile, so lets start baking our boards!
+
+      StartReflow();
+    }
+    else
+    {
+      screenPending = true;
     }
-    return;
   }
-  else if ( state == FINISHED ) // FINISHED
+  else if ( state == MENU ) // MENU
   {
-    // do we keep the fan on after reflow finishes to help cooldown?
-    KeepFanOnCheck();
-    return;
+    // We show the current probe temp in the men screen just for info
+    ReadCurrentTemp();
+    screenPending = true;
   }
-  else if ( state == SETTINGS || state == SETTINGS_PASTE || state == SETTINGS_RESET ) // SETTINGS
+  else if ( state == BAKE )
   {
-    // Currently not used
-    return;
+    // Set the temp from the filtered samples
+    ReadCurrentTemp();
+
+    // Control the SSR
+    MatchTemp_Bake();
+    LogTick();
+
+    if ( currentTemp > 0 )
+      currentBakeTime--;
+
+    TextBuffer stats;
+    stats.add( "TFT " ).add( tftStats.frameBytes ).add( " bytes " ).add( tftStats.frameMicros ).add( "us max " ).add( tftStats.maxFrameMicros ).add( "us skipped " ).add( tftStats.glyphsSkipped );
+    debug_println( stats.c_str() );
+
+    if ( currentBakeTime <= 0 )
+      BakeDone();
   }
-  else if ( state == MENU ) // MENU
+  else if ( state == OVENCHECK_START ) // calibration - not currently used
   {
-    if ( nextTempRead < millis() )
-    {
-      nextTempRead = millis() + 1000;
+    ReadCurrentTemp();
 
-      // We show the current probe temp in the men screen just for info
-      ReadCurrentTemp();
+    MatchCalibrationTemp();
+    LogTick();
 
-      if ( tcError > 0 )
-      {
-        // Clear TC Temp background if there was one!
-        if ( tcWasGood )
-        {
-          tcWasGood = false;
-          tft.setTextColor( BLACK, BLACK );
-          tft.setTextSize(6);
-          tft.setCursor( 20,  ( tft.height() / 2 ) - 25 );
-          tft.println( String( round( cachedCurrentTemp ) ) + "c" );
+    screenPending = true;
+  }
+  else if ( state == REFLOW )
+  {
+    unsigned long interval = ControlInterval();
 
-          tft.fillRect( 5, tft.height() / 2 - 20, 180, 31, RED );
-        }
-        tcWasError = true;
-        tft.setTextColor( WHITE, RED );
-        tft.setTextSize(3);        
-        tft.setCursor( 10, ( tft.height() / 2 ) - 15 );
-        tft.println( "TC ERR #" + String( tcError ) );
-      }
-      else if ( currentTemp > 0 )
-      {
-        // Clear error background if there was one!
-        if ( tcWasError )
-        {
-          cachedCurrentTemp = 0;
-          tcWasError = false;
-          tft.fillRect( 0, tft.height() / 2 - 20, 200, 32, BLACK );
-        }
-        tcWasGood = true;
-        DisplayTemp();
-      }
+    // Set the temp from the filtered samples
+    ReadCurrentTemp();
+
+    // Control the SSR
+    MatchTemp( interval / 1000.0 );
+    LogTick();
+
+    if ( currentTemp > 0 )
+    {
+      timeX += interval / 1000.0;
+
+      if ( timeX > CurrentGraph().completeTime )
+        EndReflow();
+      else
+        screenPending = true;
     }
+  }
+
+  // The next tick is one interval on from this one's deadline, however long the screen takes
+  scheduler.setPeriod( controlTask, state == REFLOW ? ControlInterval() : 1000 );
+}
 
-    // do we keep the fan on after reflow finishes to help cooldown?
-    KeepFanOnCheck();
+// Screen updates for the last control tick, kept out of the control task so they can't delay it
+void ScreenTask()
+{
+  PROFILE_SCOPE( "screen" );
+  if ( screenChange != NULL )
+  {
+    ScreenDraw draw = screenChange;
+    screenChange = NULL;
+    draw();
+  }
+
+  if ( state == BAKE )
+  {
+    // The baking dots animate at the screen rate
+    TFTFrameBegin();
+    UpdateBake();
+    TFTFrameEnd();
     return;
   }
-  else if ( state == BAKE_MENU || state == BAKE_DONE )
+
+  if ( !screenPending )
+    return;
+  screenPending = false;
+
+  if ( state == WARMUP )
   {
-    // do nothing in these states
+    // Show the current probe temp so we can watch as it reaches the minimum starting value
+    if ( currentTemp > 0 )
+      DisplayTemp( true );
   }
-  else if ( state == BAKE )
+  else if ( state == MENU )
   {
-    if ( currentBakeTime > 0 )
+    if ( tcError > 0 )
     {
-      if ( nextTempAvgRead < millis() )
+      // Clear TC Temp background if there was one!
+      if ( tcWasGood )
       {
-        nextTempAvgRead = millis() + 100;
-        ReadCurrentTempAvg();
-      }
-
-      if ( nextTempRead < millis() )
-      {
-        nextTempRead = millis() + 1000;
+        tcWasGood = false;
+        menuTempLabel.clear( tft );
 
-        // Set the temp from the average
-        currentTemp = ( currentTempAvg / avgReadCount );
-        // clear the variables for next run
-        avgReadCount = 0;
-        currentTempAvg = 0;
-
-        // Control the SSR
-        MatchTemp_Bake();
-
-        if ( currentTemp > 0 )
-          currentBakeTime--;
+        tft.fillRect( 5, tft.height() / 2 - 20, 180, 31, RED );
       }
-
-      UpdateBake();
+      tcWasError = true;
+      tft.setTextColor( WHITE, RED );
+      tft.setTextSize(3);        
+      tft.setCursor( 10, ( tft.height() / 2 ) - 15 );
+      TextBuffer err;
+      tft.println( err.add( "TC ERR #" ).add( tcError ).c_str() );
     }
-    else
+    else if ( currentTemp > 0 )
     {
-      BakeDone();
+      // Clear error background if there was one!
+      if ( tcWasError )
+      {
+        cachedCurrentTemp = 0;
+        tcWasError = false;
+        tft.fillRect( 0, tft.height() / 2 - 20, 200, 32, BLACK );
+      }
+      tcWasGood = true;
+      DisplayTemp();
     }
   }
-  else if ( state == OVENCHECK )
-  {
-    // Currently not used
-    return;
-  }
-  else if ( state == OVENCHECK_START ) // calibration - not currently used
+  else if ( state == OVENCHECK_START )
   {
-    if ( nextTempRead < millis() )
+    if ( calibrationState < 2 )
     {
-      nextTempRead = millis() + 1000;
+      tft.setTextColor( CYAN, BLACK );
+      tft.setTextSize(2);
 
-      ReadCurrentTemp();
-
-      MatchCalibrationTemp();
+      if ( calibrationState == 0 )
+      {
+        if ( currentTemp < GetGraphValue(0) )
+          println_Center( tft, "WARMING UP", tft.width() / 2, ( tft.height() / 2 ) - 15 );
+        else
+          println_Center( tft, "HEAT UP SPEED", tft.width() / 2, ( tft.height() / 2 ) - 15 );
 
-      if ( calibrationState < 2 )
+        TextBuffer target;
+        target.add( "TARGET " ).add( GetGraphValue(1) ).add( "c in " ).add( GetGraphTime(1) ).add( "s" );
+        println_Center( tft, target.c_str(), tft.width() / 2, ( tft.height() - 18 ) );
+      }
+      else if ( calibrationState == 1 )
       {
-        tft.setTextColor( CYAN, BLACK );
-        tft.setTextSize(2);
+        println_Center( tft, "COOL DOWN LEVEL", tft.width() / 2, ( tft.height() / 2 ) - 15 );
+        tft.fillRect( 0, tft.height() - 30, tft.width(), 30, BLACK );
+      }
 
+      // only show the timer when we have hit the profile starting temp
+      if (currentTemp >= GetGraphValue(0) )
+      {
+        // adjust the timer colour based on good or bad values
         if ( calibrationState == 0 )
         {
-          if ( currentTemp < GetGraphValue(0) )
-            println_Center( tft, "WARMING UP", tft.width() / 2, ( tft.height() / 2 ) - 15 );
+          if ( calibrationSeconds <= GetGraphTime(1) )
+            tft.setTextColor( WHITE, BLACK );
           else
-            println_Center( tft, "HEAT UP SPEED", tft.width() / 2, ( tft.height() / 2 ) - 15 );
-
-          println_Center( tft, "TARGET " + String( GetGraphValue(1) ) + "c in " + String( GetGraphTime(1) ) + "s", tft.width() / 2, ( tft.height() - 18 ) );
+            tft.setTextColor( ORANGE, BLACK );
         }
-        else if ( calibrationState == 1 )
+        else
         {
-          println_Center( tft, "COOL DOWN LEVEL", tft.width() / 2, ( tft.height() / 2 ) - 15 );
-          tft.fillRect( 0, tft.height() - 30, tft.width(), 30, BLACK );
+          tft.setTextColor( WHITE, BLACK );
         }
 
-        // only show the timer when we have hit the profile starting temp
-        if (currentTemp >= GetGraphValue(0) )
-        {
-          // adjust the timer colour based on good or bad values
-          if ( calibrationState == 0 )
-          {
-            if ( calibrationSeconds <= GetGraphTime(1) )
-              tft.setTextColor( WHITE, BLACK );
-            else
-              tft.setTextColor( ORANGE, BLACK );
-          }
-          else
-          {
-            tft.setTextColor( WHITE, BLACK );
-          }
+        tft.setTextSize(4);
+        TextBuffer secs;
+        secs.add( " " ).add( calibrationSeconds ).add( " secs " );
+        println_Center( tft, secs.c_str(), tft.width() / 2, ( tft.height() / 2 ) + 20 );
+      }
+      tft.setTextSize(5);
+      tft.setTextColor( YELLOW, BLACK );
+      TextBuffer temp;
+      temp.add( " " ).add( (long)round( currentTemp ) ).add( "c " );
+      println_Center( tft, temp.c_str(), tft.width() / 2, ( tft.height() / 2 ) + 65 );
 
-          tft.setTextSize(4);
-          println_Center( tft, " " + String( calibrationSeconds ) + " secs ", tft.width() / 2, ( tft.height() / 2 ) + 20 );
-        }
-        tft.setTextSize(5);
-        tft.setTextColor( YELLOW, BLACK );
-        println_Center( tft, " " + String( round( currentTemp ) ) + "c ", tft.width() / 2, ( tft.height() / 2 ) + 65 );
 
+    }
+    else if ( calibrationState == 2 )
+    {
+      calibrationState = 3;
+
+      tft.setTextColor( GREEN, BLACK );
+      tft.setTextSize(2);
+      tft.fillRect( 0, (tft.height() / 2 ) - 45, tft.width(), (tft.height() / 2 ) + 45, BLACK );
+      println_Center( tft, "RESULTS!", tft.width() / 2, ( tft.height() / 2 ) - 45 );
 
+      tft.setTextColor( WHITE, BLACK );
+      tft.setCursor( 20, ( tft.height() / 2 ) - 10 );
+      tft.print( "RISE " );
+      if ( calibrationUpMatch )
+      {
+        tft.setTextColor( GREEN, BLACK );
+        tft.print( "PASS" );
       }
-      else if ( calibrationState == 2 )
+      else
       {
-        calibrationState = 3;
+        tft.setTextColor( ORANGE, BLACK );
+        tft.print( "FAIL " );
+        tft.setTextColor( WHITE, BLACK );
+        TextBuffer reached;
+        tft.print( reached.add( "REACHED " ).add( (long)round(calibrationRiseVal * 100) ).add( "%" ).c_str() );
+      }
 
+      tft.setTextColor( WHITE, BLACK );
+      tft.setCursor( 20, ( tft.height() / 2 ) + 20 );
+      tft.print( "DROP " );
+      if ( calibrationDownMatch )
+      {
         tft.setTextColor( GREEN, BLACK );
-        tft.setTextSize(2);
-        tft.fillRect( 0, (tft.height() / 2 ) - 45, tft.width(), (tft.height() / 2 ) + 45, BLACK );
-        println_Center( tft, "RESULTS!", tft.width() / 2, ( tft.height() / 2 ) - 45 );
-
+        tft.print( "PASS" );
         tft.setTextColor( WHITE, BLACK );
-        tft.setCursor( 20, ( tft.height() / 2 ) - 10 );
-        tft.print( "RISE " );
-        if ( calibrationUpMatch )
-        {
-          tft.setTextColor( GREEN, BLACK );
-          tft.print( "PASS" );
-        }
-        else
-        {
-          tft.setTextColor( ORANGE, BLACK );
-          tft.print( "FAIL " );
-          tft.setTextColor( WHITE, BLACK );
-          tft.print( "REACHED " + String( round(calibrationRiseVal * 100) ) + "%") ;
-        }
+        TextBuffer dropped;
+        tft.print( dropped.add( "DROPPED " ).add( (long)round(calibrationDropVal * 100) ).add( "%" ).c_str() );
+      }
+      else
+      {
+        tft.setTextColor( ORANGE, BLACK );
+        tft.print( "FAIL " );
+        tft.setTextColor( WHITE, BLACK );
+        TextBuffer dropped;
+        tft.print( dropped.add( "DROPPED " ).add( (long)round(calibrationDropVal * 100) ).add( "%" ).c_str() );
 
         tft.setTextColor( WHITE, BLACK );
-        tft.setCursor( 20, ( tft.height() / 2 ) + 20 );
-        tft.print( "DROP " );
-        if ( calibrationDownMatch )
-        {
-          tft.setTextColor( GREEN, BLACK );
-          tft.print( "PASS" );
-          tft.setTextColor( WHITE, BLACK );
-          tft.print( "DROPPED " + String( round(calibrationDropVal * 100) ) + "%") ;
-        }
-        else
-        {
-          tft.setTextColor( ORANGE, BLACK );
-          tft.print( "FAIL " );
-          tft.setTextColor( WHITE, BLACK );
-          tft.print( "DROPPED " + String( round(calibrationDropVal * 100) ) + "%") ;
+        tft.setCursor( 20, ( tft.height() / 2 ) + 40 );
+        tft.print( "RECOMMEND ADDING FAN") ;
+      }
 
-          tft.setTextColor( WHITE, BLACK );
-          tft.setCursor( 20, ( tft.height() / 2 ) + 40 );
-          tft.print( "RECOMMEND ADDING FAN") ;
-        }
+      tft.setTextSize(1);
+      tft.setCursor( 20, ( tft.height() / 2 ) + 60 );
+      if ( set.model.valid )
+      {
+        tft.setTextColor( WHITE, BLACK );
+        TextBuffer model;
+        model.add( "MODEL GAIN " ).add( set.model.gain, 0 ).add( "c TAU " ).add( set.model.tau, 0 ).add( "s DEAD " ).add( set.model.deadTime, 1 ).add( "s" );
+        tft.print( model.c_str() );
+      }
+      else
+      {
+        tft.setTextColor( ORANGE, BLACK );
+        tft.print( "COULD NOT FIT AN OVEN MODEL" );
       }
+      tft.setTextSize(2);
     }
   }
-  else // state is REFLOW
+  else if ( state == REFLOW )
   {
-    if ( nextTempAvgRead < millis() )
+    TFTFrameBegin();
+    Graph( tft, timeX, currentTemp );
+    GraphProbes( tft, timeX );
+
+    if ( headingPending != NULL )
     {
-      nextTempAvgRead = millis() + 100;
-      ReadCurrentTempAvg();
+      DrawHeading( headingPending, headingPendingColor, BLACK );
+      headingPending = NULL;
     }
-    if ( nextTempRead < millis() )
+    else if ( timeX < CurrentGraph().fanTime )
     {
-      nextTempRead = millis() + 1000;
-
-      // Set the temp from the average
-      currentTemp = ( currentTempAvg / avgReadCount );
-      // clear the variables for next run
-      avgReadCount = 0;
-      currentTempAvg = 0;
-
-      // Control the SSR
-      MatchTemp();
+      float wantedTemp = wantedCurve.value( (int)timeX );
+      TextBuffer heading;
+      heading.add( (long)round( currentTemp ) ).add( "/" ).add( (int)wantedTemp ).add( "c" );
+      DrawHeading( heading.c_str(), currentPlotColor, BLACK );
+    }
+    TFTFrameEnd();
+  }
+}
 
-      if ( currentTemp > 0 )
-      {
-        timeX++;
+// Watch the heap for growth and fragmentation over long runs
+void HeapTask()
+{
+  HeapSample();
+}
 
-        if ( timeX > CurrentGraph().completeTime )
-        {
-          EndReflow();
-        }
-        else
-        {
-          Graph(tft, timeX, currentTemp, 30, 220, 270, 180 );
+// Everything that gets logged each control tick
+void LogTick()
+{
+  runRecorder.tick( millis(), currentTemp, currentWantedTemp, constrain( round( currentDuty ), 0, 255 ), isFanOn, tcError );
 
-          if ( timeX < CurrentGraph().fanTime )
-          {
-            float wantedTemp = CurrentGraph().wantedCurve[ (int)timeX ];
-            DrawHeading( String( round( currentTemp ) ) + "/" + String( (int)wantedTemp ) + "c", currentPlotColor, BLACK );
-          }
-        }
-      }
-    }
+  // On the same time line as the graph, which only moves on with a good reading
+  if ( currentTemp > 0 )
+  {
+    if ( state == REFLOW )
+      runHistory.add( timeX, currentTemp );
+    else if ( state == BAKE )
+      runHistory.add( set.bakeTime - currentBakeTime, currentTemp );
   }
+  SendTelemetry();
 }
 
-// This is where the SSR is controlled via PWM
+// One binary record per control tick when TELEMETRY is defined
+void SendTelemetry()
+{
+#ifdef TELEMETRY
+  TelemetryRecord record;
+  record.state = state;
+  record.flags = ( isFanOn ? TELEMETRY_FLAG_FAN : 0 ) | ( isCuttoff ? TELEMETRY_FLAG_CUTOFF : 0 );
+  record.millis = millis();
+  record.timeX = timeX;
+  record.currentTemp = currentTemp;
+  record.wantedTemp = currentWantedTemp;
+  record.duty = constrain( round( currentDuty ), 0, 255 );
+  record.tcError = tcError;
+  record.control = probes.control;
+  for ( uint8_t c = 0; c < TC_CHANNELS; c++ )
+    record.probes[c] = probeTemp[c];
+  telemetry.send( record );
+#endif
+}
+
+// This is where the SSR is controlled, in whole mains half cycles
 void SetRelayFrequency( int duty )
 {
   // calculate the wanted duty based on settings power override
   currentDuty = ((float)duty * set.power );
 
-  // Write the clamped duty cycle to the RELAY GPIO
-  analogWrite( RELAY, constrain( round( currentDuty ), 0, 255) );
+  // Nothing turns it back on after a safety trip until the next run
+  // Checked with interrupts off, so a trip can't land between the check and the write
+  noInterrupts();
+  if ( safety.isTripped() )
+    currentDuty = 0;
+  relayOutput.setDuty( constrain( round( currentDuty ), 0, 255) );
+  interrupts();
+
+  TextBuffer relay;
+  relay.add( "RELAY Duty Cycle: " ).add( ( currentDuty / 256.0 ) * 100 ).add( "% Using Settings Power: " ).add( (long)round( set.power * 100 ) ).add( "%" );
+  debug_println( relay.c_str() );
+
+  relay.clear();
+  relay.add( "RELAY Last Window On: " ).add( relayOutput.getLastOnTime() ).add( "ms of " ).add( relayOutput.getWindowTime() ).add( "ms" );
+  debug_println( relay.c_str() );
+}
 
-  debug_print("RELAY Duty Cycle: ");
-  debug_println( String( ( currentDuty / 256.0 ) * 100) + "%" + " Using Settings Power: " + String( round( set.power * 100 )) + "%" );
+// Relay off now rather than at the next half cycle, safe from an interrupt
+void RelayCutoff()
+{
+  relayOutput.off();
+  currentDuty = 0;
+}
+
+// Every burst of samples goes past the supervisor from the sampler interrupt
+void SafetyCheck( const uint32_t frames[], uint8_t channels )
+{
+  safety.check( frames, channels );
 }
 
 /*
@@ -750,13 +1194,19 @@ void MatchCalibrationTemp()
     // Set SSR to full duty cycle - 100%
     SetRelayFrequency( 255 );
 
+    if ( calibrationStepTime == 0 )
+      ovenFit.begin( currentTemp );
+    ovenFit.heating( calibrationStepTime, currentTemp );
+    calibrationStepTime++;
+
     // Only count seconds from when we reach the profile starting temp
     if ( currentTemp >= GetGraphValue(0) )
       calibrationSeconds ++;
 
     if ( currentTemp >= GetGraphValue(1) )
     {
-      debug_println("Cal Heat Up Speed " + String( calibrationSeconds ) );
+      TextBuffer cal;
+      debug_println( cal.add( "Cal Heat Up Speed " ).add( calibrationSeconds ).c_str() );
 
       calibrationRiseVal =  ( (float)currentTemp / (float)( GetGraphValue(1) ) );
       calibrationUpMatch = ( calibrationSeconds <= GetGraphTime(1) );
@@ -771,17 +1221,32 @@ void MatchCalibrationTemp()
     calibrationSeconds --;
     SetRelayFrequency( 0 );
 
+    ovenFit.cooling( calibrationStepTime, currentTemp );
+    calibrationStepTime++;
+
     if ( calibrationSeconds <= 0 )
     {
       Buzzer( 2000, 50 );
-      debug_println("Cal Cool Down Temp " + String( currentTemp ) );
+      TextBuffer cal;
+      debug_println( cal.add( "Cal Cool Down Temp " ).add( currentTemp ).c_str() );
 
       // calc calibration drop percentage value
       calibrationDropVal = ( (float)( GetGraphValue(1) - currentTemp ) / (float)GetGraphValue(1) );
       // Did we drop in temp > 33% of our target temp? If not, recomment using a fan!
       calibrationDownMatch = ( calibrationDropVal > 0.33 );
 
+      // Fit the oven model from the heat up and cool down, and keep it for auto tuning
+      if ( ovenFit.solve( set.model ) )
+      {
+        TextBuffer model;
+        model.add( "Oven Model Gain " ).add( set.model.gain ).add( " Tau " ).add( set.model.tau ).add( " Dead " ).add( set.model.deadTime );
+        debug_println( model.c_str() );
+        SaveSettings();
+      }
+
       calibrationState = 2; // finished
+      runRecorder.end( RUN_COMPLETE );
+      safety.disarm();
       StartFan( true );
     }
   }
@@ -792,38 +1257,121 @@ void MatchCalibrationTemp()
    SOME CALIBRATION CODE THAT IS CURRENTLY USED FOR THE OVEN CHECK SYSTEM
 */
 
+// Keep the fan on for a while after a reflow or bake to help cooldown
+void HoldFanOn()
+{
+  keepFanOnTime = millis() + set.fanTimeAfterReflow * 1000;
+  scheduler.start( fanTask, set.fanTimeAfterReflow * 1000 );
+}
+
+// Run by the fan task when the hold is up, and when going back to the menu
 void KeepFanOnCheck()
 {
   // do we keep the fan on after reflow finishes to help cooldown?
-  if ( set.useFan && millis() < keepFanOnTime )
+  if ( set.useFan && !CoopScheduler::reached( millis(), keepFanOnTime ) )
     StartFan( true );
   else
     StartFan( false );
 }
 
-void ReadCurrentTempAvg()
+#ifdef SIMULATE_OVEN
+// Moves the oven on from the main loop, with whatever the relay and fan are doing now
+// Only the temperature is read from the sampler interrupt, the rest of the model is never touched there
+void SimulateOvenTask()
 {
-  int status = tc.read();
+  ovenSim.setDuty( relayOutput.getDuty() / 255.0 );
+  ovenSim.setFan( isFanOn );
+  ovenSim.update( millis() );
+}
 
-  if (status != 0 )
+// Build a MAX31855 frame holding the simulated probe temperature, with the cold junction at 25c
+uint32_t SimulatedFrame()
+{
+  // What the chip would read, so linearizing it gets back to the simulated temp
+  int32_t temp = round( ovenSim.getTemperature() * 4 );
+  if ( tc.getTable() != NULL )
+    temp = TCChipReading( *tc.getTable(), round( ovenSim.getTemperature() * 64 ), 25 * 16 );
+
+  return ( (uint32_t)( temp & 0x3FFF ) << 18 ) | ( ( 25 * 16 ) << 4 );
+}
+#endif
+
+// Called from the sampler timer interrupt, so keep it short!
+void SampleTC()
+{
+  PROFILE_SCOPE( "tc sample" );
+#ifdef SIMULATE_OVEN
+  // Every probe sees the simulated oven
+  uint32_t frames[TCSAMPLER_CHANNELS];
+  frames[0] = SimulatedFrame();
+  for ( uint8_t c = 1; c < TC_CHANNELS; c++ )
+    frames[c] = frames[0];
+  tcSampler.push( frames, millis() );
+#else
+  tcSampler.sample( millis() );
+#endif
+}
+
+// Get the filtered temperature of a probe from the sampler and return the TC status
+// Odd failed samples are filtered out, it's only an error if no good samples have arrived recently
+int ReadProbe( uint8_t channel, float &temp )
+{
+  if ( tcSampler.hasReading( channel ) && tcSampler.getSampleAge( millis(), channel ) <= TC_STALE_TIME )
   {
-    tcError = status;
-    debug_print("TC Read Error Status: ");
-    debug_println( status );
+    temp = tcSampler.getFiltered( channel );
+    return STATUS_OK;
   }
-  else
+
+  if ( tcSampler.getStatus( channel ) != STATUS_OK )
+    return tcSampler.getStatus( channel );
+
+  return STATUS_NOREAD;
+}
+
+// Push the probe calibration into the drivers, each chip applies its own as it decodes
+void ApplyProbeSettings()
+{
+  if ( probes.control >= TC_CHANNELS )
+    probes.control = 0;
+
+  for ( uint8_t c = 0; c < TC_CHANNELS; c++ )
   {
-    tcError = 0;
-    tc.getInternal(); // required by the TC to get the correct compensated value back
-    currentTempAvg += tc.getTemperature() + set.tempOffset;
-    avgReadCount++;
+    tcChannels[c]->setOffset( probes.offset[c] );
+    tcChannels[c]->setTCfactor( probes.factor[c] );
+    tcChannels[c]->setTable( TCTableFor( probes.type[c] ) );
   }
 }
 
-// Read the temp probe
+bool LoadProbeSettings()
+{
+  bool loaded = settingsStore.read( STORE_PROBES, &probes, sizeof( probes ) );
+  if ( !loaded )
+    probes = ProbeSettings();
+
+  ApplyProbeSettings();
+  return loaded;
+}
+
+bool SaveProbeSettings()
+{
+  ApplyProbeSettings();
+  return settingsStore.write( STORE_PROBES, &probes, sizeof( probes ) );
+}
+
+// Read the temp probes, the one being controlled on becomes currentTemp
 void ReadCurrentTemp()
 {
-  int status = tc.read();
+  tcSampler.update();
+
+  // The other probes are only plotted and logged, a fault on one doesn't stop anything
+  for ( uint8_t c = 0; c < TC_CHANNELS; c++ )
+  {
+    if ( ReadProbe( c, probeTemp[c] ) != STATUS_OK )
+      probeTemp[c] = NAN;
+  }
+
+  float temp = 0;
+  int status = ReadProbe( probes.control, temp );
   if (status != 0 )
   {
     tcError = status;
@@ -833,17 +1381,21 @@ void ReadCurrentTemp()
   else
   {
     tcError = 0;
-    tc.getInternal(); // required by the TC to get the correct compensated value back
-    currentTemp = tc.getTemperature() + set.tempOffset;
+    currentTemp = temp + set.tempOffset;
     currentTemp =  constrain(currentTemp, -10, 350);
 
     debug_print("TC Read: ");
-    debug_println( currentTemp );
+    debug_print( currentTemp );
+    debug_print(" in ");
+    debug_print( tcChannels[probes.control]->getReadTime() );
+    debug_print("us Faults: ");
+    debug_println( tcSampler.getFaultCount( probes.control ) );
   }
 }
 
 void MatchTemp_Bake()
 {
+  PROFILE_SCOPE( "match bake" );
   float duty = 0;
   float tempDiff = 0;
   float perc = 0;
@@ -896,35 +1448,87 @@ void MatchTemp_Bake()
 
   duty = constrain( duty, 0, 256 );
   currentPlotColor = GREEN;
+  currentWantedTemp = wantedTemp;
   SetRelayFrequency( duty );
 }
 
 
+// The controller MatchTemp() dispatches through, picked by set.controller
+TempController& CurrentController()
+{
+  if ( set.controller == CONTROLLER_PID )
+    return pidController;
+
+  return heuristicController;
+}
+
+// How often in ms the reflow control tick runs
+// The heuristic is tuned for a 1 second tick, so only the PID can run faster
+unsigned long ControlInterval()
+{
+  if ( set.controller == CONTROLLER_PID )
+    return 1000 / constrain( set.controlRate, 1, CONTROL_RATE_MAX );
+
+  return 1000;
+}
+
+// True when the look ahead and PID tunings come from the oven model
+bool UseOvenModel()
+{
+  return ( set.autoTune && set.model.valid );
+}
+
+// Seconds to look ahead of the profile, warm is the ramp before the soak ends
+int LookAhead( bool warm )
+{
+  if ( UseOvenModel() )
+    return ModelLookAhead( set.model );
+
+  return warm ? set.lookAheadWarm : set.lookAhead;
+}
+
+// Get the controller ready for a new run
+void ResetController()
+{
+  if ( UseOvenModel() )
+  {
+    float kp, ki, kd, kff;
+    ModelPIDTunings( set.model, kp, ki, kd, kff );
+
+    // Keep the tunings inside the ranges that can be set by hand
+    pidController.setTunings( constrain( kp, 0, 60 ), constrain( ki, 0, 1 ), constrain( kd, 0, 100 ), constrain( kff, 0, 400 ) );
+  }
+  else
+  {
+    pidController.setTunings( set.pidKp, set.pidKi, set.pidKd, set.pidKff );
+  }
+
+  CurrentController().reset( currentTemp );
+}
+
 // This is where the magic happens for temperature matching
-void MatchTemp()
+// dt is the time in seconds since the last call
+void MatchTemp( float dt )
 {
+  PROFILE_SCOPE( "match temp" );
   float duty = 0;
   float wantedTemp = 0;
-  float wantedDiff = 0;
-  float tempDiff = 0;
-  float perc = 0;
 
   // if we are still before the main flow cut-off time (last peak)
   if ( timeX < CurrentGraph().offTime )
   {
     // We are looking XXX steps ahead of the ideal graph to compensate for slow movement of oven temp
-    if ( timeX < CurrentGraph().reflowTime[2] )
-      wantedTemp = CurrentGraph().wantedCurve[ (int)timeX + set.lookAheadWarm ];
-    else
-      wantedTemp = CurrentGraph().wantedCurve[ (int)timeX + set.lookAhead ];
+    int lookAhead = LookAhead( timeX < CurrentGraph().reflowTime[2] );
 
-    wantedDiff = (wantedTemp - lastWantedTemp );
-    lastWantedTemp = wantedTemp;
+    ControlInput in;
+    in.current = currentTemp;
+    in.wanted = wantedCurve.value( (int)timeX );
+    in.wantedAhead = wantedCurve.value( (int)timeX + lookAhead );
+    in.lookAhead = lookAhead;
+    in.dt = dt;
 
-    tempDiff = ( currentTemp - lastTemp );
-    lastTemp = currentTemp;
-
-    perc = wantedDiff - tempDiff;
+    wantedTemp = in.wantedAhead;
+    duty = CurrentController().update( in );
 
     debug_print( "T: " );
     debug_print( timeX );
@@ -935,15 +1539,6 @@ void MatchTemp()
     debug_print( "  Wanted: " );
     debug_print( wantedTemp );
 
-    debug_print( "  T Diff: " );
-    debug_print( tempDiff  );
-
-    debug_print( "  W Diff: " );
-    debug_print( wantedDiff );
-
-    debug_print( "  Perc: " );
-    debug_print( perc );
-
     isCuttoff = false;
 
     // have to passed the fan turn on time?
@@ -954,7 +1549,7 @@ void MatchTemp()
       // If we are usng the fan, turn it on
       if ( set.useFan )
       {
-        DrawHeading( "COOLDOWN!", GREEN, BLACK );
+        ShowHeading( "COOLDOWN!", GREEN );
         Buzzer( 2000, 2000 );
 
         StartFan ( true );
@@ -963,7 +1558,7 @@ void MatchTemp()
       {
         if ( buzzerCount > 0 )
         {
-          DrawHeading( "OPEN OVEN", RED, BLACK );
+          ShowHeading( "OPEN OVEN", RED );
           Buzzer( 2000, 2000 );
           buzzerCount--;
         }
@@ -975,7 +1570,7 @@ void MatchTemp()
     // YELL at the user to open the oven door
     if ( !isCuttoff && set.useFan )
     {
-      DrawHeading( "OPEN OVEN", GREEN, BLACK );
+      ShowHeading( "OPEN OVEN", GREEN );
       Buzzer( 2000, 2000 );
 
       debug_print( "CUTOFF: " );
@@ -986,38 +1581,23 @@ void MatchTemp()
     }
 
     isCuttoff = true;
+
+    // Past the last peak the oven stays off
+    duty = 0;
   }
 
   currentDetla = (wantedTemp - currentTemp);
 
   debug_print( "  Delta: " );
   debug_print( currentDetla );
-
-  float base = 128;
-
-  if ( currentDetla >= 0 )
-  {
-    base = 128 + ( currentDetla * 5 );
-  }
-  else if ( currentDetla < 0 )
-  {
-    base = 32 + ( currentDetla * 15 );
-  }
-
-  base = constrain( base, 0, 256 );
-
-  debug_print("  Base: ");
-  debug_print( base );
   debug_print( " -> " );
 
-  duty = base + ( 172 * perc );
-  duty = constrain( duty, 0, 256 );
-
   // override for full blast at start only if the current Temp is less than the wanted Temp, and it's in the ram before pre-soak starts.
   if ( set.startFullBlast && timeX < CurrentGraph().reflowTime[1] && currentTemp < wantedTemp )
     duty = 256;
 
   currentPlotColor = GREEN;
+  currentWantedTemp = wantedTemp;
 
   SetRelayFrequency( duty );
 }
@@ -1044,13 +1624,32 @@ void StartFan ( bool start )
   }
 }
 
-void DrawHeading( String lbl, unsigned int acolor, unsigned int bcolor )
+void DrawHeading( const char *lbl, unsigned int acolor, unsigned int bcolor )
+{
+  PROFILE_SCOPE( "heading" );
+  headingLabel.print( tft, lbl, acolor, bcolor );
+}
+
+// Have the screen task draw a heading, for the control tick which mustn't wait on the TFT
+void ShowHeading( const char *lbl, unsigned int acolor )
+{
+  headingPending = lbl;
+  headingPendingColor = acolor;
+  screenPending = true;
+}
+
+// Clear the whole screen, and let the retained widgets know there is nothing of them left on it
+void ClearScreen()
 {
-  tft.setTextSize(4);
-  tft.setTextColor(acolor , bcolor);
-  tft.setCursor(0, 0);
-  tft.fillRect( 0, 0, 220, 40, BLACK );
-  tft.println( String(lbl) );
+  tft.fillScreen(BLACK);
+
+  headingLabel.forget();
+  menuTempLabel.forget();
+  warmupTempLabel.forget();
+  bakeTitleLabel.forget();
+  bakeTempLabel.forget();
+  bakeTimeLabel.forget();
+  bakeHint.forget();
 }
 
 // buzz the buzzer
@@ -1063,68 +1662,96 @@ void Buzzer( int hertz, int len )
   tone( BUZZER, hertz, len);
 }
 
-// Startup Tune
+// Startup Tune, hertz, length and the gap until the next note
+const int startTune[][3] = { { 262, 200, 210 }, { 523, 100, 150 }, { 523, 100, 150 } };
+byte startTuneNote = 0;
+unsigned long startTuneNext = 0;
+
 void BuzzerStart()
 {
-  tone( BUZZER, 262, 200);
-  delay(210);
-  tone( BUZZER, 523, 100);
-  delay(150);
-  tone( BUZZER, 523, 100);
-  delay(150);
-  noTone(BUZZER);
+  startTuneNote = 0;
+  startTuneNext = millis();
+  BuzzerStartUpdate();
 }
 
+// Plays the next note when it's due, tone() runs off a timer so this never waits
+// Returns false once the tune is done
+bool BuzzerStartUpdate()
+{
+  if ( (long)( millis() - startTuneNext ) < 0 )
+    return true;
 
-double ox , oy ;
+  if ( startTuneNote >= ELEMENTS( startTune ) )
+  {
+    noTone(BUZZER);
+    return false;
+  }
+
+  tone( BUZZER, startTune[startTuneNote][0], startTune[startTuneNote][1] );
+  startTuneNext += startTune[startTuneNote][2];
+  startTuneNote++;
+  return true;
+}
+
+
+// Draws the thick graph lines in runs instead of pixel by pixel
+GraphPlot plot;
 
 void DrawBaseGraph()
 {
-  oy = 220;
-  ox = 30;
   timeX = 0;
 
+#ifdef PLOT_TIMING
+  unsigned long legacyStart = micros();
+  int16_t lx = 30;
+  int16_t ly = 220;
   for ( int ii = 0; ii <= graphRangeMax_X; ii += 5 )
   {
-    GraphDefault(tft, ii, CurrentGraph().wantedCurve[ii], 30, 220, 270, 180, PINK );
+    int16_t x = plot.toX( ii );
+    int16_t y = plot.toY( wantedCurve.value( ii ) );
+    LegacyLine( tft, lx, ly, x, y, PINK );
+    lx = x;
+    ly = y;
   }
+  unsigned long legacyTime = micros() - legacyStart;
+  plot.resetStats();
+  unsigned long plotStart = micros();
+#endif
 
-  ox = 30;
-  oy = 220;
-  timeX = 0;
-}
-
-void BootScreen()
-{
-  tft.setRotation(1);
-  tft.fillScreen(BLACK);
-
-  tft.drawBitmap( 115, ( tft.height() / 2 ) +20 , UM_Logo, 90, 49, WHITE);
+  plot.moveTo( 30, 220 );
 
-  tft.setTextColor( GREEN, BLACK );
-  tft.setTextSize(3);
-  println_Center( tft, "REFLOW MASTER", tft.width() / 2, ( tft.height() / 2 ) - 38 );
+  for ( int ii = 0; ii <= graphRangeMax_X; ii += 5 )
+  {
+    GraphDefault( tft, ii, wantedCurve.value( ii ), PINK );
+  }
 
-  tft.setTextSize(2);
-  tft.setTextColor( WHITE, BLACK );
-  println_Center( tft, "unexpectedmaker.com", tft.width() / 2, ( tft.height() / 2 ) - 10 );
-  tft.setTextSize(1);
-  println_Center( tft, "Code v" + ver, tft.width() / 2, tft.height() - 20 );
+#ifdef PLOT_TIMING
+  unsigned long plotTime = micros() - plotStart;
+  TextBuffer timing;
+  timing.add( "Base graph drawLine " ).add( legacyTime ).add( "us " ).add( plot.getLegacyBytes() ).add( " bytes, runs " ).add( plotTime ).add( "us " ).add( plot.getBytes() ).add( " bytes" );
+  debug_println( timing.c_str() );
+#endif
 
-  state = MENU;
+  plot.moveTo( 30, 220 );
+  timeX = 0;
 }
 
 void ShowMenu()
 {
   state = MENU;
+  PROFILE_SCENARIO( "menu idle" );
 
   cachedCurrentTemp = 0;
 
   SetRelayFrequency( 0 );
+  safety.disarm();
 
-  set = flash_store.read();
+  // Fan off, unless it is being held on after a reflow or bake
+  KeepFanOnCheck();
 
-  tft.fillScreen(BLACK);
+  LoadSettings();
+
+  ClearScreen();
 
   tft.setTextColor( WHITE, BLACK );
   tft.setTextSize(2);
@@ -1147,6 +1774,13 @@ void ShowMenu()
   }
 
   tft.setTextSize(1);
+  if ( runHistory.hasRun() )
+  {
+    tft.setTextColor( GREY, BLACK );
+    tft.setCursor( 20, tft.height() - 35 );
+    tft.println( "Hold OVEN CHECK to review the last run" );
+  }
+
   tft.setTextColor( WHITE, BLACK );
   tft.setCursor( 20, tft.height() - 20 );
   tft.println("Reflow Master - Code v" + String(ver));
@@ -1154,18 +1788,25 @@ void ShowMenu()
   ShowMenuOptions( true );
 }
 
+// Y position of a line in the settings screens
+int SettingsPosY( int index )
+{
+  return 42 + ( 18 * index );
+}
+
 void ShowSettings()
 {
   state = SETTINGS;
+  PROFILE_SCENARIO( "settings" );
   SetRelayFrequency( 0 );
 
   newSettings = false;
 
-  int posY = 45;
-  int incY = 19;
+  int posY = SettingsPosY( 0 );
+  int incY = SettingsPosY( 1 ) - SettingsPosY( 0 );
 
   tft.setTextColor( BLUE, BLACK );
-  tft.fillScreen(BLACK);
+  ClearScreen();
 
   tft.setTextColor( BLUE, BLACK );
   tft.setTextSize(2);
@@ -1178,39 +1819,44 @@ void ShowSettings()
 
   posY += incY;
 
-  // y 64
+  // y 60
   UpdateSettingsFan( posY );
 
   posY += incY;
 
-  // y 83
+  // y 78
   UpdateSettingsFanTime( posY );
 
   posY += incY;
 
-  // y 102
+  // y 96
   UpdateSettingsLookAhead( posY );
 
   posY += incY;
 
-  // y 121
+  // y 114
   UpdateSettingsPower( posY );
 
   posY += incY;
 
-  // y 140
+  // y 132
   UpdateSettingsTempOffset( posY );
 
   posY += incY;
 
-  // y 159
+  // y 150
   UpdateSettingsStartFullBlast( posY );
 
   posY += incY;
 
-  // y 178
+  // y 168
   UpdateSettingsBakeTempGap( posY );
 
+  posY += incY;
+
+  // y 186
+  UpdateSettingsController( posY );
+
   posY += incY;
   tft.setTextColor( WHITE, BLACK );
   tft.setCursor( 20, posY );
@@ -1223,23 +1869,58 @@ void ShowSettings()
 
 void ShowPaste()
 {
+  PROFILE_SCOPE( "paste screen" );
   state = SETTINGS_PASTE;
+  PROFILE_SCENARIO( "profile switch" );
   SetRelayFrequency( 0 );
 
-  tft.fillScreen(BLACK);
+  ClearScreen();
 
   tft.setTextColor( BLUE, BLACK );
   tft.setTextSize(2);
   tft.setCursor( 20, 20 );
   tft.println( "SWITCH PASTE" );
 
-  tft.setTextColor( WHITE, BLACK );
+  // Only the page the pointer is on, stored profiles are read from flash as they are drawn
+  int first = settings_pointer / PASTE_PER_PAGE * PASTE_PER_PAGE;
+  int count = ProfileCount();
+
+  if ( count > PASTE_PER_PAGE )
+  {
+    tft.setTextColor( GREY, BLACK );
+    tft.setTextSize(1);
+    tft.setCursor( 200, 26 );
+    tft.println( String( first / PASTE_PER_PAGE + 1 ) + "/" + String( ( count + PASTE_PER_PAGE - 1 ) / PASTE_PER_PAGE ) );
+  }
 
   int y = 50;
 
-  for ( size_t i = 0; i < ELEMENTS(solderPaste); i++ )
+  for ( int i = first; i < first + PASTE_PER_PAGE && i < count; i++ )
   {
-    if ( i == set.paste )
+    int id = ProfileIdAt( i );
+    ProfileRecord record;
+    const char *name;
+    const char *type;
+    int tempDeg;
+
+    if ( id < PROFILE_STORED_ID )
+    {
+      name = solderPaste[id].n;
+      type = solderPaste[id].t;
+      tempDeg = solderPaste[id].tempDeg;
+    }
+    else if ( profileStore.read( id - PROFILE_STORED_ID, record ) )
+    {
+      name = record.name;
+      type = record.type;
+      tempDeg = record.liquidus;
+    }
+    else
+    {
+      continue;
+    }
+
+    if ( id == set.paste )
       tft.setTextColor( YELLOW, BLACK );
     else
       tft.setTextColor( WHITE, BLACK );
@@ -1247,10 +1928,10 @@ void ShowPaste()
     tft.setTextSize(2);
     tft.setCursor( 20, y );
 
-    tft.println( String( solderPaste[i].tempDeg) + "d " + solderPaste[i].n );
+    tft.println( String( tempDeg ) + "d " + name );
     tft.setTextSize(1);
     tft.setCursor( 20, y + 17 );
-    tft.println( solderPaste[i].t );
+    tft.println( type );
     tft.setTextColor( GREY, BLACK );
 
     y += 40;
@@ -1348,6 +2029,26 @@ void ShowMenuOptions( bool clearAll )
 
     UpdateSettingsPointer();
   }
+  else if ( state == SETTINGS_CONTROL )
+  {
+    // button 0
+    tft.fillRect( tft.width() - 5,  buttonPosY[0], buttonWidth, buttonHeight, GREEN );
+    println_Right( tft, "CHANGE", tft.width() - 27, buttonPosY[0] + 9 );
+
+    // button 1
+    tft.fillRect( tft.width() - 5,  buttonPosY[1], buttonWidth, buttonHeight, RED );
+    println_Right( tft, "BACK", tft.width() - 27, buttonPosY[1] + 9 );
+
+    // button 2
+    tft.fillRect( tft.width() - 5,  buttonPosY[2], buttonWidth, buttonHeight, BLUE );
+    println_Right( tft, "/\\", tft.width() - 27, buttonPosY[2] + 9 );
+
+    // button 3
+    tft.fillRect( tft.width() - 5,  buttonPosY[3], buttonWidth, buttonHeight, YELLOW );
+    println_Right( tft, "\\/", tft.width() - 27, buttonPosY[3] + 9 );
+
+    UpdateSettingsPointer();
+  }
   else if ( state == SETTINGS_RESET ) // restore settings to default
   {
     // button 0
@@ -1371,6 +2072,28 @@ void ShowMenuOptions( bool clearAll )
     // button 0
     tft.fillRect( tft.width() - 5,  buttonPosY[0], buttonWidth, buttonHeight, GREEN );
     println_Right( tft, "MENU", tft.width() - 27, buttonPosY[0] + 9 );
+
+    // button 1
+    tft.fillRect( tft.width() - 5,  buttonPosY[1], buttonWidth, buttonHeight, RED );
+    println_Right( tft, "REVIEW", tft.width() - 27, buttonPosY[1] + 9 );
+  }
+  else if ( state == REVIEW )
+  {
+    // button 0
+    tft.fillRect( tft.width() - 5,  buttonPosY[0], buttonWidth, buttonHeight, GREEN );
+    println_Right( tft, "MENU", tft.width() - 27, buttonPosY[0] + 9 );
+
+    // button 1
+    tft.fillRect( tft.width() - 5,  buttonPosY[1], buttonWidth, buttonHeight, RED );
+    println_Right( tft, "ZOOM", tft.width() - 27, buttonPosY[1] + 9 );
+
+    // button 2
+    tft.fillRect( tft.width() - 5,  buttonPosY[2], buttonWidth, buttonHeight, BLUE );
+    println_Right( tft, "<", tft.width() - 27, buttonPosY[2] + 9 );
+
+    // button 3
+    tft.fillRect( tft.width() - 5,  buttonPosY[3], buttonWidth, buttonHeight, YELLOW );
+    println_Right( tft, ">", tft.width() - 27, buttonPosY[3] + 9 );
   }
   else if ( state == OVENCHECK )
   {
@@ -1398,7 +2121,7 @@ void ShowBakeMenu()
 {
   state = BAKE_MENU;
 
-  tft.fillScreen(BLACK);
+  ClearScreen();
   tft.setTextColor( BLUE, BLACK );
   tft.setTextSize(3);
   tft.setCursor( 20, 20 );
@@ -1436,25 +2159,25 @@ void ShowBakeMenu()
   UpdateBakeMenu();
 }
 
+// Called every loop while baking, the labels only send what has changed since the last call
 void UpdateBake()
 {
-  tft.setTextColor( BLUE, BLACK );
-  tft.setTextSize(3);
-  tft.setCursor( 20, 20 );
+  PROFILE_SCOPE( "update bake" );
+  char buf[TFTWIDGET_MAX_CHARS + 1];
 
   switch (currentBakeTimeCounter)
   {
     case 0:
-      tft.println( "BAKING   " );
+      bakeTitleLabel.setText( "BAKING   " );
       break;
     case 3:
-      tft.println( "BAKING.  " );
+      bakeTitleLabel.setText( "BAKING.  " );
       break;
     case 6:
-      tft.println( "BAKING.. " );
+      bakeTitleLabel.setText( "BAKING.. " );
       break;
     case 9:
-      tft.println( "BAKING..." );
+      bakeTitleLabel.setText( "BAKING..." );
       break;
     default:
       // do nothing
@@ -1465,12 +2188,15 @@ void UpdateBake()
   if (currentBakeTimeCounter == 12)
     currentBakeTimeCounter = 0;
 
-  tft.setTextColor( YELLOW, BLACK );
-  tft.setTextSize(5);
-  tft.setCursor( 20, 82 );
-  tft.println(String(round(currentTemp * 10) / 10) + "/" + String(round(set.bakeTemp)) + "c");
-  tft.setCursor( 20, 157 );
-  tft.println(String(round(currentBakeTime / 60 + 0.5)) + "/" + String(set.bakeTime / 60) + "min ");
+  bakeTitleLabel.draw( tft );
+
+  // The temp to 1/10 C
+  TextBuffer temp;
+  temp.addFixed( (long)round( currentTemp * 10 ), 1 ).add( "/" ).add( (long)round( set.bakeTemp ) ).add( "c" );
+  bakeTempLabel.print( tft, temp.c_str() );
+
+  snprintf( buf, sizeof( buf ), "%ld/%ldmin ", (long)round( currentBakeTime / 60 + 0.5 ), set.bakeTime / 60 );
+  bakeTimeLabel.print( tft, buf );
 
   if ( round( currentTemp ) > round( cachedCurrentTemp ) )
     lastTempDirection = 1;
@@ -1482,10 +2208,14 @@ void UpdateBake()
 
 void StartBake()
 {
+  PROFILE_SCENARIO( "bake" );
   currentBakeTime = set.bakeTime;
   currentBakeTimeCounter = 0;
+  runRecorder.begin( RUN_BAKE, 0 );
+  runHistory.begin( RUN_BAKE, 0 );
+  safety.arm( probes.control );
 
-  tft.fillScreen(BLACK);
+  ClearScreen();
 
   //  tft.setTextColor( BLUE, BLACK );
   //  tft.setTextSize(3);
@@ -1500,8 +2230,8 @@ void StartBake()
   tft.println( "TIME LEFT");
 
   // button 0
-  tft.fillRect( tft.width() - 5,  buttonPosY[0], buttonWidth, buttonHeight, GREEN );
-  println_Right( tft, "ABORT", tft.width() - 27, buttonPosY[0] + 9 );
+  bakeHint.set( "ABORT", GREEN );
+  bakeHint.draw( tft );
 
   UpdateBake();
 }
@@ -1511,12 +2241,14 @@ void BakeDone()
   state = BAKE_DONE;
   
   SetRelayFrequency(0); // Turn the SSR off immediately
+  runRecorder.end( RUN_COMPLETE );
+  safety.disarm();
 
   Buzzer( 2000, 500 );
 
   if ( set.useFan && set.fanTimeAfterReflow > 0 )
   {
-    keepFanOnTime = millis() + set.fanTimeAfterReflow * 1000;
+    HoldFanOn();
     StartFan( true );
   }
   else
@@ -1524,7 +2256,13 @@ void BakeDone()
     StartFan( false );
   }
 
-  tft.fillScreen(BLACK);
+  scheduler.start( beepTask, 750 );
+  screenChange = DrawBakeDone;
+}
+
+void DrawBakeDone()
+{
+  ClearScreen();
 
   tft.setTextColor( BLUE, BLACK );
   tft.setTextSize(3);
@@ -1537,9 +2275,9 @@ void BakeDone()
   tft.fillRect( tft.width() - 5,  buttonPosY[0], buttonWidth, buttonHeight, GREEN );
   println_Right( tft, "MENU", tft.width() - 27, buttonPosY[0] + 9 );
 
-  delay(750);
-  Buzzer( 2000, 500 );
-
+  // button 1
+  tft.fillRect( tft.width() - 5,  buttonPosY[1], buttonWidth, buttonHeight, RED );
+  println_Right( tft, "REVIEW", tft.width() - 27, buttonPosY[1] + 9 );
 }
 
 void UpdateSettingsPointer()
@@ -1549,7 +2287,7 @@ void UpdateSettingsPointer()
     tft.setTextColor( BLUE, BLACK );
     tft.setTextSize(2);
     tft.fillRect( 0, 20, 20, tft.height() - 20, BLACK );
-    tft.setCursor( 5, ( 45 + ( 19 * settings_pointer ) ) );
+    tft.setCursor( 5, SettingsPosY( settings_pointer ) );
     tft.println(">");
 
     tft.setTextSize(1);
@@ -1592,6 +2330,10 @@ void UpdateSettingsPointer()
         break;
 
       case 8:
+        println_Center( tft, "Pick the reflow controller and tune the PID", tft.width() / 2, testPosY );
+        break;
+
+      case 9:
         println_Center( tft, "Reset to default settings", tft.width() / 2, testPosY );
         break;
 
@@ -1606,21 +2348,82 @@ void UpdateSettingsPointer()
     tft.setTextColor( BLUE, BLACK );
     tft.setTextSize(2);
     tft.fillRect( 0, 20, 20, tft.height() - 20, BLACK );
-    tft.setCursor( 5, ( 50 + ( 20 * ( settings_pointer * 2 ) ) ) );
+    tft.setCursor( 5, ( 50 + ( 20 * ( ( settings_pointer % PASTE_PER_PAGE ) * 2 ) ) ) );
+    tft.println(">");
+  }
+  else if ( state == SETTINGS_CONTROL )
+  {
+    tft.setTextColor( BLUE, BLACK );
+    tft.setTextSize(2);
+    tft.fillRect( 0, 20, 20, tft.height() - 20, BLACK );
+    tft.setCursor( 5, SettingsPosY( settings_pointer ) );
     tft.println(">");
+
+    tft.setTextSize(1);
+    tft.setTextColor( GREEN, BLACK );
+    tft.fillRect( 0, tft.height() - 20, tft.width(), 20, BLACK );
+
+    int testPosY = tft.height() - 16;
+    switch ( settings_pointer )
+    {
+      case 0:
+        println_Center( tft, "Original rate matching or PID with feedforward", tft.width() / 2, testPosY );
+        break;
+
+      case 1:
+        println_Center( tft, "How often the PID updates the oven, per second", tft.width() / 2, testPosY );
+        break;
+
+      case 2:
+        println_Center( tft, "Duty per degree of error, higher reacts harder", tft.width() / 2, testPosY );
+        break;
+
+      case 3:
+        println_Center( tft, "Removes steady error, too high overshoots", tft.width() / 2, testPosY );
+        break;
+
+      case 4:
+        println_Center( tft, "Damps fast temp changes, higher for heavy ovens", tft.width() / 2, testPosY );
+        break;
+
+      case 5:
+        println_Center( tft, "Duty per degree/sec of profile ramp", tft.width() / 2, testPosY );
+        break;
+
+      case 6:
+        println_Center( tft, "Auto uses the oven model from Oven Check", tft.width() / 2, testPosY );
+        break;
+    }
+    tft.setTextSize(2);
   }
 }
 
 void StartWarmup()
 {
-  tft.fillScreen(BLACK);
+  // Start can be pressed before boot has got to it
+  // Without the wanted curve there is nothing to follow, so don't start at all
+  if ( !wantedCurveBuilt && !BuildWantedCurve() )
+  {
+    Buzzer( 100, 250 );
+    tft.setTextColor( RED, BLACK );
+    tft.setTextSize(1);
+    tft.setCursor( 20, 85 );
+    tft.println( "Not enough RAM for this profile" );
+    return;
+  }
+
+  ClearScreen();
 
   state = WARMUP;
+  PROFILE_SCENARIO( "warmup" );
   timeX = 0;
+  runRecorder.begin( RUN_REFLOW, set.paste );
+  safety.arm( probes.control );
   ShowMenuOptions( true );
-  lastWantedTemp = -1;
+  ResetController();
   buzzerCount = 5;
-  keepFanOnTime = 0;
+  keepFanOnTime = millis();
+  scheduler.stop( fanTask );
   StartFan( false );
 
   tft.setTextColor( BLUE, BLACK );
@@ -1633,17 +2436,27 @@ void StartWarmup()
   println_Center( tft, "WARMING UP", tft.width() / 2, ( tft.height() / 2 ) - 30 );
 
   tft.setTextColor( WHITE, BLACK );
-  println_Center( tft, "START @ " + String( GetGraphValue(0) ) + "c", tft.width() / 2, ( tft.height() / 2 ) + 50 );
+  TextBuffer start;
+  start.add( "START @ " ).add( GetGraphValue(0) ).add( "c" );
+  println_Center( tft, start.c_str(), tft.width() / 2, ( tft.height() / 2 ) + 50 );
 }
 
 void StartReflow()
 {
-  tft.fillScreen(BLACK);
-
   state = REFLOW;
-  ShowMenuOptions( true );
+  PROFILE_SCENARIO( "reflow" );
 
   timeX = 0;
+  runHistory.begin( RUN_REFLOW, set.paste );
+  headingPending = NULL;
+  screenChange = DrawReflow;
+}
+
+void DrawReflow()
+{
+  ClearScreen();
+  ShowMenuOptions( true );
+
   SetupGraph(tft, 0, 0, 30, 220, 270, 180, graphRangeMin_X, graphRangeMax_X, graphRangeStep_X, graphRangeMin_Y, graphRangeMax_Y, graphRangeStep_Y, "Reflow Temp", " Time [s]", "deg [C]", DKBLUE, BLUE, WHITE, BLACK );
 
   DrawHeading( "READY", WHITE, BLACK );
@@ -1658,55 +2471,98 @@ void AbortReflow()
     state = ABORT;
 
     SetRelayFrequency(0); // Turn the SSR off immediately
-
-    tft.fillScreen(BLACK);
-    tft.setTextColor( RED, BLACK );
-    tft.setTextSize(6);
-    println_Center( tft, "ABORT", tft.width() / 2, ( tft.height() / 2 ) );
+    runRecorder.end( RUN_ABORTED );
+    safety.disarm();
 
     if ( set.useFan && set.fanTimeAfterReflow > 0 )
     {
-      keepFanOnTime = millis() + set.fanTimeAfterReflow * 1000;
+      HoldFanOn();
     }
     else
     {
       StartFan( false );
     }
 
-    delay(1000);
+    // Show it for a second, then back to the menu, without holding up the sampler
+    screenChange = DrawAbort;
+    scheduler.start( menuTask, 1000 );
+  }
+}
+
+void DrawAbort()
+{
+  ClearScreen();
+  tft.setTextColor( RED, BLACK );
+  tft.setTextSize(6);
+  println_Center( tft, "ABORT", tft.width() / 2, ( tft.height() / 2 ) );
 
-    state = MENU;
-    ShowMenu();
+  // Say why when it wasn't the button
+  if ( safety.isTripped() )
+  {
+    tft.setTextSize(3);
+    println_Center( tft, SafetySupervisor::tripName( safety.getTrip() ), tft.width() / 2, ( tft.height() / 2 ) + 50 );
+#ifdef DEBUG
+    safety.print( Serial );
+#endif
   }
 }
 
+// One shot, a second after an abort
+void AbortDone()
+{
+  if ( state == ABORT )
+    ShowMenu();
+}
+
 void EndReflow()
 {
   if ( state == REFLOW )
   {
     SetRelayFrequency( 0 );
     state = FINISHED;
+    runRecorder.end( RUN_COMPLETE );
+    safety.disarm();
 
     Buzzer( 2000, 500 );
+    scheduler.start( beepTask, 750 );
 
-    DrawHeading( "DONE!", WHITE, BLACK );
-
-    ShowMenuOptions( false );
+    screenChange = DrawDone;
 
     if ( set.useFan && set.fanTimeAfterReflow > 0 )
     {
-      keepFanOnTime = millis() + set.fanTimeAfterReflow * 1000;
+      HoldFanOn();
     }
     else
     {
       StartFan( false );
     }
-
-    delay(750);
-    Buzzer( 2000, 500 );
   }
 }
 
+void DrawDone()
+{
+  DrawHeading( "DONE!", WHITE, BLACK );
+  ShowMenuOptions( false );
+}
+
+// One shot, the second beep at the end of a reflow or bake
+void DoneBeep()
+{
+  Buzzer( 2000, 500 );
+}
+
+void ShortBeep()
+{
+  Buzzer( 2000, 10 );
+}
+
+// Two short beeps, the second from a task so the buttons don't hold up the scheduler
+void DoubleBeep()
+{
+  ShortBeep();
+  scheduler.start( secondBeepTask, 60 );
+}
+
 void SetDefaults()
 {
   // Default settings values
@@ -1723,13 +2579,31 @@ void SetDefaults()
   set.bakeTime = 1200;
   set.bakeTemp = 45;
   set.bakeTempGap = 3;
+  set.controller = CONTROLLER_HEURISTIC;
+  set.controlRate = 1;
+  set.pidKp = PID_DEFAULT_KP;
+  set.pidKi = PID_DEFAULT_KI;
+  set.pidKd = PID_DEFAULT_KD;
+  set.pidKff = PID_DEFAULT_KFF;
+  set.autoTune = false;
+  set.model = OvenModel();
+}
+
+bool LoadSettings()
+{
+  return settingsStore.read( STORE_SETTINGS, &set, sizeof( set ) );
+}
+
+bool SaveSettings()
+{
+  return settingsStore.write( STORE_SETTINGS, &set, sizeof( set ) );
 }
 
 void ResetSettingsToDefault()
 {
   // set default values again and save
   SetDefaults();
-  flash_store.write(set);
+  SaveSettings();
 
   // load the default paste
   SetCurrentGraph( set.paste );
@@ -1746,9 +2620,11 @@ void ResetSettingsToDefault()
 */
 void StartOvenCheck()
 {
-  debug_println("Oven Check Start Temp " + String( currentTemp ) );
+  TextBuffer check;
+  debug_println( check.add( "Oven Check Start Temp " ).add( currentTemp ).c_str() );
 
   state = OVENCHECK_START;
+  PROFILE_SCENARIO( "oven check" );
   calibrationSeconds = 0;
   calibrationState = 0;
   calibrationStatsUp = 0;
@@ -1757,12 +2633,15 @@ void StartOvenCheck()
   calibrationDownMatch = false;
   calibrationDropVal = 0;
   calibrationRiseVal = 0;
+  calibrationStepTime = 0;
   SetRelayFrequency( 0 );
+  runRecorder.begin( RUN_OVENCHECK, 0 );
+  safety.arm( probes.control );
   StartFan( false );
 
   debug_println("Running Oven Check");
 
-  tft.fillScreen(BLACK);
+  ClearScreen();
   tft.setTextColor( CYAN, BLACK );
   tft.setTextSize(2);
   tft.setCursor( 20, 20 );
@@ -1785,7 +2664,7 @@ void ShowOvenCheck()
   
   debug_println("Oven Check");
 
-  tft.fillScreen(BLACK);
+  ClearScreen();
   tft.setTextColor( CYAN, BLACK );
   tft.setTextSize(2);
   tft.setCursor( 20, 20 );
@@ -1826,7 +2705,7 @@ void ShowOvenCheck()
 
 void ShowResetDefaults()
 {
-  tft.fillScreen(BLACK);
+  ClearScreen();
   tft.setTextColor( WHITE, BLACK );
   tft.setTextSize(2);
   tft.setCursor( 20, 90 );
@@ -1930,22 +2809,163 @@ void UpdateSettingsBakeTempGap( int posY )
   tft.fillRect( 15,  posY - 5, 260, 20, BLACK );
   tft.setTextColor( WHITE, BLACK );
 
-  tft.setCursor( 20, posY );
-  tft.print( "BAKE TEMP GAP ");
-  tft.setTextColor( YELLOW, BLACK );
-  tft.println( String( set.bakeTempGap ) );
-  tft.setTextColor( WHITE, BLACK );
-}
+  tft.setCursor( 20, posY );
+  tft.print( "BAKE TEMP GAP ");
+  tft.setTextColor( YELLOW, BLACK );
+  tft.println( String( set.bakeTempGap ) );
+  tft.setTextColor( WHITE, BLACK );
+}
+
+void UpdateSettingsTempOffset( int posY )
+{
+  tft.fillRect( 15,  posY - 5, 220, 20, BLACK );
+  tft.setTextColor( WHITE, BLACK );
+
+  tft.setCursor( 20, posY );
+  tft.print( "TEMP OFFSET ");
+  tft.setTextColor( YELLOW, BLACK );
+  tft.println( String( set.tempOffset) );
+  tft.setTextColor( WHITE, BLACK );
+}
+
+void UpdateSettingsController( int posY )
+{
+  tft.fillRect( 15,  posY - 5, 260, 20, BLACK );
+  tft.setTextColor( WHITE, BLACK );
+
+  tft.setCursor( 20, posY );
+  tft.print( "CONTROLLER ");
+  tft.setTextColor( YELLOW, BLACK );
+
+  if ( set.controller == CONTROLLER_PID )
+    tft.println( "PID" );
+  else
+    tft.println( "HEURISTIC" );
+
+  tft.setTextColor( WHITE, BLACK );
+}
+
+void ShowControlSettings()
+{
+  state = SETTINGS_CONTROL;
+  SetRelayFrequency( 0 );
+
+  ClearScreen();
+
+  tft.setTextColor( BLUE, BLACK );
+  tft.setTextSize(2);
+  tft.setCursor( 20, 20 );
+  tft.println( "CONTROLLER" );
+
+  for ( int i = 0; i < 7; i++ )
+    UpdateControlSetting( i );
+
+  ShowMenuOptions( true );
+}
+
+// Step a controller setting to its next value, wrapping back to the start
+void ChangeControlSetting( int index )
+{
+  switch ( index )
+  {
+    case 0:
+      set.controller = ( set.controller == CONTROLLER_PID ) ? CONTROLLER_HEURISTIC : CONTROLLER_PID;
+      break;
+
+    case 1:
+      set.controlRate += 1;
+      if ( set.controlRate > CONTROL_RATE_MAX )
+        set.controlRate = 1;
+      break;
+
+    case 2:
+      set.pidKp += 2;
+      if ( set.pidKp > 60 )
+        set.pidKp = 0;
+      break;
+
+    case 3:
+      set.pidKi += 0.05;
+      if ( set.pidKi > 1.01 )
+        set.pidKi = 0;
+      break;
+
+    case 4:
+      set.pidKd += 5;
+      if ( set.pidKd > 100 )
+        set.pidKd = 0;
+      break;
+
+    case 5:
+      set.pidKff += 10;
+      if ( set.pidKff > 400 )
+        set.pidKff = 0;
+      break;
+
+    case 6:
+      set.autoTune = !set.autoTune;
+      break;
+  }
+}
+
+void UpdateControlSetting( int index )
+{
+  int posY = SettingsPosY( index );
+
+  tft.fillRect( 15,  posY - 5, 220, 20, BLACK );
+  tft.setTextColor( WHITE, BLACK );
+  tft.setCursor( 20, posY );
+
+  switch ( index )
+  {
+    case 0:
+      tft.print( "TYPE " );
+      tft.setTextColor( YELLOW, BLACK );
+      tft.println( ( set.controller == CONTROLLER_PID ) ? "PID" : "HEURISTIC" );
+      break;
+
+    case 1:
+      tft.print( "RATE " );
+      tft.setTextColor( YELLOW, BLACK );
+      tft.println( String( set.controlRate ) + "Hz" );
+      break;
+
+    case 2:
+      tft.print( "KP " );
+      tft.setTextColor( YELLOW, BLACK );
+      tft.println( String( set.pidKp, 0 ) );
+      break;
+
+    case 3:
+      tft.print( "KI " );
+      tft.setTextColor( YELLOW, BLACK );
+      tft.println( String( set.pidKi, 2 ) );
+      break;
+
+    case 4:
+      tft.print( "KD " );
+      tft.setTextColor( YELLOW, BLACK );
+      tft.println( String( set.pidKd, 0 ) );
+      break;
+
+    case 5:
+      tft.print( "FEEDFORWARD " );
+      tft.setTextColor( YELLOW, BLACK );
+      tft.println( String( set.pidKff, 0 ) );
+      break;
 
-void UpdateSettingsTempOffset( int posY )
-{
-  tft.fillRect( 15,  posY - 5, 220, 20, BLACK );
-  tft.setTextColor( WHITE, BLACK );
+    case 6:
+      tft.print( "TUNING " );
+      tft.setTextColor( YELLOW, BLACK );
+      if ( !set.autoTune )
+        tft.println( "MANUAL" );
+      else if ( set.model.valid )
+        tft.println( "AUTO" );
+      else
+        tft.println( "AUTO (NO MODEL)" );
+      break;
+  }
 
-  tft.setCursor( 20, posY );
-  tft.print( "TEMP OFFSET ");
-  tft.setTextColor( YELLOW, BLACK );
-  tft.println( String( set.tempOffset) );
   tft.setTextColor( WHITE, BLACK );
 }
 
@@ -1957,7 +2977,7 @@ unsigned long nextButtonPress = 0;
 
 void button0Press()
 {
-  if ( nextButtonPress < millis() )
+  if ( CoopScheduler::reached( millis(), nextButtonPress ) )
   {
     nextButtonPress = millis() + 20;
     Buzzer( 2000, 50 );
@@ -1972,7 +2992,7 @@ void button0Press()
     }
     else if ( state == BAKE_MENU )
     {
-      flash_store.write(set);
+      SaveSettings();
       state = BAKE;
       StartBake();
     }
@@ -1980,7 +3000,7 @@ void button0Press()
     {
       AbortReflow();
     }
-    else if ( state == FINISHED || state == BAKE_DONE )
+    else if ( state == FINISHED || state == BAKE_DONE || state == REVIEW )
     {
       ShowMenu();
     }
@@ -1988,14 +3008,14 @@ void button0Press()
     {
       if ( settings_pointer == 0 )  // change paste
       {
-        settings_pointer = set.paste;
+        settings_pointer = ProfilePosition( set.paste );
         ShowPaste();
       }
       else if ( settings_pointer == 1 )  // switch fan use
       {
         set.useFan = !set.useFan;
 
-        UpdateSettingsFan( 64 );
+        UpdateSettingsFan( SettingsPosY( 1 ) );
       }
       else if ( settings_pointer == 2 ) // fan countdown after reflow
       {
@@ -2003,7 +3023,7 @@ void button0Press()
         if ( set.fanTimeAfterReflow > 60 )
           set.fanTimeAfterReflow = 0;
 
-        UpdateSettingsFanTime( 83 );
+        UpdateSettingsFanTime( SettingsPosY( 2 ) );
       }
       else if ( settings_pointer == 3 ) // change lookahead for reflow
       {
@@ -2011,7 +3031,7 @@ void button0Press()
         if ( set.lookAhead > 15 )
           set.lookAhead = 1;
 
-        UpdateSettingsLookAhead( 102 );
+        UpdateSettingsLookAhead( SettingsPosY( 3 ) );
       }
       else if ( settings_pointer == 4 ) // change power
       {
@@ -2019,7 +3039,7 @@ void button0Press()
         if ( set.power > 1.55 )
           set.power = 0.5;
 
-        UpdateSettingsPower( 121 );
+        UpdateSettingsPower( SettingsPosY( 4 ) );
       }
       else if ( settings_pointer == 5 ) // change temp probe offset
       {
@@ -2027,13 +3047,13 @@ void button0Press()
         if ( set.tempOffset > 15 )
           set.tempOffset = -15;
 
-        UpdateSettingsTempOffset( 140 );
+        UpdateSettingsTempOffset( SettingsPosY( 5 ) );
       }
       else if ( settings_pointer == 6 ) // change use full power on initial ramp
       {
         set.startFullBlast = !set.startFullBlast;
 
-        UpdateSettingsStartFullBlast( 159 );
+        UpdateSettingsStartFullBlast( SettingsPosY( 6 ) );
       }
       else if ( settings_pointer == 7 ) // bake temp gap
       {
@@ -2041,22 +3061,32 @@ void button0Press()
         if ( set.bakeTempGap > 5 )
           set.bakeTempGap = 0;
 
-        UpdateSettingsBakeTempGap( 178 );
+        UpdateSettingsBakeTempGap( SettingsPosY( 7 ) );
+      }
+      else if ( settings_pointer == 8 ) // controller and PID tuning
+      {
+        settings_pointer = 0;
+        ShowControlSettings();
       }
-      else if ( settings_pointer == 8 ) // reset defaults
+      else if ( settings_pointer == 9 ) // reset defaults
       {
         ShowResetDefaults();
       }
     }
     else if ( state == SETTINGS_PASTE )
     {
-      if ( set.paste != settings_pointer )
+      if ( set.paste != ProfileIdAt( settings_pointer ) )
       {
-        set.paste = settings_pointer;
+        set.paste = ProfileIdAt( settings_pointer );
         SetCurrentGraph( set.paste );
         ShowPaste();
       }
     }
+    else if ( state == SETTINGS_CONTROL )
+    {
+      ChangeControlSetting( settings_pointer );
+      UpdateControlSetting( settings_pointer );
+    }
     else if ( state == SETTINGS_RESET )
     {
       ResetSettingsToDefault();
@@ -2070,7 +3100,7 @@ void button0Press()
 
 void button1Press()
 {
-  if ( nextButtonPress < millis() )
+  if ( CoopScheduler::reached( millis(), nextButtonPress ) )
   {
     nextButtonPress = millis() + 20;
     Buzzer( 2000, 50 );
@@ -2086,7 +3116,7 @@ void button1Press()
     else if ( state == SETTINGS ) // leaving settings so save
     {
       // save data in flash
-      flash_store.write(set);
+      SaveSettings();
       ShowMenu();
     }
     else if ( state == SETTINGS_PASTE || state == SETTINGS_RESET )
@@ -2094,21 +3124,34 @@ void button1Press()
       settings_pointer = 0;
       ShowSettings();
     }
+    else if ( state == SETTINGS_CONTROL )
+    {
+      settings_pointer = 8;
+      ShowSettings();
+    }
     else if ( state == OVENCHECK ) // cancel oven check
     {
       ShowMenu();
     }
     else if ( state == BAKE_MENU) // cancel oven check
     {
-      flash_store.write(set);
+      SaveSettings();
       ShowMenu();
     }
+    else if ( state == FINISHED || state == BAKE_DONE )
+    {
+      ShowReview();
+    }
+    else if ( state == REVIEW )
+    {
+      ZoomReview();
+    }
   }
 }
 
 void button2Press()
 {
-  if ( nextButtonPress < millis() )
+  if ( CoopScheduler::reached( millis(), nextButtonPress ) )
   {
     nextButtonPress = millis() + 20;
     Buzzer( 2000, 50 );
@@ -2118,6 +3161,10 @@ void button2Press()
       settings_pointer = 0;
       ShowSettings();
     }
+    else if ( state == REVIEW )
+    {
+      PanReview( -1 );
+    }
     else if ( state == BAKE_MENU )
     {
       set.bakeTemp += 1;
@@ -2128,22 +3175,32 @@ void button2Press()
     }
     else if ( state == SETTINGS )
     {
-      settings_pointer = constrain( settings_pointer - 1, 0, 8 );
+      settings_pointer = constrain( settings_pointer - 1, 0, 9 );
       ShowMenuOptions( false );
       //UpdateSettingsPointer();
     }
-    else if ( state == SETTINGS_PASTE )
+    else if ( state == SETTINGS_CONTROL )
     {
-      settings_pointer = constrain( settings_pointer - 1, 0, (int) ELEMENTS(solderPaste) - 1 );
+      settings_pointer = constrain( settings_pointer - 1, 0, 6 );
       UpdateSettingsPointer();
     }
+    else if ( state == SETTINGS_PASTE )
+    {
+      int page = settings_pointer / PASTE_PER_PAGE;
+      settings_pointer = constrain( settings_pointer - 1, 0, ProfileCount() - 1 );
+
+      if ( settings_pointer / PASTE_PER_PAGE != page )
+        ShowPaste();
+      else
+        UpdateSettingsPointer();
+    }
   }
 }
 
 
 void button3Press()
 {
-  if ( nextButtonPress < millis() )
+  if ( CoopScheduler::reached( millis(), nextButtonPress ) )
   {
     nextButtonPress = millis() + 20;
     Buzzer( 2000, 50 );
@@ -2156,6 +3213,10 @@ void button3Press()
       else
         Buzzer( 100, 250 );
     }
+    else if ( state == REVIEW )
+    {
+      PanReview( 1 );
+    }
     else if ( state == BAKE_MENU )
     {
       set.bakeTime += 300;
@@ -2166,27 +3227,35 @@ void button3Press()
     }
     else if ( state == SETTINGS )
     {
-      settings_pointer = constrain( settings_pointer + 1, 0, 8 );
+      settings_pointer = constrain( settings_pointer + 1, 0, 9 );
       ShowMenuOptions( false );
       //UpdateSettingsPointer();
     }
-    else if ( state == SETTINGS_PASTE )
+    else if ( state == SETTINGS_CONTROL )
     {
-      settings_pointer = constrain( settings_pointer + 1, 0, (int) ELEMENTS(solderPaste) - 1 );
+      settings_pointer = constrain( settings_pointer + 1, 0, 6 );
       UpdateSettingsPointer();
     }
+    else if ( state == SETTINGS_PASTE )
+    {
+      int page = settings_pointer / PASTE_PER_PAGE;
+      settings_pointer = constrain( settings_pointer + 1, 0, ProfileCount() - 1 );
+
+      if ( settings_pointer / PASTE_PER_PAGE != page )
+        ShowPaste();
+      else
+        UpdateSettingsPointer();
+    }
   }
 }
 
 
 void button2LongPressStart()
 {
-  if ( nextButtonPress < millis() )
+  if ( CoopScheduler::reached( millis(), nextButtonPress ) )
   {
     nextButtonPress = millis() + 10;
-    Buzzer( 2000, 10 );
-    delay(50);
-    Buzzer( 2000, 10 );
+    DoubleBeep();
   }
 }
 
@@ -2194,7 +3263,7 @@ void button2LongPress()
 {
   if ( state == BAKE_MENU )
   {
-    if ( nextButtonPress < millis() )
+    if ( CoopScheduler::reached( millis(), nextButtonPress ) )
     {
       nextButtonPress = millis() +10;
 
@@ -2210,12 +3279,14 @@ void button2LongPress()
 
 void button3LongPressStart()
 {
-  if ( nextButtonPress < millis() )
+  if ( CoopScheduler::reached( millis(), nextButtonPress ) )
   {
     nextButtonPress = millis() + 20;
-    Buzzer( 2000, 10 );
-    delay(50);
-    Buzzer( 2000, 10 );
+    DoubleBeep();
+
+    // Holding OVEN CHECK brings the last run back up
+    if ( state == MENU && runHistory.hasRun() )
+      ShowReview();
   }
 }
 
@@ -2223,7 +3294,7 @@ void button3LongPress()
 {
   if ( state == BAKE_MENU )
   {
-    if ( nextButtonPress < millis() )
+    if ( CoopScheduler::reached( millis(), nextButtonPress ) )
     {
       nextButtonPress = millis() + 20;
 
@@ -2236,19 +3307,42 @@ void button3LongPress()
   }
 }
 
+// What each button does, the long presses change the bake time and temp values
+void HandleButton( const ButtonEvent &event )
+{
+  static const ButtonHandler clicks[] = { button0Press, button1Press, button2Press, button3Press };
+  static const ButtonHandler longStarts[] = { NULL, NULL, button2LongPressStart, button3LongPressStart };
+  static const ButtonHandler repeats[] = { NULL, NULL, button2LongPress, button3LongPress };
+
+  if ( event.button >= ELEMENTS( clicks ) )
+    return;
+
+  ButtonHandler handler = NULL;
+  if ( event.type == BUTTON_CLICK )
+    handler = clicks[event.button];
+  else if ( event.type == BUTTON_LONG_START )
+    handler = longStarts[event.button];
+  else if ( event.type == BUTTON_REPEAT )
+    handler = repeats[event.button];
+
+  if ( handler != NULL )
+    handler();
+}
+
 /*
    Graph drawing code here
    Special thanks to Kris Kasprzak for his free graphing code that I derived mine from
    https://www.youtube.com/watch?v=YejRbIKe6e0
 */
 
-void SetupGraph(Adafruit_ILI9341 &d, double x, double y, double gx, double gy, double w, double h, double xlo, double xhi, double xinc, double ylo, double yhi, double yinc, String title, String xlabel, String ylabel, unsigned int gcolor, unsigned int acolor, unsigned int tcolor, unsigned int bcolor )
+void SetupGraph(Adafruit_ILI9341 &d, double x, double y, double gx, double gy, double w, double h, double xlo, double xhi, double xinc, double ylo, double yhi, double yinc, const char *title, const char *xlabel, const char *ylabel, unsigned int gcolor, unsigned int acolor, unsigned int tcolor, unsigned int bcolor )
 {
   double i;
   int temp;
 
-  ox = (x - xlo) * ( w) / (xhi - xlo) + gx;
-  oy = (y - ylo) * (gy - h - gy) / (yhi - ylo) + gy;
+  plot.setArea( gx, gy, w, h );
+  plot.setRange( xlo, xhi, ylo, yhi );
+  plot.moveTo( plot.toX( x ), plot.toY( y ) );
   // draw y scale
   for ( i = ylo; i <= yhi; i += yinc)
   {
@@ -2265,7 +3359,8 @@ void SetupGraph(Adafruit_ILI9341 &d, double x, double y, double gx, double gy, d
     d.setTextSize(1);
     d.setTextColor(tcolor, bcolor);
     d.setCursor(gx - 25, temp);
-    println_Right( d, String(round(i)), gx - 25, temp );
+    TextBuffer label;
+    println_Right( d, label.add( (long)round(i) ).c_str(), gx - 25, temp );
   }
 
   // draw x scale
@@ -2285,10 +3380,11 @@ void SetupGraph(Adafruit_ILI9341 &d, double x, double y, double gx, double gy, d
     d.setTextColor(tcolor, bcolor);
     d.setCursor(temp, gy + 10);
 
+    TextBuffer label;
     if ( i <= xhi - xinc )
-      println_Center(d, String(round(i)), temp, gy + 10 );
+      println_Center(d, label.add( (long)round(i) ).c_str(), temp, gy + 10 );
     else
-      println_Center(d, String(round(xhi)), temp, gy + 10 );
+      println_Center(d, label.add( (long)round(xhi) ).c_str(), temp, gy + 10 );
   }
 
   //now draw the labels
@@ -2310,69 +3406,521 @@ void SetupGraph(Adafruit_ILI9341 &d, double x, double y, double gx, double gy, d
   tft.setRotation(1);
 }
 
-void Graph(Adafruit_ILI9341 &d, double x, double y, double gx, double gy, double w, double h )
+// Plot the next live temperature sample, the graph area and ranges come from SetupGraph()
+void Graph( Adafruit_ILI9341 &d, float x, float y )
 {
-  // recall that ox and oy are initialized as static above
-  x =  (x - graphRangeMin_X) * ( w) / (graphRangeMax_X - graphRangeMin_X) + gx;
-  y =  (y - graphRangeMin_Y) * (gy - h - gy) / (graphRangeMax_Y - graphRangeMin_Y) + gy;
+  PROFILE_SCOPE( "graph" );
+  int16_t px = plot.toX( x );
+  int16_t py = plot.toY( y );
 
   if ( timeX < 2 )
-    oy = min( oy, y );
+    plot.moveTo( plot.getPenX(), min( plot.getPenY(), py ) );
+
+  py = min( py, (int16_t)220 ); // bottom of graph!
+
+#ifdef PLOT_TIMING
+  unsigned long legacyStart = micros();
+  LegacyLine( d, plot.getPenX(), plot.getPenY(), px, py, currentPlotColor );
+  unsigned long legacyTime = micros() - legacyStart;
+  unsigned long legacyBytes = plot.getLegacyBytes();
+  unsigned long bytes = plot.getBytes();
+  unsigned long plotStart = micros();
+#endif
+
+  plot.lineTo( d, px, py, currentPlotColor );
 
-  y = min( y, 220 ); // bottom of graph!
+#ifdef PLOT_TIMING
+  unsigned long plotTime = micros() - plotStart;
+  TextBuffer timing;
+  timing.add( "Sample drawLine " ).add( legacyTime ).add( "us " ).add( plot.getLegacyBytes() - legacyBytes ).add( " bytes, runs " ).add( plotTime ).add( "us " ).add( plot.getBytes() - bytes ).add( " bytes" );
+  debug_println( timing.c_str() );
+#endif
+}
+
+// The probes that aren't being controlled on, as a dotted trace each
+void GraphProbes( Adafruit_ILI9341 &d, float x )
+{
+  for ( uint8_t c = 0; c < TC_CHANNELS; c++ )
+  {
+    if ( c == probes.control || isnan( probeTemp[c] ) )
+      continue;
+
+    int16_t py = plot.toY( probeTemp[c] );
+    if ( py < 220 )
+      d.fillRect( plot.toX( x ) - 1, py - 1, 2, 2, probeColors[c] );
+  }
+}
+
+// Plot the next point of the profile curve
+void GraphDefault( Adafruit_ILI9341 &d, float x, float y, unsigned int pcolor )
+{
+  plot.lineTo( d, plot.toX( x ), plot.toY( y ), pcolor );
+}
+
+// The last reflow or bake drawn again from the run history, starting with the whole run
+void ShowReview()
+{
+  state = REVIEW;
+  PROFILE_SCENARIO( "review" );
+
+  reviewStart = 0;
+  reviewSpan = runHistory.getLength();
+  DrawReview();
+}
+
+// Halve the window around its middle, back out to the whole run once it's down to a minute or a few buckets
+void ZoomReview()
+{
+  float middle = reviewStart + reviewSpan / 2;
+
+  reviewSpan /= 2;
+  if ( reviewSpan < max( 60.0f, runHistory.getScale() * 8.0f ) )
+    reviewSpan = runHistory.getLength();
+
+  reviewStart = middle - reviewSpan / 2;
+  DrawReview();
+}
+
+// Move the window half its width earlier or later
+void PanReview( int direction )
+{
+  reviewStart += direction * reviewSpan / 2;
+  DrawReview();
+}
+
+// The smallest grid step that gives no more than lines grid lines over range
+float ReviewStep( float range, int lines )
+{
+  static const float steps[] = { 1, 2, 5, 10, 15, 30, 60, 120, 300, 600, 900, 1800, 3600 };
 
-  //  d.fillRect( ox-1, oy-1, 3, 3, currentPlotColor );
+  for ( uint8_t i = 0; i < ELEMENTS( steps ); i++ )
+  {
+    if ( range / steps[i] <= lines )
+      return steps[i];
+  }
+  return steps[ELEMENTS( steps ) - 1];
+}
 
-  d.drawLine(ox, oy + 1, x, y + 1, currentPlotColor);
-  d.drawLine(ox, oy - 1, x, y - 1, currentPlotColor);
-  d.drawLine(ox, oy, x, y, currentPlotColor );
-  ox = x;
-  oy = y;
+// Whether the profile curve in RAM is the one the reviewed reflow ran to
+bool ReviewHasCurve()
+{
+  return runHistory.getType() == RUN_REFLOW && runHistory.getPaste() == set.paste && wantedCurveBuilt;
 }
 
-void GraphDefault(Adafruit_ILI9341 &d, double x, double y, double gx, double gy, double w, double h, unsigned int pcolor )
+void DrawReview()
 {
-  // recall that ox and oy are initialized as static above
-  x =  (x - graphRangeMin_X) * ( w) / (graphRangeMax_X - graphRangeMin_X) + gx;
-  y =  (y - graphRangeMin_Y) * (gy - h - gy) / (graphRangeMax_Y - graphRangeMin_Y) + gy;
+  PROFILE_SCOPE( "review" );
+  const int16_t gx = 30;
+  const int16_t gw = 270;
+
+  float length = max( (float)runHistory.getLength(), 1.0f );
+  reviewSpan = constrain( reviewSpan, 1.0f, length );
+  float xinc = ReviewStep( reviewSpan, 9 );
+
+  // Start on a grid line, so the time labels are round numbers
+  reviewStart = constrain( reviewStart, 0.0f, length - reviewSpan );
+  reviewStart = floor( reviewStart / xinc ) * xinc;
+  float end = reviewStart + reviewSpan;
+
+  // Scaled to what's in the window, so nothing is clipped and a small swing fills the height
+  float lo, hi;
+  if ( !runHistory.span( reviewStart, end, lo, hi ) )
+  {
+    lo = 0;
+    hi = 0;
+  }
+  float peak = hi;
+
+  if ( ReviewHasCurve() )
+  {
+    for ( int16_t c = 0; c <= gw; c += 5 )
+    {
+      float wanted = wantedCurve.value( reviewStart + reviewSpan * c / gw );
+      lo = min( lo, wanted );
+      hi = max( hi, wanted );
+    }
+  }
+
+  float yinc = ReviewStep( hi - lo + 10, 8 );
+  float ylo = floor( ( lo - 5 ) / yinc ) * yinc;
+  float yhi = ceil( ( hi + 5 ) / yinc ) * yinc;
+
+  ClearScreen();
+
+  TextBuffer title;
+  title.add( runHistory.getType() == RUN_BAKE ? "BAKE" : "REFLOW" ).add( " x" ).add( (long)round( length / reviewSpan ) ).add( " MAX " ).add( (long)round( peak ) ).add( "c" );
+  SetupGraph( tft, reviewStart, ylo, gx, 220, gw, 180, reviewStart, end, xinc, ylo, yhi, yinc, title.c_str(), " Time [s]", "deg [C]", DKBLUE, BLUE, WHITE, BLACK );
+
+  if ( ReviewHasCurve() )
+  {
+    plot.moveTo( plot.toX( reviewStart ), plot.toY( wantedCurve.value( reviewStart ) ) );
+    for ( int16_t c = 0; c <= gw; c += 5 )
+    {
+      float t = reviewStart + reviewSpan * c / gw;
+      GraphDefault( tft, t, wantedCurve.value( t ), PINK );
+    }
+  }
+
+  // One column per pixel, from the lowest to the highest temperature in its slice of the window
+  // Each column reaches to the one before it, so a fast ramp is still a solid line
+  int16_t lastTop = -1;
+  int16_t lastBottom = -1;
+  for ( int16_t c = 0; c < gw; c++ )
+  {
+    float t0 = reviewStart + reviewSpan * c / gw;
+    float t1 = reviewStart + reviewSpan * ( c + 1 ) / gw;
+    if ( !runHistory.span( t0, t1, lo, hi ) )
+    {
+      lastTop = -1;
+      continue;
+    }
+
+    int16_t top = plot.toY( hi );
+    int16_t bottom = plot.toY( lo );
+    int16_t drawTop = top;
+    int16_t drawBottom = bottom;
+    if ( lastTop >= 0 )
+    {
+      drawTop = min( drawTop, lastBottom );
+      drawBottom = max( drawBottom, lastTop );
+    }
+    lastTop = top;
+    lastBottom = bottom;
+
+    // As thick as the live graph line
+    tft.fillRect( gx + c, drawTop - 1, 1, drawBottom - drawTop + 3, GREEN );
+  }
 
-  //Serial.println( oy );
-  d.drawLine(ox, oy, x, y, pcolor);
-  d.drawLine(ox, oy + 1, x, y + 1, pcolor);
-  d.drawLine(ox, oy - 1, x, y - 1, pcolor);
-  ox = x;
-  oy = y;
+  ShowMenuOptions( false );
+}
+
+#ifdef PLOT_TIMING
+// The old way the thick lines were drawn, kept to time against
+void LegacyLine( Adafruit_ILI9341 &d, int16_t x0, int16_t y0, int16_t x1, int16_t y1, unsigned int pcolor )
+{
+  d.drawLine( x0, y0 + 1, x1, y1 + 1, pcolor );
+  d.drawLine( x0, y0 - 1, x1, y1 - 1, pcolor );
+  d.drawLine( x0, y0, x1, y1, pcolor );
 }
+#endif
 
-void println_Center( Adafruit_ILI9341 &d, String heading, int centerX, int centerY )
+void println_Center( Adafruit_ILI9341 &d, const char *heading, int centerX, int centerY )
 {
   int x = 0;
   int y = 0;
   int16_t  x1, y1;
   uint16_t ww, hh;
 
-  d.getTextBounds( heading.c_str(), x, y, &x1, &y1, &ww, &hh );
+  d.getTextBounds( heading, x, y, &x1, &y1, &ww, &hh );
   d.setCursor( centerX - ww / 2 + 2, centerY - hh / 2);
   d.println( heading );
 }
 
-void println_Right( Adafruit_ILI9341 &d, String heading, int centerX, int centerY )
+void println_Right( Adafruit_ILI9341 &d, const char *heading, int centerX, int centerY )
 {
   int x = 0;
   int y = 0;
   int16_t  x1, y1;
   uint16_t ww, hh;
 
-  d.getTextBounds( heading.c_str(), x, y, &x1, &y1, &ww, &hh );
+  d.getTextBounds( heading, x, y, &x1, &y1, &ww, &hh );
   d.setCursor( centerX + ( 18 - ww ), centerY - hh / 2);
   d.println( heading );
 }
 
 
+// Serial commands, one per line, long enough for a PROFILE ADD
+#define SERIAL_LINE_MAX 300
+
+char serialLine[SERIAL_LINE_MAX];
+int serialLinePos = 0;
+
+void CheckSerial()
+{
+  while ( Serial.available() > 0 )
+  {
+    char c = Serial.read();
+
+    if ( c == '\r' || c == '\n' )
+    {
+      serialLine[serialLinePos] = 0;
+      if ( serialLinePos > 0 )
+        RunSerialCommand( serialLine );
+      serialLinePos = 0;
+    }
+    else if ( serialLinePos < SERIAL_LINE_MAX - 1 )
+    {
+      serialLine[serialLinePos++] = toupper( c );
+    }
+  }
+}
+
+void RunSerialCommand( const char *cmd )
+{
+  if ( strcmp( cmd, "HEAP" ) == 0 )
+  {
+    PrintHeapStats( Serial );
+  }
+  else if ( strcmp( cmd, "TASKS" ) == 0 )
+  {
+    scheduler.printStats( Serial );
+  }
+  else if ( strcmp( cmd, "TASKS RESET" ) == 0 )
+  {
+    scheduler.resetStats();
+  }
+  else if ( strcmp( cmd, "SAFETY" ) == 0 )
+  {
+    safety.print( Serial );
+  }
+  else if ( strcmp( cmd, "RELAY" ) == 0 )
+  {
+    relayOutput.print( Serial );
+  }
+  else if ( strcmp( cmd, "PROF" ) == 0 || strcmp( cmd, "PROF RESET" ) == 0 )
+  {
+#ifdef PROFILER
+    if ( cmd[4] == 0 )
+      profiler.print( Serial );
+    else
+      profiler.reset();
+#else
+    Serial.println( "Built without PROFILER" );
+#endif
+  }
+  else if ( strcmp( cmd, "BOOT" ) == 0 )
+  {
+    PrintBootTimes( Serial );
+  }
+  else if ( strcmp( cmd, "STORE" ) == 0 )
+  {
+    settingsStore.print( Serial );
+  }
+  else if ( strcmp( cmd, "RUNS" ) == 0 )
+  {
+    runRecorder.list( Serial );
+  }
+  else if ( strcmp( cmd, "HISTORY" ) == 0 )
+  {
+    runHistory.print( Serial );
+  }
+  else if ( strncmp( cmd, "DUMP ", 5 ) == 0 )
+  {
+    if ( !runRecorder.dump( Serial, atoi( cmd + 5 ) ) )
+      Serial.println( "No such run" );
+  }
+  else if ( strcmp( cmd, "PROBES" ) == 0 )
+  {
+    ListProbes( Serial );
+  }
+  else if ( strncmp( cmd, "PROBE ", 6 ) == 0 )
+  {
+    SetProbe( cmd + 6 );
+  }
+  else if ( strcmp( cmd, "PROFILES" ) == 0 )
+  {
+    ListProfiles( Serial );
+  }
+  else if ( strncmp( cmd, "PROFILE ADD ", 12 ) == 0 )
+  {
+    AddProfile( cmd + 12 );
+  }
+  else if ( strncmp( cmd, "PROFILE DEL ", 12 ) == 0 )
+  {
+    DeleteProfile( atoi( cmd + 12 ) );
+  }
+  else
+  {
+    Serial.print( "Unknown command " );
+    Serial.println( cmd );
+    Serial.println( "Commands: HEAP TASKS [RESET] PROF [RESET] SAFETY RELAY BOOT STORE RUNS DUMP n HISTORY PROFILES PROFILE ADD hex|DEL id PROBES PROBE n OFFSET|FACTOR|TYPE x PROBE CONTROL n" );
+  }
+}
+
+void ListProbes( Print &out )
+{
+  out.println( "Probe temp status faults type offset factor" );
+
+  for ( uint8_t c = 0; c < TC_CHANNELS; c++ )
+  {
+    TextBuffer line;
+    line.add( c == probes.control ? "*" : " " ).add( c ).add( c == 0 ? " air " : " " );
+    if ( isnan( probeTemp[c] ) )
+      line.add( "-" );
+    else
+      line.add( probeTemp[c], 1 );
+    line.add( "c " ).add( tcSampler.getStatus( c ) ).add( " " ).add( tcSampler.getFaultCount( c ) );
+    line.add( " " ).add( tcChannels[c]->getTable() != NULL ? probes.type[c] : 'L' );
+    line.add( " " ).add( probes.offset[c], 2 ).add( " " ).add( probes.factor[c], 4 );
+    out.println( line.c_str() );
+  }
+}
+
+// PROBE n OFFSET x, PROBE n FACTOR x, PROBE n TYPE t or PROBE CONTROL n
+void SetProbe( const char *args )
+{
+  if ( strncmp( args, "CONTROL ", 8 ) == 0 )
+  {
+    int channel = atoi( args + 8 );
+
+    // Switching mid run would be a step change in what the controller sees
+    if ( ProfilesLocked() )
+      Serial.println( "Busy, try again when the oven is off" );
+    else if ( channel < 0 || channel >= (int) TC_CHANNELS )
+      Serial.println( "No such probe" );
+    else
+    {
+      probes.control = channel;
+      SaveProbeSettings();
+      ListProbes( Serial );
+    }
+    return;
+  }
+
+  char *rest;
+  long channel = strtol( args, &rest, 10 );
+
+  if ( rest == args || channel < 0 || channel >= (int) TC_CHANNELS )
+  {
+    Serial.println( "No such probe" );
+  }
+  else if ( strncmp( rest, " OFFSET ", 8 ) == 0 )
+  {
+    probes.offset[channel] = constrain( atof( rest + 8 ), -50.0, 50.0 );
+    SaveProbeSettings();
+    ListProbes( Serial );
+  }
+  else if ( strncmp( rest, " FACTOR ", 8 ) == 0 )
+  {
+    probes.factor[channel] = constrain( atof( rest + 8 ), 0.1, 10.0 );
+    SaveProbeSettings();
+    ListProbes( Serial );
+  }
+  else if ( strncmp( rest, " TYPE ", 6 ) == 0 && ( rest[6] == 'L' || TCTableFor( rest[6] ) != NULL ) )
+  {
+    // The table replaces the TCfactor approximation for other types
+    probes.type[channel] = rest[6];
+    if ( rest[6] != 'L' )
+      probes.factor[channel] = K_TC;
+    SaveProbeSettings();
+    ListProbes( Serial );
+  }
+  else
+  {
+    Serial.println( "PROBE n OFFSET x, PROBE n FACTOR x, PROBE n TYPE K|J|T|E|N|L or PROBE CONTROL n" );
+  }
+}
+
+void ListProfiles( Print &out )
+{
+  out.println( "Id liquidus name, type" );
+
+  for ( int i = 0; i < ProfileCount(); i++ )
+  {
+    int id = ProfileIdAt( i );
+    ProfileRecord record;
+    TextBuffer line;
+
+    const char *type = "";
+
+    // The type goes out on its own, name and type together can be more than a TextBuffer holds
+    line.add( id == set.paste ? "*" : " " ).add( id ).add( " " );
+    if ( id < PROFILE_STORED_ID )
+    {
+      line.add( solderPaste[id].tempDeg ).add( "c " ).add( solderPaste[id].n ).add( ", " );
+      type = solderPaste[id].t;
+    }
+    else if ( profileStore.read( id - PROFILE_STORED_ID, record ) )
+    {
+      line.add( record.liquidus ).add( "c " ).add( record.name ).add( ", " );
+      type = record.type;
+    }
+    out.print( line.c_str() );
+    out.println( type );
+  }
+
+  TextBuffer free;
+  free.add( PROFILESTORE_SLOTS - profileStore.count() ).add( " free slots" );
+  out.println( free.c_str() );
+}
+
+// Changing profiles under a run would change the curve it is following
+bool ProfilesLocked()
+{
+  return ( state == WARMUP || state == REFLOW || state == BAKE || state == OVENCHECK_START );
+}
+
+void AddProfile( const char *hex )
+{
+  ProfileRecord record;
+
+  if ( ProfilesLocked() )
+  {
+    Serial.println( "Busy, try again when the oven is off" );
+  }
+  else if ( !ProfileStore::fromHex( hex, record ) || !ProfileStore::isValid( record ) )
+  {
+    Serial.println( "Bad profile record" );
+  }
+  else
+  {
+    int8_t slot = profileStore.add( record );
+    if ( slot < 0 )
+    {
+      Serial.println( "Profile store is full" );
+      return;
+    }
+
+    TextBuffer line;
+    line.add( "Stored profile " ).add( PROFILE_STORED_ID + slot );
+    Serial.println( line.c_str() );
+
+    // It may have replaced the one in use
+    if ( set.paste == PROFILE_STORED_ID + slot )
+      SetCurrentGraph( set.paste );
+    if ( state == SETTINGS_PASTE )
+      ShowPaste();
+  }
+}
+
+void DeleteProfile( int id )
+{
+  if ( ProfilesLocked() )
+  {
+    Serial.println( "Busy, try again when the oven is off" );
+  }
+  else if ( id < PROFILE_STORED_ID )
+  {
+    Serial.println( "Built in profiles can't be deleted" );
+  }
+  else if ( !profileStore.remove( id - PROFILE_STORED_ID ) )
+  {
+    Serial.println( "No such profile" );
+  }
+  else
+  {
+    Serial.println( "Profile deleted" );
+
+    if ( set.paste == id )
+    {
+      set.paste = 0;
+      SetCurrentGraph( set.paste );
+      SaveSettings();
+    }
+
+    if ( state == SETTINGS_PASTE )
+    {
+      settings_pointer = constrain( settings_pointer, 0, ProfileCount() - 1 );
+      ShowPaste();
+    }
+  }
+}
+
 // Debug printing functions
-void debug_print(String txt)
+void debug_print(const char *txt)
 {
 #ifdef DEBUG
+  PROFILE_SCOPE( "debug" );
   Serial.print(txt);
 #endif
 }
@@ -2380,13 +3928,15 @@ void debug_print(String txt)
 void debug_print(int txt)
 {
 #ifdef DEBUG
+  PROFILE_SCOPE( "debug" );
   Serial.print(txt);
 #endif
 }
 
-void debug_println(String txt)
+void debug_println(const char *txt)
 {
 #ifdef DEBUG
+  PROFILE_SCOPE( "debug" );
   Serial.println(txt);
 #endif
 }
@@ -2394,6 +3944,7 @@ void debug_println(String txt)
 void debug_println(int txt)
 {
 #ifdef DEBUG
+  PROFILE_SCOPE( "debug" );
   Serial.println(txt);
 #endif
 }
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "RelayOutput.h"
+#include "TextBuffer.h"
+
+// Called from the timer interrupt
+static RelayOutput *timerOutput = NULL;
+
+RelayPattern::RelayPattern( void )
+{
+  begin( RELAY_BURST, 100 );
+}
+
+void RelayPattern::begin( uint8_t mode, uint16_t window )
+{
+  _mode = mode;
+  _window = max( window, (uint16_t)1 );
+  _duty = 0;
+  _tick = 0;
+  _windowOn = 0;
+  _error = 0;
+  _onTicks = 0;
+  _lastOnTicks = 0;
+}
+
+bool RelayPattern::next()
+{
+  // Time proportioning only takes a new duty at the start of a window, so a window is never on twice
+  if ( _tick == 0 )
+    _windowOn = ( (uint32_t)_duty * _window + 127 ) / 255;
+
+  bool on;
+  if ( _mode == RELAY_WINDOW )
+  {
+    on = ( _tick < _windowOn );
+  }
+  else
+  {
+    // On whenever the duty owed adds up to a whole tick
+    _error += _duty;
+    on = ( _error >= 255 );
+    if ( on )
+      _error -= 255;
+  }
+
+  if ( on )
+    _onTicks++;
+
+  if ( ++_tick >= _window )
+  {
+    _lastOnTicks = _onTicks;
+    _onTicks = 0;
+    _tick = 0;
+  }
+
+  return on;
+}
+
+void RelayPattern::off()
+{
+  _duty = 0;
+  _windowOn = 0;
+  _error = 0;
+  _onTicks = 0;
+  _tick = 0;
+}
+
+RelayOutput::RelayOutput( uint8_t pin )
+{
+  _pin = pin;
+  _tickRate = 100;
+  _tickMicros = 10000;
+  _nextPoll = 0;
+}
+
+void RelayOutput::begin( uint8_t mode, uint16_t mainsHz, uint16_t windowTime )
+{
+  write( false );
+
+  _tickRate = max( mainsHz, (uint16_t)1 ) * 2;
+  _tickMicros = 1000000UL / _tickRate;
+  _pattern.begin( mode, ( (unsigned long)windowTime * _tickRate + 500 ) / 1000 );
+
+  startTimer();
+}
+
+void RelayOutput::poll()
+{
+#if !defined(ARDUINO_ARCH_SAMD)
+  while ( (long)( micros() - _nextPoll ) >= 0 )
+  {
+    _nextPoll += _tickMicros;
+    tick();
+  }
+#endif
+}
+
+void RelayOutput::off()
+{
+#if defined(ARDUINO_ARCH_SAMD)
+  // The timer tick is masked, so it can't turn the relay back on from the window it was in
+  NVIC_DisableIRQ( TC3_IRQn );
+  __DSB();
+  __ISB();
+#endif
+
+  _pattern.off();
+  write( false );
+
+#if defined(ARDUINO_ARCH_SAMD)
+  NVIC_EnableIRQ( TC3_IRQn );
+#endif
+}
+
+void RelayOutput::tick()
+{
+  write( _pattern.next() );
+}
+
+unsigned long RelayOutput::getWindowTime() const
+{
+  return (unsigned long)_pattern.getWindow() * 1000 / _tickRate;
+}
+
+unsigned long RelayOutput::getLastOnTime() const
+{
+  return (unsigned long)_pattern.getLastOnTicks() * 1000 / _tickRate;
+}
+
+void RelayOutput::print( Print &out ) const
+{
+  TextBuffer line;
+  line.add( "Relay " ).add( getMode() == RELAY_WINDOW ? "window" : "burst" ).add( " " ).add( _tickRate ).add( " half cycles/s, duty " ).add( (unsigned)getDuty() );
+  out.println( line.c_str() );
+
+  line.clear();
+  line.add( "Last window on " ).add( getLastOnTime() ).add( "ms of " ).add( getWindowTime() ).add( "ms" );
+  out.println( line.c_str() );
+}
+
+#if defined(ARDUINO_ARCH_SAMD)
+
+// Straight to the port, it's called every half cycle from the interrupt
+void RelayOutput::write( bool on )
+{
+  const PinDescription &pin = g_APinDescription[_pin];
+  if ( on )
+    PORT->Group[pin.ulPort].OUTSET.reg = ( 1ul << pin.ulPin );
+  else
+    PORT->Group[pin.ulPort].OUTCLR.reg = ( 1ul << pin.ulPin );
+}
+
+// TC3 was the relay pin's analogWrite() timer, it's free now the relay isn't PWM
+void RelayOutput::startTimer()
+{
+  timerOutput = this;
+
+  GCLK->CLKCTRL.reg = (uint16_t)( GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID_TCC2_TC3 );
+  while ( GCLK->STATUS.bit.SYNCBUSY );
+
+  TC3->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+  while ( TC3->COUNT16.STATUS.bit.SYNCBUSY );
+
+  // 48MHz / 64 ticks, 7500 to a 50Hz half cycle and 6250 to a 60Hz one, both exact
+  TC3->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER_DIV64;
+  while ( TC3->COUNT16.STATUS.bit.SYNCBUSY );
+
+  TC3->COUNT16.CC[0].reg = (uint16_t)( ( SystemCoreClock / 64 ) / _tickRate - 1 );
+  while ( TC3->COUNT16.STATUS.bit.SYNCBUSY );
+
+  // The same priority as the sampler, so a safety cutoff there and a tick here can't interleave
+  TC3->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+  NVIC_SetPriority( TC3_IRQn, 2 );
+  NVIC_EnableIRQ( TC3_IRQn );
+
+  TC3->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE;
+  while ( TC3->COUNT16.STATUS.bit.SYNCBUSY );
+}
+
+void TC3_Handler()
+{
+  TC3->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+
+  if ( timerOutput != NULL )
+    timerOutput->tick();
+}
+
+#else
+
+void RelayOutput::write( bool on )
+{
+  digitalWrite( _pin, on ? HIGH : LOW );
+}
+
+// No hardware timer support, poll() drives the ticks instead
+void RelayOutput::startTimer()
+{
+  timerOutput = this;
+  _nextPoll = micros();
+}
+
+#endif
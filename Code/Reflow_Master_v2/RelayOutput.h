@@ -0,0 +1,116 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Relay Output
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Drives the SSR in whole mains half cycles, so the power the oven gets is the
+  duty cycle asked for.
+
+  A zero cross SSR can only switch at a zero crossing, so with analogWrite()'s
+  kHz PWM it sees a gate that is on for part of every half cycle, and what the
+  oven gets depends on how that lines up with the mains. Here a hardware timer
+  ticks once per half cycle and turns the relay on or off for the whole of it.
+
+  RelayPattern decides each tick, it has no hardware in it:
+    RELAY_BURST   spreads the on half cycles as evenly as it can, carrying the
+                  remainder over, so any 0-255 duty is exact on average and the
+                  oven never sees a long run of on or off.
+    RELAY_WINDOW  time proportioning, on for the first duty/255 of each window
+                  and off for the rest. Coarser, but fewer switches.
+
+  The timer isn't synced to the mains, so the odd half cycle lands either side
+  of a crossing, but over a window the count of on half cycles is what counts.
+  Both modes count the half cycles actually turned on in each window, so the
+  on-time delivered can be reported against the duty asked for.
+  ---------------------------------------------------------------------------
+*/
+#ifndef RelayOutput_h
+#define RelayOutput_h
+
+#include <Arduino.h>
+
+enum relayModes {
+  RELAY_BURST = 0,
+  RELAY_WINDOW = 1
+};
+
+class RelayPattern
+{
+  public:
+    RelayPattern( void );
+
+    // window in ticks, the time proportioning period and the on-time reporting period
+    void begin( uint8_t mode, uint16_t window );
+
+    // 0-255, burst picks it up on the next tick, time proportioning at the next window
+    void setDuty( uint8_t duty ) { _duty = duty; }
+
+    // Whether the relay is on for the next tick
+    bool next();
+
+    // Duty 0 and the current window ended, so nothing more of it is turned on
+    void off();
+
+    uint8_t getMode() const { return _mode; }
+    uint8_t getDuty() const { return _duty; }
+    uint16_t getWindow() const { return _window; }
+
+    // On ticks in the last full window
+    uint16_t getLastOnTicks() const { return _lastOnTicks; }
+
+  private:
+    uint8_t _mode;
+    uint16_t _window;
+    volatile uint8_t _duty;
+
+    uint16_t _tick;
+    uint16_t _windowOn;
+    uint16_t _error;
+    uint16_t _onTicks;
+    volatile uint16_t _lastOnTicks;
+};
+
+class RelayOutput
+{
+  public:
+    RelayOutput( uint8_t pin );
+
+    // Tick at 2 * mainsHz, windowTime in ms rounded to whole half cycles
+    void begin( uint8_t mode, uint16_t mainsHz, uint16_t windowTime );
+
+    // Only needed on boards without hardware timer support, catches up on the ticks due
+    void poll();
+
+    void setDuty( uint8_t duty ) { _pattern.setDuty( duty ); }
+    uint8_t getDuty() const { return _pattern.getDuty(); }
+
+    // Relay off right now and duty 0, safe to call from an interrupt
+    void off();
+
+    // Called from the timer interrupt
+    void tick();
+
+    uint8_t getMode() const { return _pattern.getMode(); }
+
+    // Length of the window and the time the relay was on in the last one, in ms
+    unsigned long getWindowTime() const;
+    unsigned long getLastOnTime() const;
+
+    void print( Print &out ) const;
+
+  private:
+    RelayPattern _pattern;
+    uint8_t _pin;
+    uint16_t _tickRate;
+    unsigned long _tickMicros;
+    unsigned long _nextPoll;
+
+    void write( bool on );
+    void startTimer();
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include "RunHistory.h"
+#include "TextBuffer.h"
+
+// Nothing in the bucket yet, the min above the max
+#define HISTORY_EMPTY_LO 0xFFF
+#define HISTORY_EMPTY_HI 0
+
+static_assert( ( HISTORY_BASE >> ( HISTORY_LEVELS - 1 ) ) << ( HISTORY_LEVELS - 1 ) == HISTORY_BASE, "HISTORY_BASE must halve evenly for every level" );
+
+RunHistory::RunHistory( void )
+{
+  begin( 0, 0 );
+}
+
+void RunHistory::begin( uint8_t type, uint8_t paste )
+{
+  _type = type;
+  _paste = paste;
+  _scale = 1;
+
+  for ( uint8_t l = 0; l < HISTORY_LEVELS; l++ )
+  {
+    _count[l] = 0;
+    clear( l, 0 );
+  }
+}
+
+// Levels are one after the other, base first
+uint16_t RunHistory::offset( uint8_t level )
+{
+  return HISTORY_BASE * 2 - ( ( HISTORY_BASE * 2 ) >> level );
+}
+
+void RunHistory::get( uint8_t level, uint16_t index, uint16_t &lo, uint16_t &hi ) const
+{
+  const uint8_t *b = _buckets[offset( level ) + index].b;
+  lo = b[0] | ( ( b[1] & 0x0F ) << 8 );
+  hi = ( b[1] >> 4 ) | ( b[2] << 4 );
+}
+
+void RunHistory::set( uint8_t level, uint16_t index, uint16_t lo, uint16_t hi )
+{
+  uint8_t *b = _buckets[offset( level ) + index].b;
+  b[0] = lo & 0xFF;
+  b[1] = ( ( lo >> 8 ) & 0x0F ) | ( ( hi & 0x0F ) << 4 );
+  b[2] = hi >> 4;
+}
+
+// Empty the buckets of a level from index on
+void RunHistory::clear( uint8_t level, uint16_t from )
+{
+  for ( uint16_t i = from; i < capacity( level ); i++ )
+    set( level, i, HISTORY_EMPTY_LO, HISTORY_EMPTY_HI );
+}
+
+void RunHistory::add( float seconds, float temp )
+{
+  if ( seconds < 0 )
+    return;
+
+  // 1/4 C, the resolution of the MAX31855
+  long q = (long)( temp * 4 + 0.5f );
+  uint16_t t = constrain( q, 0L, (long)HISTORY_EMPTY_LO - 1 );
+
+  unsigned long index = (unsigned long)seconds / _scale;
+  while ( index >= capacity( 0 ) )
+  {
+    shed();
+    index = (unsigned long)seconds / _scale;
+  }
+
+  for ( uint8_t l = 0; l < HISTORY_LEVELS; l++ )
+  {
+    uint16_t i = index >> l;
+    uint16_t lo, hi;
+    get( l, i, lo, hi );
+    set( l, i, min( lo, t ), max( hi, t ) );
+
+    if ( i >= _count[l] )
+      _count[l] = i + 1;
+  }
+}
+
+// The base level is full, drop it and move every level down one into twice the room
+void RunHistory::shed()
+{
+  for ( uint8_t l = 0; l < HISTORY_LEVELS - 1; l++ )
+  {
+    // Each level ends before the next one starts, so this never runs over one still to move
+    memmove( &_buckets[offset( l )], &_buckets[offset( l + 1 )], _count[l + 1] * sizeof( HistoryBucket ) );
+    _count[l] = _count[l + 1];
+    clear( l, _count[l] );
+  }
+
+  // A new top level, pairs of the one below it
+  uint8_t top = HISTORY_LEVELS - 1;
+  _count[top] = ( _count[top - 1] + 1 ) / 2;
+  for ( uint16_t i = 0; i < _count[top]; i++ )
+  {
+    uint16_t lo, hi, lo2, hi2;
+    get( top - 1, i * 2, lo, hi );
+    get( top - 1, i * 2 + 1, lo2, hi2 );
+    set( top, i, min( lo, lo2 ), max( hi, hi2 ) );
+  }
+  clear( top, _count[top] );
+
+  _scale *= 2;
+}
+
+bool RunHistory::span( float t0, float t1, float &lo, float &hi ) const
+{
+  t0 = max( t0, 0.0f );
+  if ( t1 <= t0 )
+    return false;
+
+  // The coarsest level with buckets no longer than the window, it's only ever 2 or 3 buckets
+  uint8_t level = 0;
+  while ( level < HISTORY_LEVELS - 1 && ( (unsigned long)_scale << ( level + 1 ) ) <= t1 - t0 )
+    level++;
+
+  float width = (float)( (unsigned long)_scale << level );
+  unsigned long first = (unsigned long)( t0 / width );
+  unsigned long last = (unsigned long)ceil( t1 / width );
+  last = min( last, (unsigned long)_count[level] );
+
+  uint16_t qlo = HISTORY_EMPTY_LO;
+  uint16_t qhi = HISTORY_EMPTY_HI;
+  for ( unsigned long i = first; i < last; i++ )
+  {
+    uint16_t blo, bhi;
+    get( level, i, blo, bhi );
+    qlo = min( qlo, blo );
+    qhi = max( qhi, bhi );
+  }
+
+  if ( qlo > qhi )
+    return false;
+
+  lo = qlo / 4.0f;
+  hi = qhi / 4.0f;
+  return true;
+}
+
+void RunHistory::print( Print &out ) const
+{
+  TextBuffer line;
+  line.add( "History " ).add( getLength() ).add( "s at " ).add( _scale ).add( "s a bucket, " ).add( (unsigned long)sizeof( _buckets ) ).add( " bytes" );
+  out.println( line.c_str() );
+
+  for ( uint8_t l = 0; l < HISTORY_LEVELS; l++ )
+  {
+    line.clear();
+    line.add( "Level " ).add( l ).add( " " ).add( (unsigned long)_scale << l ).add( "s " ).add( _count[l] ).add( "/" ).add( capacity( l ) );
+    out.println( line.c_str() );
+  }
+
+  float lo, hi;
+  if ( span( 0, getLength(), lo, hi ) )
+  {
+    line.clear();
+    line.add( "Temp " ).add( lo, 2 ).add( "c to " ).add( hi, 2 ).add( "c" );
+    out.println( line.c_str() );
+  }
+}
@@ -0,0 +1,86 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Run History
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Keeps the temperature of the last reflow or bake in RAM as a min/max
+  pyramid, so the run can be drawn again afterwards at any zoom, and a 3 hour
+  bake fits as well as a 6 minute reflow.
+
+  Each bucket holds the lowest and highest temperature seen in its slice of
+  time, in 1/4 C, packed into 3 bytes. The base level starts at 1 second a
+  bucket, and each level above it has buckets twice as long and half as many
+  of them, so every level covers the same stretch of time. Every sample goes
+  straight into its bucket on every level.
+
+  When the base level is full, it is dropped and every level moves down one,
+  into twice the room, and a new top level is made from the old one. So the
+  base is always the finest resolution that still covers the whole run,
+  1 second for any built in reflow profile and 32 seconds for a 3 hour bake.
+
+  span() gives the min and max over any window, from the coarsest level whose
+  buckets are no longer than the window, so drawing a graph column is a few
+  buckets whatever the zoom.
+  ---------------------------------------------------------------------------
+*/
+#ifndef RunHistory_h
+#define RunHistory_h
+
+#include <Arduino.h>
+
+// Buckets in the base level, the levels above have half as many each
+#define HISTORY_BASE 384
+#define HISTORY_LEVELS 6
+
+typedef struct {
+  uint8_t b[3];   // 12 bit min and max, 1/4 C from 0 C
+} HistoryBucket;
+
+class RunHistory
+{
+  public:
+    RunHistory( void );
+
+    // Start a new run, the last one is thrown away
+    void begin( uint8_t type, uint8_t paste );
+
+    // seconds from the start of the run, they only go forwards
+    void add( float seconds, float temp );
+
+    // Whether there is anything to show
+    bool hasRun() const { return _count[0] > 0; }
+    uint8_t getType() const { return _type; }
+    uint8_t getPaste() const { return _paste; }
+
+    // Seconds from the start of the run to the end of the last bucket with a sample in it
+    unsigned long getLength() const { return (unsigned long)_count[0] * _scale; }
+
+    // Seconds per base level bucket
+    uint16_t getScale() const { return _scale; }
+
+    // Lowest and highest temperature from t0 to t1 seconds, false if no samples fall in it
+    bool span( float t0, float t1, float &lo, float &hi ) const;
+
+    void print( Print &out ) const;
+
+  private:
+    HistoryBucket _buckets[HISTORY_BASE * 2];
+    uint16_t _count[HISTORY_LEVELS];
+    uint16_t _scale;
+    uint8_t _type;
+    uint8_t _paste;
+
+    static uint16_t offset( uint8_t level );
+    static uint16_t capacity( uint8_t level ) { return HISTORY_BASE >> level; }
+
+    void get( uint8_t level, uint16_t index, uint16_t &lo, uint16_t &hi ) const;
+    void set( uint8_t level, uint16_t index, uint16_t lo, uint16_t hi );
+    void clear( uint8_t level, uint16_t from );
+    void shed();
+};
+
+#endif
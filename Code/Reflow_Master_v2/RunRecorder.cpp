@@ -0,0 +1,408 @@
+#include "RunRecorder.h"
+#include "FlashStorage.h"
+#include "Telemetry.h"
+#include "TextBuffer.h"
+
+#define RUNLOG_MAGIC 0x4C52524DUL // "MRRL"
+#define RUNLOG_ROW 256
+
+// Token that starts a repeat count or a step change
+#define TOKEN_REPEAT 0x80
+
+#define CHANGED_TEMP 0x01
+#define CHANGED_SLOPE 0x02
+#define CHANGED_DUTY 0x04
+#define CHANGED_FLAGS 0x08
+#define CHANGED_TICK 0x10
+
+// Flags byte, fan in bit 0 and the MAX31855 fault bits above it
+#define FLAG_FAN 0x01
+#define FLAG_NOREAD 0x10
+
+// Reserved flash for the stored runs, the same way FlashStorage reserves its space
+__attribute__((__aligned__(256)))
+static const uint8_t runFlashData[RUNLOG_FLASH_SIZE] = { };
+static FlashClass runFlash( runFlashData, RUNLOG_FLASH_SIZE );
+
+static void readFlash( uint32_t offset, void *data, uint32_t size )
+{
+  runFlash.read( runFlashData + offset, data, size );
+}
+
+static uint8_t readFlashByte( uint32_t offset )
+{
+  uint8_t b;
+  readFlash( offset, &b, 1 );
+  return b;
+}
+
+static long quarter( float v )
+{
+  return (long)( v >= 0 ? v * 4 + 0.5f : v * 4 - 0.5f );
+}
+
+static const char* typeName( uint8_t type )
+{
+  if ( type == RUN_BAKE )
+    return "BAKE";
+  else if ( type == RUN_OVENCHECK )
+    return "OVENCHECK";
+  return "REFLOW";
+}
+
+RunRecorder::RunRecorder( void )
+{
+  _len = 0;
+  _recording = false;
+  _full = false;
+}
+
+void RunRecorder::begin( uint8_t type, uint8_t paste )
+{
+  RunHeader *header = (RunHeader*)_buf;
+  memset( header, 0, sizeof( RunHeader ) );
+  header->magic = RUNLOG_MAGIC;
+  header->type = type;
+  header->paste = paste;
+
+  _len = sizeof( RunHeader );
+  _recording = true;
+  _full = false;
+  _step = 1;
+  _stepAt = RUNLOG_BUFFER / 2;
+  _stepCount = 0;
+  _repeats = 0;
+  _ticks = 0;
+  _startMs = 0;
+  _lastTime = 0;
+  _lastTick = 0;
+  _lastTemp = 0;
+  _lastSet = 0;
+  _lastSlope = 0;
+  _lastDuty = 0;
+  _lastFlags = 0;
+}
+
+void RunRecorder::put( uint8_t b )
+{
+  if ( _len < RUNLOG_BUFFER )
+    _buf[_len++] = b;
+}
+
+void RunRecorder::putVarint( long v )
+{
+  // Zigzag so small negative numbers stay small, then 7 bits per byte
+  uint32_t z = ( (uint32_t)v << 1 ) ^ (uint32_t)( v >> 31 );
+  while ( z >= 0x80 )
+  {
+    put( ( z & 0x7F ) | 0x80 );
+    z >>= 7;
+  }
+  put( z );
+}
+
+void RunRecorder::flushRepeats()
+{
+  if ( _repeats > 0 )
+  {
+    put( TOKEN_REPEAT | _repeats );
+    _repeats = 0;
+  }
+}
+
+void RunRecorder::tick( unsigned long ms, float temp, float setpoint, uint8_t duty, bool fan, uint8_t tcStatus )
+{
+  if ( !_recording || _full )
+    return;
+
+  if ( _ticks == 0 )
+  {
+    _startMs = ms;
+    ( (RunHeader*)_buf )->startTemp = quarter( temp );
+  }
+
+  _ticks++;
+  ( (RunHeader*)_buf )->duration = ms - _startMs;
+
+  // Once the buffer is filling up, only keep every Nth tick
+  if ( ++_stepCount < _step )
+    return;
+  _stepCount = 0;
+
+  long time = ( ms - _startMs + 50 ) / 100;
+  long tickLen = time - _lastTime;
+  long t = quarter( temp );
+  long s = quarter( setpoint );
+  long slope = s - _lastSet;
+  uint8_t flags = ( fan ? FLAG_FAN : 0 ) | ( ( tcStatus & 0x07 ) << 1 ) | ( ( tcStatus & 0x80 ) ? FLAG_NOREAD : 0 );
+
+  uint8_t changed = 0;
+  if ( t != _lastTemp )
+    changed |= CHANGED_TEMP;
+  if ( slope != _lastSlope )
+    changed |= CHANGED_SLOPE;
+  if ( duty != _lastDuty )
+    changed |= CHANGED_DUTY;
+  if ( flags != _lastFlags )
+    changed |= CHANGED_FLAGS;
+  if ( tickLen != _lastTick )
+    changed |= CHANGED_TICK;
+
+  if ( changed == 0 )
+  {
+    _repeats++;
+    if ( _repeats == 0x7F )
+      flushRepeats();
+  }
+  else
+  {
+    flushRepeats();
+    put( changed );
+    if ( changed & CHANGED_TEMP )
+      putVarint( t - _lastTemp );
+    if ( changed & CHANGED_SLOPE )
+      putVarint( slope - _lastSlope );
+    if ( changed & CHANGED_DUTY )
+      put( duty );
+    if ( changed & CHANGED_FLAGS )
+      put( flags );
+    if ( changed & CHANGED_TICK )
+      putVarint( tickLen );
+  }
+
+  _lastTime = time;
+  _lastTick = tickLen;
+  _lastTemp = t;
+  _lastSet = s;
+  _lastSlope = slope;
+  _lastDuty = duty;
+  _lastFlags = flags;
+
+  int remaining = RUNLOG_BUFFER - _len;
+
+  if ( remaining < 16 )
+  {
+    // Out of room, the run so far is kept
+    flushRepeats();
+    _full = true;
+  }
+  else if ( _len >= _stepAt && _step < 128 )
+  {
+    flushRepeats();
+    _step *= 2;
+    _stepAt += RUNLOG_BUFFER / 16;
+    put( TOKEN_REPEAT );
+    put( _step );
+  }
+}
+
+bool RunRecorder::validRun( uint32_t offset, RunHeader &header ) const
+{
+  if ( offset + sizeof( RunHeader ) > RUNLOG_FLASH_SIZE )
+    return false;
+
+  readFlash( offset, &header, sizeof( RunHeader ) );
+
+  if ( header.magic != RUNLOG_MAGIC || sizeof( RunHeader ) + header.length > RUNLOG_BUFFER || offset + sizeof( RunHeader ) + header.length > RUNLOG_FLASH_SIZE )
+    return false;
+
+  // CRC over the header with the crc field zeroed, then on through the tick data a chunk at a time
+  RunHeader check = header;
+  check.crc = 0;
+  uint16_t crc = Telemetry::crc16( (const uint8_t*)&check, sizeof( RunHeader ) );
+
+  uint8_t chunk[64];
+  for ( uint16_t pos = 0; pos < header.length; pos += sizeof( chunk ) )
+  {
+    uint16_t len = min( (int)sizeof( chunk ), header.length - pos );
+    readFlash( offset + sizeof( RunHeader ) + pos, chunk, len );
+    crc = Telemetry::crc16( chunk, len, crc );
+  }
+
+  return ( crc == header.crc );
+}
+
+bool RunRecorder::end( uint8_t result )
+{
+  if ( !_recording )
+    return false;
+
+  flushRepeats();
+  _recording = false;
+
+  RunHeader *header = (RunHeader*)_buf;
+  header->result = result;
+  header->ticks = _ticks;
+  header->length = _len - sizeof( RunHeader );
+
+  // Find the newest stored run, the new one goes on the row after it
+  uint32_t pos = 0;
+  bool found = false;
+  uint16_t newest = 0;
+  RunHeader stored;
+
+  for ( uint32_t offset = 0; offset < RUNLOG_FLASH_SIZE; offset += RUNLOG_ROW )
+  {
+    if ( validRun( offset, stored ) && ( !found || (int16_t)( stored.sequence - newest ) > 0 ) )
+    {
+      found = true;
+      newest = stored.sequence;
+      pos = offset + sizeof( RunHeader ) + stored.length;
+    }
+  }
+
+  header->sequence = found ? newest + 1 : 1;
+  header->crc = 0;
+  header->crc = Telemetry::crc16( _buf, _len );
+
+  pos = ( pos + RUNLOG_ROW - 1 ) / RUNLOG_ROW * RUNLOG_ROW;
+  if ( pos + _len > RUNLOG_FLASH_SIZE )
+    pos = 0;
+
+  // The flash write goes a whole word at a time
+  while ( _len & 3 )
+    _buf[_len++] = 0xFF;
+
+  runFlash.erase( runFlashData + pos, _len );
+  runFlash.write( runFlashData + pos, _buf, _len );
+
+  return validRun( pos, stored );
+}
+
+long RunRecorder::findRun( uint16_t sequence ) const
+{
+  RunHeader header;
+
+  for ( uint32_t offset = 0; offset < RUNLOG_FLASH_SIZE; offset += RUNLOG_ROW )
+  {
+    if ( validRun( offset, header ) && header.sequence == sequence )
+      return offset;
+  }
+  return -1;
+}
+
+void RunRecorder::list( Print &out )
+{
+  int count = 0;
+  RunHeader run;
+
+  // Find the oldest, then walk the sequence numbers up from it, there are never many runs
+  uint16_t oldest = 0;
+  bool found = false;
+  for ( uint32_t offset = 0; offset < RUNLOG_FLASH_SIZE; offset += RUNLOG_ROW )
+  {
+    if ( validRun( offset, run ) && ( !found || (int16_t)( run.sequence - oldest ) < 0 ) )
+    {
+      oldest = run.sequence;
+      found = true;
+    }
+  }
+
+  for ( uint16_t seq = oldest; found; seq++ )
+  {
+    long offset = findRun( seq );
+    if ( offset < 0 )
+      break;
+
+    readFlash( offset, &run, sizeof( RunHeader ) );
+
+    TextBuffer line;
+    line.add( "RUN " ).add( (unsigned)run.sequence ).add( " " ).add( typeName( run.type ) );
+    line.add( run.result == RUN_COMPLETE ? " COMPLETE" : " ABORTED" );
+    if ( run.type == RUN_REFLOW )
+      line.add( " PASTE " ).add( (unsigned)run.paste );
+    line.add( " TIME " ).addDuration( run.duration / 1000 ).add( " TICKS " ).add( (unsigned long)run.ticks ).add( " BYTES " ).add( (unsigned)run.length );
+    out.println( line.c_str() );
+    count++;
+  }
+
+  TextBuffer total;
+  total.add( count ).add( " runs stored" );
+  out.println( total.c_str() );
+}
+
+static long readVarint( uint32_t &pos, uint32_t end )
+{
+  uint32_t z = 0;
+  uint8_t shift = 0;
+  uint8_t b = 0x80;
+
+  while ( ( b & 0x80 ) && pos < end && shift < 32 )
+  {
+    b = readFlashByte( pos++ );
+    z |= (uint32_t)( b & 0x7F ) << shift;
+    shift += 7;
+  }
+
+  // Undo the zigzag
+  return (long)( z >> 1 ) ^ -(long)( z & 1 );
+}
+
+bool RunRecorder::dump( Print &out, uint16_t sequence )
+{
+  long offset = findRun( sequence );
+  if ( offset < 0 )
+    return false;
+
+  RunHeader run;
+  readFlash( offset, &run, sizeof( RunHeader ) );
+
+  uint32_t pos = offset + sizeof( RunHeader );
+  uint32_t end = pos + run.length;
+
+  // Same predictions as the encoder
+  long time = 0;
+  long tickLen = 0;
+  long temp = 0;
+  long set = 0;
+  long slope = 0;
+  uint8_t duty = 0;
+  uint8_t flags = 0;
+
+  out.println( "time_s,temp_c,setpoint_c,duty,fan,tc_status" );
+
+  while ( pos < end )
+  {
+    uint8_t token = readFlashByte( pos++ );
+    int ticks = 1;
+
+    if ( token & TOKEN_REPEAT )
+    {
+      ticks = token & 0x7F;
+      if ( ticks == 0 )
+      {
+        // Step change, the tick length that follows it carries the new spacing
+        pos++;
+        continue;
+      }
+    }
+    else
+    {
+      if ( token & CHANGED_TEMP )
+        temp += readVarint( pos, end );
+      if ( token & CHANGED_SLOPE )
+        slope += readVarint( pos, end );
+      if ( token & CHANGED_DUTY )
+        duty = readFlashByte( pos++ );
+      if ( token & CHANGED_FLAGS )
+        flags = readFlashByte( pos++ );
+      if ( token & CHANGED_TICK )
+        tickLen = readVarint( pos, end );
+    }
+
+    for ( int i = 0; i < ticks; i++ )
+    {
+      time += tickLen;
+      set += slope;
+
+      uint8_t tc = ( flags & FLAG_NOREAD ) ? 0x80 : ( flags >> 1 ) & 0x07;
+
+      TextBuffer line;
+      line.addFixed( time, 1 ).add( ',' ).addFixed( temp * 25, 2 ).add( ',' ).addFixed( set * 25, 2 ).add( ',' );
+      line.add( (unsigned)duty ).add( ',' ).add( (unsigned)( flags & FLAG_FAN ) ).add( ',' ).add( (unsigned)tc );
+      out.println( line.c_str() );
+    }
+  }
+
+  return true;
+}
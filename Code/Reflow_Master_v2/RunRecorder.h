@@ -0,0 +1,121 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Run Recorder
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Records every control tick of a reflow, bake or oven check into RAM, then
+  keeps the finished run in a reserved area of flash, so there is a record of
+  each batch after the screen has moved on.
+
+  Ticks are delta encoded. Temperatures are kept in 1/4 C, the resolution of
+  the MAX31855. A tick starts with a byte that says which values were not what
+  we predicted, followed by just those values as zigzag varints:
+    bit 0  temp changed, delta from the last tick
+    bit 1  setpoint slope changed, delta from the last slope
+    bit 2  duty changed, the new duty
+    bit 3  fan or TC status changed, the new flags
+    bit 4  tick length changed, the new length in 1/10 s
+  Ticks where everything was as predicted aren't written at all, they are
+  counted and written as a single 0x80 + count byte. 0x80 followed by a byte
+  means only every Nth tick is kept from there on. Once half the RAM buffer is
+  used, N doubles every 1/16th of the buffer, so a long bake still covers the
+  whole run, just more coarsely towards the end.
+
+  A 6 minute reflow is around 1KB and a 3 hour bake fits in the buffer.
+
+  Runs are stored one after the other on flash row boundaries, wrapping back
+  to the start and over the oldest runs when the area is full. Each run has a
+  CRC, so one that has been partly overwritten is just skipped.
+  ---------------------------------------------------------------------------
+*/
+#ifndef RunRecorder_h
+#define RunRecorder_h
+
+#include <Arduino.h>
+
+// RAM for the run being recorded, header included
+#define RUNLOG_BUFFER 4096
+
+// Flash kept for stored runs, a whole number of 256 byte rows
+#define RUNLOG_FLASH_SIZE 16384
+
+enum runTypes {
+  RUN_REFLOW = 0,
+  RUN_BAKE = 1,
+  RUN_OVENCHECK = 2
+};
+
+enum runResults {
+  RUN_COMPLETE = 0,
+  RUN_ABORTED = 1
+};
+
+typedef struct {
+  uint32_t magic;
+  uint16_t sequence;    // Run number, counts up forever
+  uint8_t type;         // runTypes
+  uint8_t result;       // runResults
+  uint8_t paste;        // Profile index, for reflows
+  uint8_t reserved;
+  uint16_t length;      // Bytes of tick data after the header
+  uint32_t ticks;       // Control ticks the run lasted
+  uint32_t duration;    // ms the run lasted
+  int16_t startTemp;    // 1/4 C
+  uint16_t crc;         // Over the header, with this set to 0, and the tick data
+  uint32_t reserved2;
+} RunHeader;
+
+class RunRecorder
+{
+  public:
+    RunRecorder( void );
+
+    // Start recording a new run, anything not yet ended is thrown away
+    void begin( uint8_t type, uint8_t paste );
+
+    // Add a control tick, ms is the control clock
+    void tick( unsigned long ms, float temp, float setpoint, uint8_t duty, bool fan, uint8_t tcStatus );
+
+    // Stop recording and keep the run in flash, this blocks for the flash writes
+    bool end( uint8_t result );
+
+    bool isRecording() const { return _recording; }
+
+    // Stored runs, oldest first
+    void list( Print &out );
+    bool dump( Print &out, uint16_t sequence );
+
+  private:
+    void put( uint8_t b );
+    void putVarint( long v );
+    void flushRepeats();
+
+    long findRun( uint16_t sequence ) const;
+    bool validRun( uint32_t offset, RunHeader &header ) const;
+
+    uint8_t _buf[RUNLOG_BUFFER];
+    uint16_t _len;
+    bool _recording;
+    bool _full;
+
+    uint8_t _step;
+    uint16_t _stepAt;
+    uint8_t _stepCount;
+    uint8_t _repeats;
+
+    unsigned long _startMs;
+    uint32_t _ticks;
+    long _lastTime;
+    long _lastTick;
+    long _lastTemp;
+    long _lastSet;
+    long _lastSlope;
+    uint8_t _lastDuty;
+    uint8_t _lastFlags;
+};
+
+#endif
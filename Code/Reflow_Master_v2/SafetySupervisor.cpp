@@ -0,0 +1,230 @@
+#include "SafetySupervisor.h"
+#include "TextBuffer.h"
+
+// The chip sets the low status bits, an all zero frame means nothing answered
+static uint8_t frameStatus( uint32_t frame )
+{
+  if ( frame == 0 )
+    return STATUS_NOREAD;
+  return frame & 0x0007;
+}
+
+// Thermocouple reading in 1/4C, before any offset or linearization
+static int16_t frameTemp( uint32_t frame )
+{
+  int16_t raw = ( frame >> 18 ) & 0x3FFF;
+  return ( raw & 0x2000 ) ? raw - 0x4000 : raw;
+}
+
+#if defined(ARDUINO_ARCH_SAMD)
+
+// The watchdog runs off OSCULP32K through GCLK2, divided by 2^(4+1) to 1024Hz
+static void watchdogStart()
+{
+  GCLK->GENDIV.reg = GCLK_GENDIV_ID( 2 ) | GCLK_GENDIV_DIV( 4 );
+  GCLK->GENCTRL.reg = GCLK_GENCTRL_ID( 2 ) | GCLK_GENCTRL_GENEN | GCLK_GENCTRL_SRC_OSCULP32K | GCLK_GENCTRL_DIVSEL;
+  while ( GCLK->STATUS.bit.SYNCBUSY );
+  GCLK->CLKCTRL.reg = GCLK_CLKCTRL_ID_WDT | GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK2;
+
+  WDT->CTRL.reg = 0;
+  while ( WDT->STATUS.bit.SYNCBUSY );
+
+  // 2048 cycles is SAFETY_WATCHDOG_TIME
+  WDT->CONFIG.reg = WDT_CONFIG_PER_2K;
+  WDT->CTRL.reg = WDT_CTRL_ENABLE;
+  while ( WDT->STATUS.bit.SYNCBUSY );
+}
+
+static void watchdogStop()
+{
+  WDT->CTRL.reg = 0;
+  while ( WDT->STATUS.bit.SYNCBUSY );
+}
+
+static void watchdogFeed()
+{
+  // Writing CLEAR again before the last one has synced stalls the bus, and one skipped is harmless
+  if ( !WDT->STATUS.bit.SYNCBUSY )
+    WDT->CLEAR.reg = WDT_CLEAR_CLEAR_KEY;
+}
+
+bool SafetySupervisor::wasWatchdogReset()
+{
+  return PM->RCAUSE.bit.WDT;
+}
+
+#else
+
+// No watchdog support, the interrupt side still cuts the relay
+static void watchdogStart() {}
+static void watchdogStop() {}
+static void watchdogFeed() {}
+
+bool SafetySupervisor::wasWatchdogReset()
+{
+  return false;
+}
+
+#endif
+
+SafetySupervisor::SafetySupervisor( SafetyCutoff cutoff )
+{
+  _cutoff = cutoff;
+  _sampleMicros = 100000;
+  _ceiling = 300 * 4;
+  _faultSamples = 1;
+  _control = 0;
+
+  _armed = false;
+  _trip = SAFETY_OK;
+  _tripStatus = STATUS_OK;
+  _faultCount = 0;
+  _hotCount = 0;
+  _faultStart = 0;
+  _hotStart = 0;
+
+  _lastLatency = 0;
+  _maxLatency = 0;
+  _trips = 0;
+}
+
+void SafetySupervisor::begin( uint16_t sampleRate, int16_t ceiling, uint8_t faultSamples )
+{
+  _sampleMicros = 1000000UL / max( sampleRate, (uint16_t)1 );
+  _ceiling = ceiling * 4;
+  _faultSamples = max( faultSamples, (uint8_t)1 );
+}
+
+void SafetySupervisor::arm( uint8_t controlChannel )
+{
+  noInterrupts();
+  _control = controlChannel;
+  _trip = SAFETY_OK;
+  _tripStatus = STATUS_OK;
+  _faultCount = 0;
+  _hotCount = 0;
+  _armed = true;
+  interrupts();
+
+  watchdogStart();
+}
+
+void SafetySupervisor::disarm()
+{
+  _armed = false;
+  watchdogStop();
+}
+
+void SafetySupervisor::check( const uint32_t frames[], uint8_t channels )
+{
+  if ( !_armed || _trip != SAFETY_OK )
+    return;
+
+  unsigned long now = micros();
+
+  // Only the probe being controlled on stops the run when it fails
+  uint8_t status = ( _control < channels ) ? frameStatus( frames[_control] ) : STATUS_NOREAD;
+  if ( status != STATUS_OK )
+  {
+    if ( _faultCount++ == 0 )
+      _faultStart = now;
+    if ( _faultCount >= _faultSamples )
+    {
+      trip( SAFETY_TC_FAULT, status, _faultStart );
+      return;
+    }
+  }
+  else
+  {
+    _faultCount = 0;
+  }
+
+  // But any probe that can be read counts for the ceiling
+  bool hot = false;
+  for ( uint8_t c = 0; c < channels; c++ )
+  {
+    if ( frameStatus( frames[c] ) == STATUS_OK && frameTemp( frames[c] ) >= _ceiling )
+      hot = true;
+  }
+
+  if ( hot )
+  {
+    if ( _hotCount++ == 0 )
+      _hotStart = now;
+    if ( _hotCount >= _faultSamples )
+      trip( SAFETY_OVER_TEMP, STATUS_OK, _hotStart );
+  }
+  else
+  {
+    _hotCount = 0;
+  }
+}
+
+void SafetySupervisor::checkStale( unsigned long sampleAge, unsigned long limit )
+{
+  if ( !_armed || _trip != SAFETY_OK || sampleAge <= limit )
+    return;
+
+  // The samples have stopped, so the fault started when the last good one was taken
+  noInterrupts();
+  if ( _trip == SAFETY_OK )
+    trip( SAFETY_TC_STALE, STATUS_NOREAD, micros() - sampleAge * 1000 );
+  interrupts();
+}
+
+void SafetySupervisor::feed()
+{
+  if ( _armed )
+    watchdogFeed();
+}
+
+void SafetySupervisor::trip( uint8_t reason, uint8_t status, unsigned long faultStart )
+{
+  // Relay first, everything else can wait
+  _cutoff();
+
+  _trip = reason;
+  _tripStatus = status;
+  _trips++;
+
+  _lastLatency = micros() - faultStart;
+  if ( _lastLatency > _maxLatency )
+    _maxLatency = _lastLatency;
+}
+
+const char *SafetySupervisor::tripName( uint8_t trip )
+{
+  switch ( trip )
+  {
+    case SAFETY_OK:
+      return "OK";
+    case SAFETY_TC_FAULT:
+      return "TC FAULT";
+    case SAFETY_TC_STALE:
+      return "TC STALE";
+    case SAFETY_OVER_TEMP:
+      return "OVER TEMP";
+  }
+  return "?";
+}
+
+void SafetySupervisor::print( Print &out ) const
+{
+  TextBuffer line;
+  line.add( "Safety " ).add( _armed ? "armed" : "off" ).add( ", " ).add( tripName( _trip ) );
+  if ( _trip == SAFETY_TC_FAULT )
+    line.add( " status " ).add( (unsigned)_tripStatus );
+  out.println( line.c_str() );
+
+  line.clear();
+  line.add( "Ceiling " ).add( _ceiling / 4 ).add( "c, trips after " ).add( (unsigned)_faultSamples ).add( " bad samples, bound " ).add( getBound() ).add( "us" );
+  out.println( line.c_str() );
+
+  line.clear();
+  line.add( "Trips " ).add( _trips ).add( " latency last " ).add( _lastLatency ).add( "us max " ).add( _maxLatency ).add( "us" );
+  out.println( line.c_str() );
+
+  line.clear();
+  line.add( "Watchdog " ).add( SAFETY_WATCHDOG_TIME ).add( "ms" ).add( wasWatchdogReset() ? ", last reset was the watchdog" : "" );
+  out.println( line.c_str() );
+}
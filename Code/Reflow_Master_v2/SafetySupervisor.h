@@ -0,0 +1,116 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Safety Supervisor
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Turns the heater off when the thermocouple can't be trusted, without waiting
+  for the control tick to notice.
+
+  check() looks at the raw MAX31855 frames from the sampler's timer interrupt,
+  as each burst is read. A fault status (open circuit, short to GND or VCC, or
+  no chip answering) on the probe being controlled on, or any probe reading
+  over the hard ceiling, for faultSamples samples in a row trips it. A trip
+  calls the cutoff function right there in the interrupt, so the relay is off
+  within faultSamples sample periods of the fault, whatever the main loop is
+  doing. checkStale() is called from the main loop, in case the samples stop
+  coming at all.
+
+  A trip is latched until the next arm(), the sketch aborts the run when it
+  sees it. While armed the SAMD21 watchdog is running too, and if the main loop
+  stops calling feed() the board resets, which lets the relay go.
+
+  The time from the first bad sample (or for a stale probe, the last good one)
+  to the cutoff returning is kept for every trip, so the latency can be checked
+  against the bound.
+  ---------------------------------------------------------------------------
+*/
+#ifndef SafetySupervisor_h
+#define SafetySupervisor_h
+
+#include <Arduino.h>
+#include "MAX31855.h"
+
+// Watchdog timeout in ms, longer than anything the main loop blocks for
+// Set by WDT_CONFIG_PER_2K in the .cpp, it can only be a power of 2 cycles at 1024Hz
+#define SAFETY_WATCHDOG_TIME 2000
+
+enum safetyTrips {
+  SAFETY_OK = 0,
+  SAFETY_TC_FAULT,
+  SAFETY_TC_STALE,
+  SAFETY_OVER_TEMP,
+};
+
+typedef void (*SafetyCutoff)(void);
+
+class SafetySupervisor
+{
+  public:
+    // cutoff must turn the relay off and be safe to call from an interrupt
+    SafetySupervisor( SafetyCutoff cutoff );
+
+    // sampleRate in Hz, ceiling in C on every probe, bad samples in a row that trip it
+    void begin( uint16_t sampleRate, int16_t ceiling, uint8_t faultSamples );
+
+    // Start watching for a run, clears the last trip and starts the watchdog
+    void arm( uint8_t controlChannel );
+
+    // The run is over, stops the watchdog, a trip stays latched
+    void disarm();
+
+    // From the sampler interrupt, the frames of the burst just read
+    void check( const uint32_t frames[], uint8_t channels );
+
+    // From the main loop, ms since the control probe's last good sample
+    void checkStale( unsigned long sampleAge, unsigned long limit );
+
+    // From the main loop, keeps the watchdog from resetting the board
+    void feed();
+
+    bool isArmed() const { return _armed; }
+    bool isTripped() const { return _trip != SAFETY_OK; }
+    uint8_t getTrip() const { return _trip; }
+    uint8_t getTripStatus() const { return _tripStatus; }
+
+    // Most time in us a fault can take to cut the relay, from when it's sampled
+    unsigned long getBound() const { return _faultSamples * _sampleMicros; }
+
+    // Time in us from the first bad sample to the relay being off
+    unsigned long getLastLatency() const { return _lastLatency; }
+    unsigned long getMaxLatency() const { return _maxLatency; }
+    unsigned long getTrips() const { return _trips; }
+
+    // True if the last reset was the watchdog's
+    static bool wasWatchdogReset();
+
+    static const char *tripName( uint8_t trip );
+
+    void print( Print &out ) const;
+
+  private:
+    SafetyCutoff _cutoff;
+    unsigned long _sampleMicros;
+    int16_t _ceiling; // 1/4C, the same as the chip
+    uint8_t _faultSamples;
+    uint8_t _control;
+
+    volatile bool _armed;
+    volatile uint8_t _trip;
+    volatile uint8_t _tripStatus;
+    uint8_t _faultCount;
+    uint8_t _hotCount;
+    unsigned long _faultStart;
+    unsigned long _hotStart;
+
+    volatile unsigned long _lastLatency;
+    volatile unsigned long _maxLatency;
+    volatile unsigned long _trips;
+
+    void trip( uint8_t reason, uint8_t status, unsigned long faultStart );
+};
+
+#endif
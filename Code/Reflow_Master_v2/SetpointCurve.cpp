@@ -0,0 +1,51 @@
+#include "SetpointCurve.h"
+#include <stdlib.h>
+
+// Number of spline values evaluated per batch when building the curve
+#define SETPOINT_BATCH 32
+
+SetpointCurve::SetpointCurve( void )
+{
+  _data = NULL;
+  _len = 0;
+  _capacity = 0;
+}
+
+SetpointCurve::~SetpointCurve()
+{
+  free( _data );
+}
+
+bool SetpointCurve::build( Spline &spline, int lengthSecs )
+{
+  int len = max( lengthSecs + 1, 1 );
+
+  // Only grow the table, so switching between profiles doesn't keep churning the heap
+  if ( len > _capacity )
+  {
+    int16_t* data = (int16_t*)realloc( _data, len * sizeof( int16_t ) );
+    if ( data == NULL )
+    {
+      // The old table is still there, but it's for another profile
+      _len = 0;
+      return false;
+    }
+
+    _data = data;
+    _capacity = len;
+  }
+  _len = len;
+
+  // Evaluate the spline in small batches to keep the stack use down
+  float batch[SETPOINT_BATCH];
+  for ( int i = 0; i < _len; i += SETPOINT_BATCH )
+  {
+    int count = min( _len - i, SETPOINT_BATCH );
+    spline.values( i, 1, batch, count );
+
+    for ( int j = 0; j < count; j++ )
+      _data[i + j] = (int16_t)round( batch[j] * SETPOINT_SCALE );
+  }
+
+  return true;
+}
@@ -0,0 +1,51 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Setpoint Curve
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Holds the wanted temperature for every second of the active profile.
+  Values are stored as fixed point int16 in 1/16 degree steps, and the table is
+  sized to the profile, so profile length is only limited by available RAM.
+  ---------------------------------------------------------------------------
+*/
+#ifndef SetpointCurve_h
+#define SetpointCurve_h
+
+#include <Arduino.h>
+#include "spline.h"
+
+// Fixed point scale of the stored values, 16 = 0.0625 degree resolution
+#define SETPOINT_SCALE 16
+
+class SetpointCurve
+{
+  public:
+    SetpointCurve( void );
+    ~SetpointCurve();
+
+    // Sample the spline once per second from 0 to lengthSecs inclusive
+    // Returns false if the table could not be allocated, the curve is left empty
+    bool build( Spline &spline, int lengthSecs );
+
+    // Wanted temperature at time t in seconds, clamped to the ends of the curve
+    float value( int t ) const
+    {
+      if ( _len == 0 )
+        return -1;
+
+      return (float)_data[ constrain( t, 0, _len - 1 ) ] / SETPOINT_SCALE;
+    }
+
+    int length() const { return _len; }
+
+  private:
+    int16_t* _data;
+    int _len;
+    int _capacity;
+};
+
+#endif
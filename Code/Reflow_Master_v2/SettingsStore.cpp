@@ -0,0 +1,265 @@
+#include "SettingsStore.h"
+#include "FlashStorage.h"
+#include "Telemetry.h"
+#include "TextBuffer.h"
+
+#define STORE_MAGIC 0x5352 // "RS"
+
+// Reserved flash for the journal, the same way FlashStorage reserves its space
+__attribute__((__aligned__(256)))
+static const uint8_t storeFlashData[STORE_SIZE] = { };
+static FlashClass storeFlash( storeFlashData, STORE_SIZE );
+
+static void readFlash( uint32_t offset, void *data, uint32_t size )
+{
+  storeFlash.read( storeFlashData + offset, data, size );
+}
+
+// Flash a record takes up, a whole number of pages
+static uint32_t recordSize( uint16_t length )
+{
+  return ( sizeof( StoreHeader ) + length + STORE_PAGE - 1 ) / STORE_PAGE * STORE_PAGE;
+}
+
+SettingsStore::SettingsStore( void )
+{
+  _bank = 0;
+  _end = 0;
+  _sequence = 0;
+  _writes = 0;
+  _erases = 0;
+}
+
+bool SettingsStore::validRecord( uint32_t offset, StoreHeader &header ) const
+{
+  readFlash( offset, &header, sizeof( StoreHeader ) );
+
+  if ( header.magic != STORE_MAGIC || header.key == 0 || header.key >= STORE_MAX_KEYS )
+    return false;
+
+  if ( sizeof( StoreHeader ) + header.length > STORE_RECORD_MAX || offset % STORE_BANK_SIZE + recordSize( header.length ) > STORE_BANK_SIZE )
+    return false;
+
+  // CRC over the header with the crc field zeroed, then the data
+  uint8_t record[STORE_RECORD_MAX];
+  readFlash( offset, record, sizeof( StoreHeader ) + header.length );
+  ( (StoreHeader*)record )->crc = 0;
+
+  return ( Telemetry::crc16( record, sizeof( StoreHeader ) + header.length ) == header.crc );
+}
+
+void SettingsStore::scanBank( uint8_t bank, long newest[], uint32_t sequence[], uint32_t &end )
+{
+  uint32_t base = bank * STORE_BANK_SIZE;
+  uint32_t pos = 0;
+  end = STORE_BANK_SIZE;
+
+  while ( pos < STORE_BANK_SIZE )
+  {
+    StoreHeader header;
+
+    if ( validRecord( base + pos, header ) )
+    {
+      if ( newest[header.key] < 0 || (int32_t)( header.sequence - sequence[header.key] ) > 0 )
+      {
+        newest[header.key] = base + pos;
+        sequence[header.key] = header.sequence;
+      }
+      pos += recordSize( header.length );
+    }
+    else
+    {
+      // An erased page is where the next record goes, anything else is a save that was cut short
+      uint32_t first;
+      readFlash( base + pos, &first, sizeof( first ) );
+      if ( first == 0xFFFFFFFF )
+      {
+        end = pos;
+        break;
+      }
+      pos += STORE_PAGE;
+    }
+  }
+}
+
+void SettingsStore::begin()
+{
+  long newest[2][STORE_MAX_KEYS];
+  uint32_t sequence[2][STORE_MAX_KEYS];
+  uint32_t end[2];
+
+  bool found = false;
+  _bank = 0;
+  _sequence = 0;
+
+  for ( uint8_t bank = 0; bank < 2; bank++ )
+  {
+    for ( uint8_t key = 0; key < STORE_MAX_KEYS; key++ )
+      newest[bank][key] = -1;
+
+    scanBank( bank, newest[bank], sequence[bank], end[bank] );
+
+    // The bank holding the newest record of all is the active one
+    for ( uint8_t key = 1; key < STORE_MAX_KEYS; key++ )
+    {
+      if ( newest[bank][key] >= 0 && ( !found || (int32_t)( sequence[bank][key] - _sequence ) > 0 ) )
+      {
+        found = true;
+        _sequence = sequence[bank][key];
+        _bank = bank;
+      }
+    }
+  }
+
+  _end = end[_bank];
+
+  // A bank move cut short leaves some records only in the old bank, so carry them over now
+  uint8_t other = 1 - _bank;
+  for ( uint8_t key = 1; key < STORE_MAX_KEYS; key++ )
+  {
+    if ( newest[_bank][key] < 0 && newest[other][key] >= 0 )
+    {
+      StoreHeader header;
+      uint8_t data[STORE_RECORD_MAX];
+      readFlash( newest[other][key], &header, sizeof( StoreHeader ) );
+      readFlash( newest[other][key] + sizeof( StoreHeader ), data, header.length );
+      append( key, data, header.length );
+    }
+  }
+}
+
+long SettingsStore::findNewest( uint8_t key )
+{
+  long newest[2][STORE_MAX_KEYS];
+  uint32_t sequence[2][STORE_MAX_KEYS];
+  uint32_t end;
+
+  for ( uint8_t bank = 0; bank < 2; bank++ )
+  {
+    for ( uint8_t k = 0; k < STORE_MAX_KEYS; k++ )
+      newest[bank][k] = -1;
+    scanBank( bank, newest[bank], sequence[bank], end );
+  }
+
+  if ( newest[0][key] < 0 )
+    return newest[1][key];
+  if ( newest[1][key] < 0 )
+    return newest[0][key];
+
+  return ( (int32_t)( sequence[1][key] - sequence[0][key] ) > 0 ) ? newest[1][key] : newest[0][key];
+}
+
+bool SettingsStore::read( uint8_t key, void *data, uint16_t size )
+{
+  if ( key == 0 || key >= STORE_MAX_KEYS )
+    return false;
+
+  long offset = findNewest( key );
+  if ( offset < 0 )
+    return false;
+
+  StoreHeader header;
+  readFlash( offset, &header, sizeof( StoreHeader ) );
+
+  // A different size means the record was saved by different firmware
+  if ( header.length != size )
+    return false;
+
+  readFlash( offset + sizeof( StoreHeader ), data, size );
+  return true;
+}
+
+bool SettingsStore::write( uint8_t key, const void *data, uint16_t size )
+{
+  if ( key == 0 || key >= STORE_MAX_KEYS || sizeof( StoreHeader ) + size > STORE_RECORD_MAX )
+    return false;
+
+  // Don't wear the flash saving what is already there
+  long offset = findNewest( key );
+  if ( offset >= 0 )
+  {
+    StoreHeader header;
+    uint8_t stored[STORE_RECORD_MAX];
+    readFlash( offset, &header, sizeof( StoreHeader ) );
+    readFlash( offset + sizeof( StoreHeader ), stored, header.length );
+
+    if ( header.length == size && memcmp( stored, data, size ) == 0 )
+      return true;
+  }
+
+  if ( _end + recordSize( size ) > STORE_BANK_SIZE )
+    moveBank( key );
+
+  return append( key, data, size );
+}
+
+bool SettingsStore::append( uint8_t key, const void *data, uint16_t size )
+{
+  uint32_t length = recordSize( size );
+  if ( _end + length > STORE_BANK_SIZE )
+    return false;
+
+  // Build the whole record so it goes to flash in one write, each page is only written once
+  uint8_t record[STORE_RECORD_MAX];
+  memset( record, 0xFF, sizeof( record ) );
+
+  StoreHeader *header = (StoreHeader*)record;
+  header->magic = STORE_MAGIC;
+  header->key = key;
+  header->reserved = 0;
+  header->length = size;
+  header->crc = 0;
+  header->sequence = ++_sequence;
+  memcpy( record + sizeof( StoreHeader ), data, size );
+  header->crc = Telemetry::crc16( record, sizeof( StoreHeader ) + size );
+
+  uint32_t offset = _bank * STORE_BANK_SIZE + _end;
+  storeFlash.write( storeFlashData + offset, record, length );
+  _end += length;
+  _writes++;
+
+  StoreHeader check;
+  return validRecord( offset, check );
+}
+
+void SettingsStore::moveBank( uint8_t skipKey )
+{
+  long newest[STORE_MAX_KEYS];
+  uint32_t sequence[STORE_MAX_KEYS];
+  uint32_t end;
+
+  for ( uint8_t key = 0; key < STORE_MAX_KEYS; key++ )
+    newest[key] = -1;
+  scanBank( _bank, newest, sequence, end );
+
+  _bank = 1 - _bank;
+  _end = 0;
+
+  storeFlash.erase( storeFlashData + _bank * STORE_BANK_SIZE, STORE_BANK_SIZE );
+  _erases++;
+
+  // Newest copy of everything else comes across, the old bank stays as it is until the next move
+  for ( uint8_t key = 1; key < STORE_MAX_KEYS; key++ )
+  {
+    if ( key == skipKey || newest[key] < 0 )
+      continue;
+
+    StoreHeader header;
+    uint8_t data[STORE_RECORD_MAX];
+    readFlash( newest[key], &header, sizeof( StoreHeader ) );
+    readFlash( newest[key] + sizeof( StoreHeader ), data, header.length );
+    append( key, data, header.length );
+  }
+}
+
+void SettingsStore::print( Print &out )
+{
+  TextBuffer line;
+  line.add( "Store bank " ).add( _bank ).add( " used " ).add( (unsigned long)_end ).add( "/" ).add( STORE_BANK_SIZE );
+  line.add( " seq " ).add( (unsigned long)_sequence );
+  out.println( line.c_str() );
+
+  TextBuffer since;
+  since.add( "Since boot writes " ).add( _writes ).add( " bank erases " ).add( _erases );
+  out.println( since.c_str() );
+}
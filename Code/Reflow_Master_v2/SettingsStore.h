@@ -0,0 +1,91 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Settings Store
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  A journal of small records in flash, used for the settings in place of
+  FlashStorage, which erased and rewrote the same row on every save. Settings
+  saved the old way aren't carried over, the first boot after an upgrade
+  starts from the defaults.
+
+  Saving appends a new copy of the record on the next free flash page, with a
+  sequence number and a CRC, and never touches the old copy. Loading picks the
+  newest copy that passes its CRC, so a save cut off by a power loss just leaves
+  the previous settings in place.
+
+  The area is split into two banks. When the active bank is full, the newest
+  copy of each record is moved into the other bank, which is the only time
+  anything is erased. Each row is erased once every few dozen saves, instead of
+  on every save, and a save is just a page write.
+
+  Each kind of record has its own key, so calibration data or the last used
+  profile can be kept here alongside the settings.
+  ---------------------------------------------------------------------------
+*/
+#ifndef SettingsStore_h
+#define SettingsStore_h
+
+#include <Arduino.h>
+
+// Two banks of 8 flash rows
+#define STORE_BANK_SIZE 2048
+#define STORE_SIZE ( STORE_BANK_SIZE * 2 )
+
+// Records are written a whole flash page at a time
+#define STORE_PAGE 64
+
+// Largest record, header included
+#define STORE_RECORD_MAX 256
+
+// Keys are 1 to STORE_MAX_KEYS - 1
+#define STORE_MAX_KEYS 8
+
+enum storeKeys {
+  STORE_SETTINGS = 1,
+  STORE_PROBES = 2
+};
+
+typedef struct {
+  uint16_t magic;
+  uint8_t key;
+  uint8_t reserved;
+  uint16_t length;      // Bytes of data after the header
+  uint16_t crc;         // Over the header, with this set to 0, and the data
+  uint32_t sequence;    // Counts up across both banks, newest wins
+} StoreHeader;
+
+class SettingsStore
+{
+  public:
+    SettingsStore( void );
+
+    // Find the active bank and where the next record goes, and finish a bank move cut short by a power loss
+    void begin();
+
+    // Newest valid copy of the record, false if there isn't one of that size
+    bool read( uint8_t key, void *data, uint16_t size );
+
+    // Append a new copy, unless it is the same as the newest one
+    bool write( uint8_t key, const void *data, uint16_t size );
+
+    void print( Print &out );
+
+  private:
+    bool validRecord( uint32_t offset, StoreHeader &header ) const;
+    void scanBank( uint8_t bank, long newest[], uint32_t sequence[], uint32_t &end );
+    long findNewest( uint8_t key );
+    bool append( uint8_t key, const void *data, uint16_t size );
+    void moveBank( uint8_t skipKey );
+
+    uint8_t _bank;
+    uint32_t _end;
+    uint32_t _sequence;
+    unsigned long _writes;
+    unsigned long _erases;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include "TCLinearize.h"
+#include "TCTables.h"
+
+static const TCTable tcTables[] = {
+  { 'K', tcColdK, tcInverseK, sizeof( tcInverseK ) / sizeof( tcInverseK[0] ), TC_SHIFT_K },
+  { 'J', tcColdJ, tcInverseJ, sizeof( tcInverseJ ) / sizeof( tcInverseJ[0] ), TC_SHIFT_J },
+  { 'T', tcColdT, tcInverseT, sizeof( tcInverseT ) / sizeof( tcInverseT[0] ), TC_SHIFT_T },
+  { 'E', tcColdE, tcInverseE, sizeof( tcInverseE ) / sizeof( tcInverseE[0] ), TC_SHIFT_E },
+  { 'N', tcColdN, tcInverseN, sizeof( tcInverseN ) / sizeof( tcInverseN[0] ), TC_SHIFT_N },
+};
+
+// Interpolate between the entries either side of x, the end segments carry on past the table
+template <typename T>
+static int32_t lookup( const T *table, uint8_t count, int32_t x, uint8_t shift )
+{
+  int32_t i = x >> shift;
+  if ( i < 0 )
+    i = 0;
+  else if ( i > count - 2 )
+    i = count - 2;
+
+  int32_t frac = x - ( i << shift );
+  return table[i] + ( ( ( table[i + 1] - table[i] ) * frac + ( 1 << ( shift - 1 ) ) ) >> shift );
+}
+
+const TCTable *TCTableFor( char type )
+{
+  for ( uint8_t i = 0; i < sizeof( tcTables ) / sizeof( tcTables[0] ); i++ )
+  {
+    if ( tcTables[i].type == type )
+      return &tcTables[i];
+  }
+  return NULL;
+}
+
+int32_t TCLinearize( const TCTable &table, int16_t reading, int16_t coldJunction )
+{
+  // The thermocouple's own voltage, then the cold junction's added back on
+  int32_t quv = ( ( (int32_t)reading * 4 - coldJunction ) * TC_CHIP_SENS + ( 1 << 9 ) ) >> 10;
+  quv += lookup( table.cold, TC_COLD_COUNT, coldJunction, TC_COLD_SHIFT );
+
+  return lookup( table.inverse, table.inverseCount, quv, table.inverseShift );
+}
+
+int16_t TCChipReading( const TCTable &table, int32_t temp, int16_t coldJunction )
+{
+  // Find the segment the temp is in, the inverse table only goes up
+  uint8_t i = 0;
+  while ( i < table.inverseCount - 2 && temp >= table.inverse[i + 1] )
+    i++;
+
+  int32_t span = table.inverse[i + 1] - table.inverse[i];
+  int32_t quv = ( (int32_t)i << table.inverseShift ) + ( ( temp - table.inverse[i] ) << table.inverseShift ) / span;
+  quv -= lookup( table.cold, TC_COLD_COUNT, coldJunction, TC_COLD_SHIFT );
+
+  // Back to what the chip would show in 1/16C, then its 1/4C steps
+  int32_t sixteenths = coldJunction + ( quv * 1024 + TC_CHIP_SENS / 2 ) / TC_CHIP_SENS;
+  return ( sixteenths + 2 ) >> 2;
+}
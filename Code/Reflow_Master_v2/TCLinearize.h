@@ -0,0 +1,45 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Thermocouple Linearization
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Takes a MAX31855 reading back to the NIST ITS-90 curve for the thermocouple.
+
+  The chip reports (thermocouple uV / 41.276) + cold junction, as though every
+  thermocouple were linear at type K's room temperature slope. That puts a type
+  K probe a few degrees out at reflow temperatures, and other types much more.
+  Here the thermocouple voltage is worked back out of the reading, the cold
+  junction's voltage is added, and the total is looked up in the inverse table.
+
+  The tables are made by Code/Tools/tc_tables.py from the NIST polynomials,
+  and checked against them there. A reading costs two table interpolations and
+  a handful of integer multiplies, no floating point.
+  ---------------------------------------------------------------------------
+*/
+#ifndef TCLinearize_h
+#define TCLinearize_h
+
+#include <Arduino.h>
+
+typedef struct {
+  char type;
+  const int32_t *cold;    // 1/4 uV at the cold junction
+  const int16_t *inverse; // 1/64C for the total 1/4 uV
+  uint8_t inverseCount;
+  uint8_t inverseShift;
+} TCTable;
+
+// Table for a thermocouple type letter, NULL if there isn't one
+const TCTable *TCTableFor( char type );
+
+// Hot junction temp in 1/64C, from a reading in 1/4C and the cold junction in 1/16C
+int32_t TCLinearize( const TCTable &table, int16_t reading, int16_t coldJunction );
+
+// The other way, the reading in 1/4C the chip gives for a temp in 1/64C, for the oven simulator
+int16_t TCChipReading( const TCTable &table, int32_t temp, int16_t coldJunction );
+
+#endif
@@ -0,0 +1,224 @@
+#include "TCSampler.h"
+
+#if defined(ARDUINO_ARCH_SAMD)
+// Called from the timer interrupt
+static TCSamplerCallback timerCallback = NULL;
+#endif
+
+TCSampler::TCSampler( MAX31855 *tcs[], uint8_t channels )
+{
+  _tcs = tcs;
+  _channels = min( channels, (uint8_t)TCSAMPLER_CHANNELS );
+  _head = 0;
+  _tail = 0;
+  _dropped = 0;
+  _alpha = 0.3;
+  _sampleFunc = NULL;
+  _watcher = NULL;
+  _interval = 0;
+  _nextPoll = 0;
+
+  reset();
+}
+
+void TCSampler::reset()
+{
+  for ( uint8_t c = 0; c < TCSAMPLER_CHANNELS; c++ )
+  {
+    TCChannel &ch = _ch[c];
+    ch.windowPos = 0;
+    ch.windowCount = 0;
+    ch.historyPos = 0;
+    ch.median = 0;
+    ch.filtered = 0;
+    ch.status = STATUS_NOREAD;
+    ch.goodCount = 0;
+    ch.lastGoodTime = 0;
+
+    for ( int i = 0; i < TCSAMPLER_HISTORY; i++ )
+      ch.history[i] = STATUS_NOREAD;
+  }
+}
+
+void TCSampler::begin( uint16_t rate, TCSamplerCallback sampleFunc )
+{
+  _sampleFunc = sampleFunc;
+  _interval = 1000 / max( rate, (uint16_t)1 );
+  startTimer( rate );
+}
+
+void TCSampler::poll()
+{
+#if !defined(ARDUINO_ARCH_SAMD)
+  if ( _sampleFunc != NULL && (long)( millis() - _nextPoll ) >= 0 )
+  {
+    _nextPoll = millis() + _interval;
+    _sampleFunc();
+  }
+#endif
+}
+
+bool TCSampler::sample( unsigned long time )
+{
+  uint32_t frames[TCSAMPLER_CHANNELS];
+
+  // Back to back, so all the channels are read within a few us of each other
+  for ( uint8_t c = 0; c < _channels; c++ )
+    frames[c] = _tcs[c]->readFrame();
+
+  return push( frames, time );
+}
+
+bool TCSampler::push( const uint32_t frames[], unsigned long time )
+{
+  if ( _watcher != NULL )
+    _watcher( frames, _channels );
+
+  uint8_t head = _head;
+  uint8_t next = ( head + 1 ) & ( TCSAMPLER_BUFFER - 1 );
+
+  if ( next == _tail )
+  {
+    _dropped++;
+    return false;
+  }
+
+  for ( uint8_t c = 0; c < _channels; c++ )
+    _frames[head][c] = frames[c];
+  _times[head] = time;
+
+  // Publish the slot only after it has been filled in
+  _head = next;
+  return true;
+}
+
+void TCSampler::update()
+{
+  while ( _tail != _head )
+  {
+    uint8_t tail = _tail;
+    unsigned long time = _times[tail];
+
+    for ( uint8_t c = 0; c < _channels; c++ )
+    {
+      TCChannel &ch = _ch[c];
+      MAX31855 &tc = *_tcs[c];
+
+      ch.status = tc.decode( _frames[tail][c] );
+
+      ch.history[ch.historyPos] = ch.status;
+      ch.historyPos = ( ch.historyPos + 1 ) % TCSAMPLER_HISTORY;
+
+      if ( ch.status == STATUS_OK )
+      {
+        tc.getInternal(); // required by the TC to get the correct compensated value back
+        addGood( ch, tc.getTemperature(), time );
+      }
+    }
+
+    // Only free the slot once every channel is out of it
+    _tail = ( tail + 1 ) & ( TCSAMPLER_BUFFER - 1 );
+  }
+}
+
+void TCSampler::addGood( TCChannel &ch, float temp, unsigned long time )
+{
+  ch.window[ch.windowPos] = temp;
+  ch.windowPos = ( ch.windowPos + 1 ) % TCSAMPLER_MEDIAN;
+  if ( ch.windowCount < TCSAMPLER_MEDIAN )
+    ch.windowCount++;
+
+  // Insertion sort a copy of the window, it's tiny
+  float sorted[TCSAMPLER_MEDIAN];
+  for ( int i = 0; i < ch.windowCount; i++ )
+  {
+    float v = ch.window[i];
+    int j = i - 1;
+    while ( j >= 0 && sorted[j] > v )
+    {
+      sorted[j + 1] = sorted[j];
+      j--;
+    }
+    sorted[j + 1] = v;
+  }
+
+  if ( ch.windowCount & 1 )
+    ch.median = sorted[ch.windowCount / 2];
+  else
+    ch.median = ( sorted[ch.windowCount / 2 - 1] + sorted[ch.windowCount / 2] ) / 2;
+
+  // Seed the IIR filter with the first reading so it doesn't ramp up from 0
+  if ( ch.goodCount == 0 )
+    ch.filtered = ch.median;
+  else
+    ch.filtered += _alpha * ( ch.median - ch.filtered );
+
+  ch.goodCount++;
+  ch.lastGoodTime = time;
+}
+
+uint8_t TCSampler::getStatusHistory( int ago, uint8_t ch ) const
+{
+  if ( ago < 0 || ago >= TCSAMPLER_HISTORY )
+    return STATUS_NOREAD;
+
+  return _ch[ch].history[ ( _ch[ch].historyPos + TCSAMPLER_HISTORY - 1 - ago ) % TCSAMPLER_HISTORY ];
+}
+
+int TCSampler::getFaultCount( uint8_t ch ) const
+{
+  int count = 0;
+  for ( int i = 0; i < TCSAMPLER_HISTORY; i++ )
+  {
+    if ( _ch[ch].history[i] != STATUS_OK && _ch[ch].history[i] != STATUS_NOREAD )
+      count++;
+  }
+  return count;
+}
+
+#if defined(ARDUINO_ARCH_SAMD)
+
+// TC4 is free on the SAMD21, tone() uses TC5 but shares the same GCLK0 clock
+void TCSampler::startTimer( uint16_t rate )
+{
+  timerCallback = _sampleFunc;
+
+  GCLK->CLKCTRL.reg = (uint16_t)( GCLK_CLKCTRL_CLKEN | GCLK_CLKCTRL_GEN_GCLK0 | GCLK_CLKCTRL_ID_TC4_TC5 );
+  while ( GCLK->STATUS.bit.SYNCBUSY );
+
+  TC4->COUNT16.CTRLA.reg &= ~TC_CTRLA_ENABLE;
+  while ( TC4->COUNT16.STATUS.bit.SYNCBUSY );
+
+  // 48MHz / 1024 ticks, reset the count on a match with CC0
+  TC4->COUNT16.CTRLA.reg = TC_CTRLA_MODE_COUNT16 | TC_CTRLA_WAVEGEN_MFRQ | TC_CTRLA_PRESCALER_DIV1024;
+  while ( TC4->COUNT16.STATUS.bit.SYNCBUSY );
+
+  TC4->COUNT16.CC[0].reg = (uint16_t)( ( SystemCoreClock / 1024 ) / max( rate, (uint16_t)1 ) - 1 );
+  while ( TC4->COUNT16.STATUS.bit.SYNCBUSY );
+
+  TC4->COUNT16.INTENSET.reg = TC_INTENSET_MC0;
+  NVIC_SetPriority( TC4_IRQn, 2 );
+  NVIC_EnableIRQ( TC4_IRQn );
+
+  TC4->COUNT16.CTRLA.reg |= TC_CTRLA_ENABLE;
+  while ( TC4->COUNT16.STATUS.bit.SYNCBUSY );
+}
+
+void TC4_Handler()
+{
+  TC4->COUNT16.INTFLAG.reg = TC_INTFLAG_MC0;
+
+  if ( timerCallback != NULL )
+    timerCallback();
+}
+
+#else
+
+// No hardware timer support, poll() drives the sampling instead
+void TCSampler::startTimer( uint16_t rate )
+{
+  (void)rate;
+  _nextPoll = millis();
+}
+
+#endif
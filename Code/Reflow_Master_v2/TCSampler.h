@@ -0,0 +1,135 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Thermocouple Sampler
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Samples the thermocouple from a hardware timer, independent of how long the
+  main loop spends drawing the UI.
+
+  The timer interrupt only clocks the raw MAX31855 frames out and pushes them into
+  a single producer / single consumer ring buffer. The main loop calls update() to
+  decode the frames, run them through a median filter to reject glitches, and then
+  an IIR low pass filter to smooth what is left.
+
+  Several MAX31855 can share the clock and data lines, each with its own CS. They
+  are read back to back in one burst per sample, so every channel in a slot of the
+  ring buffer was taken at the same moment. Each channel is decoded with its own
+  chip's offset and TCfactor, and keeps its own filters and fault history.
+  ---------------------------------------------------------------------------
+*/
+#ifndef TCSampler_h
+#define TCSampler_h
+
+#include <Arduino.h>
+#include "MAX31855.h"
+
+// Ring buffer size, must be a power of 2
+#define TCSAMPLER_BUFFER 16
+// Number of good samples the median is taken over
+#define TCSAMPLER_MEDIAN 5
+// Number of sample statuses kept for the fault history
+#define TCSAMPLER_HISTORY 32
+// Most MAX31855 read in one burst
+#define TCSAMPLER_CHANNELS 4
+
+typedef void (*TCSamplerCallback)(void);
+typedef void (*TCFrameWatcher)( const uint32_t frames[], uint8_t channels );
+
+typedef struct {
+  float window[TCSAMPLER_MEDIAN];
+  uint8_t windowPos;
+  uint8_t windowCount;
+
+  uint8_t history[TCSAMPLER_HISTORY];
+  uint8_t historyPos;
+
+  float median;
+  float filtered;
+  uint8_t status;
+  unsigned long goodCount;
+  unsigned long lastGoodTime;
+} TCChannel;
+
+class TCSampler
+{
+  public:
+    // One chip per channel, all on the same clock and data lines
+    TCSampler( MAX31855 *tcs[], uint8_t channels );
+
+    // Start calling sampleFunc at rate Hz from a hardware timer interrupt
+    // sampleFunc should call sample(), or push() frames of its own
+    void begin( uint16_t rate, TCSamplerCallback sampleFunc );
+
+    // Only needed on boards without hardware timer support, calls sampleFunc when due
+    void poll();
+
+    // Producer side, safe to call from an interrupt
+    // Reads a frame from every chip in one burst and pushes them
+    bool sample( unsigned long time );
+
+    // One frame per channel, returns false and counts a drop if the buffer is full
+    bool push( const uint32_t frames[], unsigned long time );
+
+    // Called with every burst as it's pushed, from the interrupt, even when the buffer is full
+    void setWatcher( TCFrameWatcher watcher ) { _watcher = watcher; }
+
+    // Consumer side, decode and filter all frames pushed since the last call
+    void update();
+
+    // Clear the filters and fault history
+    void reset();
+
+    // Weight given to each new median value by the IIR filter, 0-1
+    void setSmoothing( float alpha ) { _alpha = constrain( alpha, 0.0f, 1.0f ); }
+
+    uint8_t getChannels() const { return _channels; }
+
+    // True once at least one good sample has been decoded
+    bool hasReading( uint8_t ch = 0 ) const { return _ch[ch].goodCount > 0; }
+
+    float getMedian( uint8_t ch = 0 ) const { return _ch[ch].median; }
+    float getFiltered( uint8_t ch = 0 ) const { return _ch[ch].filtered; }
+
+    // Status of the newest sample
+    uint8_t getStatus( uint8_t ch = 0 ) const { return _ch[ch].status; }
+
+    // Status of the sample ago samples back, 0 is the newest
+    uint8_t getStatusHistory( int ago, uint8_t ch = 0 ) const;
+
+    // Number of failed reads in the fault history
+    int getFaultCount( uint8_t ch = 0 ) const;
+
+    // Time in ms since the newest good sample was taken
+    unsigned long getSampleAge( unsigned long now, uint8_t ch = 0 ) const { return now - _ch[ch].lastGoodTime; }
+
+    // Frames lost because the consumer fell behind
+    unsigned long getDropped() const { return _dropped; }
+
+  private:
+    MAX31855 **_tcs;
+    uint8_t _channels;
+
+    // Ring buffer, head is only written by the producer and tail by the consumer
+    uint32_t _frames[TCSAMPLER_BUFFER][TCSAMPLER_CHANNELS];
+    unsigned long _times[TCSAMPLER_BUFFER];
+    volatile uint8_t _head;
+    volatile uint8_t _tail;
+    volatile unsigned long _dropped;
+
+    TCChannel _ch[TCSAMPLER_CHANNELS];
+    float _alpha;
+
+    TCSamplerCallback _sampleFunc;
+    TCFrameWatcher _watcher;
+    unsigned long _interval;
+    unsigned long _nextPoll;
+
+    void addGood( TCChannel &ch, float temp, unsigned long time );
+    void startTimer( uint16_t rate );
+};
+
+#endif
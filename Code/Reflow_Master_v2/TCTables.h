@@ -0,0 +1,80 @@
+/*
+  Generated by Code/Tools/tc_tables.py, don't edit, run it again instead
+
+  NIST ITS-90 thermocouple tables for TCLinearize.cpp
+  cj is 1/4 uV every 8C from 0C, inv is 1/64C every 2^shift 1/4 uV from 0uV up to 500C
+  (type T to 400C)
+*/
+#ifndef TCTables_h
+#define TCTables_h
+
+// (reading - cold junction) in 1/16C * TC_CHIP_SENS >> 10 is 1/4 uV, the chip assumes 41.276uV/C
+#define TC_CHIP_SENS 10567
+
+// Cold junction tables, 2^TC_COLD_SHIFT 1/16C steps
+#define TC_COLD_COUNT 17
+#define TC_COLD_SHIFT 7
+
+// Type K, lookups within 0.036C of the NIST polynomials
+static const int32_t tcColdK[17] = { 0, 1268, 2548, 3839, 5139, 6447, 7763, 9084, 10409, 11737, 13067, 14396, 15723, 17046, 18366, 19680, 20988 };
+static const int16_t tcInverseK[82] = {
+  0, 411, 821, 1230, 1637, 2041, 2443, 2843, 3241, 3637, 4032, 4426,
+  4820, 5213, 5607, 6002, 6398, 6794, 7193, 7592, 7993, 8395, 8799, 9204,
+  9611, 10018, 10427, 10836, 11245, 11655, 12065, 12475, 12885, 13294, 13702, 14110,
+  14517, 14924, 15329, 15733, 16136, 16538, 16939, 17339, 17737, 18135, 18532, 18928,
+  19323, 19718, 20112, 20505, 20898, 21290, 21682, 22073, 22464, 22855, 23246, 23636,
+  24025, 24415, 24804, 25192, 25580, 25968, 26356, 26743, 27129, 27516, 27902, 28287,
+  28673, 29058, 29444, 29829, 30214, 30599, 30984, 31369, 31753, 32135,
+};
+#define TC_SHIFT_K 10
+
+// Type J, lookups within 0.031C of the NIST polynomials
+static const int32_t tcColdJ[17] = { 0, 1620, 3254, 4902, 6563, 8235, 9919, 11612, 13315, 15027, 16746, 18473, 20207, 21946, 23691, 25441, 27196 };
+static const int16_t tcInverseJ[55] = {
+  0, 645, 1284, 1917, 2545, 3168, 3787, 4402, 5013, 5621, 6226, 6828,
+  7429, 8027, 8623, 9218, 9812, 10405, 10997, 11588, 12178, 12769, 13359, 13948,
+  14538, 15128, 15718, 16309, 16899, 17490, 18082, 18673, 19265, 19858, 20451, 21044,
+  21637, 22231, 22825, 23419, 24013, 24608, 25202, 25796, 26390, 26983, 27576, 28169,
+  28761, 29352, 29942, 30531, 31119, 31705, 32291,
+};
+#define TC_SHIFT_J 11
+
+// Type T, lookups within 0.033C of the NIST polynomials
+static const int32_t tcColdT[17] = { 0, 1249, 2517, 3805, 5115, 6447, 7801, 9177, 10574, 11992, 13431, 14890, 16368, 17865, 19380, 20914, 22465 };
+static const int16_t tcInverseT[83] = {
+  0, 422, 837, 1247, 1651, 2050, 2444, 2833, 3218, 3598, 3973, 4345,
+  4713, 5077, 5438, 5796, 6150, 6501, 6849, 7194, 7536, 7876, 8214, 8548,
+  8881, 9211, 9539, 9865, 10189, 10510, 10830, 11148, 11465, 11779, 12092, 12403,
+  12713, 13020, 13327, 13632, 13935, 14237, 14538, 14837, 15135, 15432, 15727, 16022,
+  16315, 16607, 16897, 17187, 17475, 17763, 18049, 18335, 18619, 18902, 19185, 19466,
+  19747, 20027, 20306, 20584, 20861, 21137, 21413, 21688, 21962, 22235, 22507, 22779,
+  23050, 23321, 23590, 23859, 24128, 24395, 24662, 24928, 25194, 25458, 25722,
+};
+#define TC_SHIFT_T 10
+
+// Type E, lookups within 0.037C of the NIST polynomials
+static const int32_t tcColdE[17] = { 0, 1889, 3801, 5737, 7696, 9679, 11685, 13715, 15767, 17842, 19939, 22058, 24198, 26359, 28539, 30740, 32959 };
+static const int16_t tcInverseE[74] = {
+  0, 555, 1103, 1643, 2177, 2704, 3225, 3739, 4249, 4752, 5251, 5745,
+  6234, 6719, 7199, 7676, 8148, 8617, 9083, 9546, 10005, 10462, 10915, 11366,
+  11815, 12261, 12706, 13148, 13588, 14026, 14462, 14896, 15329, 15761, 16190, 16619,
+  17046, 17472, 17896, 18320, 18742, 19163, 19584, 20003, 20421, 20839, 21255, 21671,
+  22086, 22500, 22914, 23326, 23739, 24150, 24561, 24971, 25381, 25791, 26199, 26608,
+  27016, 27423, 27831, 28237, 28644, 29050, 29456, 29862, 30268, 30673, 31078, 31483,
+  31888, 32293,
+};
+#define TC_SHIFT_E 11
+
+// Type N, lookups within 0.038C of the NIST polynomials
+static const int32_t tcColdN[17] = { 0, 834, 1676, 2528, 3388, 4258, 5138, 6027, 6927, 7836, 8755, 9685, 10623, 11572, 12530, 13498, 14475 };
+static const int16_t tcInverseN[67] = {
+  0, 629, 1250, 1862, 2466, 3062, 3651, 4232, 4806, 5374, 5935, 6489,
+  7038, 7581, 8119, 8652, 9179, 9702, 10221, 10735, 11245, 11751, 12253, 12751,
+  13247, 13739, 14228, 14713, 15197, 15677, 16155, 16630, 17103, 17574, 18042, 18509,
+  18973, 19436, 19896, 20355, 20812, 21268, 21722, 22174, 22625, 23074, 23522, 23969,
+  24414, 24858, 25301, 25742, 26183, 26622, 27060, 27497, 27934, 28369, 28803, 29236,
+  29669, 30100, 30531, 30961, 31390, 31819, 32247,
+};
+#define TC_SHIFT_N 10
+
+#endif
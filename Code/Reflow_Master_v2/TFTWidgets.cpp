@@ -0,0 +1,253 @@
+#include "TFTWidgets.h"
+
+// Column and page address commands plus their 4 data bytes each, then the memory write command
+#define TFT_WINDOW_BYTES 11
+
+TFTStats tftStats;
+
+static unsigned long frameStartBytes = 0;
+static unsigned long frameStartMicros = 0;
+
+void TFTFrameBegin()
+{
+  frameStartBytes = tftStats.bytes;
+  frameStartMicros = micros();
+}
+
+void TFTFrameEnd()
+{
+  tftStats.frames++;
+  tftStats.frameBytes = tftStats.bytes - frameStartBytes;
+  tftStats.frameMicros = micros() - frameStartMicros;
+
+  if ( tftStats.frameMicros > tftStats.maxFrameMicros )
+    tftStats.maxFrameMicros = tftStats.frameMicros;
+}
+
+void TFTResetStats()
+{
+  tftStats = TFTStats();
+}
+
+unsigned long TFTFillBytes( int16_t w, int16_t h )
+{
+  if ( w <= 0 || h <= 0 )
+    return 0;
+
+  return TFT_WINDOW_BYTES + 2UL * w * h;
+}
+
+unsigned long TFTGlyphBytes( uint8_t size )
+{
+  // drawChar() sends every font pixel on its own, each as a size x size rect, then fills the spacing column
+  if ( size <= 1 )
+    return 6 * 8 * ( TFT_WINDOW_BYTES + 2 );
+
+  return 5 * 8 * TFTFillBytes( size, size ) + TFTFillBytes( size, 8 * size );
+}
+
+TFTLabel::TFTLabel( int16_t x, int16_t y, uint8_t size, uint16_t color, uint16_t bg, uint8_t align )
+{
+  _x = x;
+  _y = y;
+  _size = max( size, (uint8_t)1 );
+  _align = align;
+  _color = color;
+  _bg = bg;
+  _text[0] = 0;
+  _dirty = false;
+
+  forget();
+}
+
+void TFTLabel::setText( const char *text )
+{
+  if ( strncmp( _text, text, TFTWIDGET_MAX_CHARS ) == 0 )
+    return;
+
+  strncpy( _text, text, TFTWIDGET_MAX_CHARS );
+  _text[TFTWIDGET_MAX_CHARS] = 0;
+  _dirty = true;
+}
+
+void TFTLabel::setColor( uint16_t color, uint16_t bg )
+{
+  if ( color == _color && bg == _bg )
+    return;
+
+  _color = color;
+  _bg = bg;
+  _dirty = true;
+}
+
+void TFTLabel::moveTo( int16_t x, int16_t y )
+{
+  if ( x == _x && y == _y )
+    return;
+
+  _x = x;
+  _y = y;
+  _dirty = true;
+}
+
+void TFTLabel::print( Adafruit_ILI9341 &d, const char *text )
+{
+  setText( text );
+  draw( d );
+}
+
+void TFTLabel::print( Adafruit_ILI9341 &d, const char *text, uint16_t color, uint16_t bg )
+{
+  setColor( color, bg );
+  setText( text );
+  draw( d );
+}
+
+int16_t TFTLabel::originX( int len ) const
+{
+  int16_t w = len * 6 * _size;
+
+  if ( _align == ALIGN_CENTER )
+    return _x - w / 2 + 2;
+  else if ( _align == ALIGN_RIGHT )
+    return _x + ( 18 - w );
+
+  return _x;
+}
+
+int16_t TFTLabel::originY() const
+{
+  if ( _align == ALIGN_LEFT )
+    return _y;
+
+  return _y - ( 8 * _size ) / 2;
+}
+
+void TFTLabel::fill( Adafruit_ILI9341 &d, int16_t x, int16_t w, uint16_t color )
+{
+  if ( w <= 0 )
+    return;
+
+  d.fillRect( x, _shownY, w, 8 * _size, color );
+  tftStats.bytes += TFTFillBytes( w, 8 * _size );
+}
+
+void TFTLabel::draw( Adafruit_ILI9341 &d )
+{
+  if ( !_dirty )
+    return;
+
+  int16_t cell = 6 * _size;
+  int newLen = strlen( _text );
+  int oldLen = strlen( _shown );
+  int16_t newX = originX( newLen );
+  int16_t newY = originY();
+
+  // If the text moved or changed colour every cell has to be redrawn
+  bool redrawAll = ( newX != _shownX || newY != _shownY || _color != _shownColor || _bg != _shownBg );
+
+  if ( oldLen > 0 && ( newX != _shownX || newY != _shownY || _bg != _shownBg ) )
+  {
+    int16_t oldEnd = _shownX + oldLen * cell;
+    int16_t newEnd = newX + newLen * cell;
+
+    if ( newY != _shownY || newLen == 0 )
+    {
+      fill( d, _shownX, oldEnd - _shownX, _shownBg );
+    }
+    else
+    {
+      // Only erase the parts of the old text the new text won't cover
+      fill( d, _shownX, min( oldEnd, newX ) - _shownX, _shownBg );
+      int16_t from = max( _shownX, newEnd );
+      fill( d, from, oldEnd - from, _shownBg );
+    }
+  }
+  else if ( oldLen > newLen )
+  {
+    // Same place, clear the cells past the end of the shorter text
+    fill( d, newX + newLen * cell, ( oldLen - newLen ) * cell, _bg );
+  }
+
+  _shownY = newY;
+
+  for ( int i = 0; i < newLen; i++ )
+  {
+    if ( !redrawAll && i < oldLen && _shown[i] == _text[i] )
+    {
+      tftStats.glyphsSkipped++;
+      continue;
+    }
+
+    d.drawChar( newX + i * cell, newY, _text[i], _color, _bg, _size );
+    tftStats.bytes += TFTGlyphBytes( _size );
+    tftStats.glyphs++;
+  }
+
+  strcpy( _shown, _text );
+  _shownX = newX;
+  _shownColor = _color;
+  _shownBg = _bg;
+  _dirty = false;
+}
+
+void TFTLabel::clear( Adafruit_ILI9341 &d )
+{
+  int oldLen = strlen( _shown );
+  if ( oldLen > 0 )
+    fill( d, _shownX, oldLen * 6 * _size, _shownBg );
+
+  _text[0] = 0;
+  forget();
+}
+
+void TFTLabel::forget()
+{
+  _shown[0] = 0;
+  _shownX = originX( 0 );
+  _shownY = originY();
+  _shownColor = _color;
+  _shownBg = _bg;
+
+  // Anything set still needs to go out
+  _dirty = ( _text[0] != 0 );
+}
+
+TFTButtonHint::TFTButtonHint( int16_t posY, int16_t barWidth, int16_t barHeight )
+  : _label( 0, posY + 9, 2, ILI9341_WHITE, ILI9341_BLACK, ALIGN_RIGHT )
+{
+  _posY = posY;
+  _barWidth = barWidth;
+  _barHeight = barHeight;
+  _barColor = ILI9341_BLACK;
+  _barShown = false;
+}
+
+void TFTButtonHint::set( const char *label, uint16_t color )
+{
+  if ( color != _barColor )
+  {
+    _barColor = color;
+    _barShown = false;
+  }
+  _label.setText( label );
+}
+
+void TFTButtonHint::draw( Adafruit_ILI9341 &d )
+{
+  if ( !_barShown )
+  {
+    d.fillRect( d.width() - 5, _posY, _barWidth, _barHeight, _barColor );
+    tftStats.bytes += TFTFillBytes( _barWidth, _barHeight );
+    _barShown = true;
+  }
+
+  _label.moveTo( d.width() - 27, _posY + 9 );
+  _label.draw( d );
+}
+
+void TFTButtonHint::forget()
+{
+  _barShown = false;
+  _label.forget();
+}
@@ -0,0 +1,126 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - TFT Widgets
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Retained text widgets for the ILI9341. Each widget remembers what it last put
+  on the panel, so setting the same text again costs nothing, and changing the
+  text only redraws the glyph cells that are different.
+
+  Screens that clear the panel with fillScreen() must call forget() on their
+  widgets, so they know the panel under them is blank again.
+
+  The Adafruit library doesn't count what it sends, so the SPI bytes in
+  tftStats are worked out from how it draws each glyph and rect.
+  ---------------------------------------------------------------------------
+*/
+#ifndef TFTWidgets_h
+#define TFTWidgets_h
+
+#include <Arduino.h>
+#include "Adafruit_ILI9341.h"
+
+// Longest text a widget can hold
+#define TFTWIDGET_MAX_CHARS 20
+
+enum widgetAlign {
+  ALIGN_LEFT = 0,
+  ALIGN_CENTER = 1, // Same placement as println_Center()
+  ALIGN_RIGHT = 2   // Same placement as println_Right()
+};
+
+typedef struct {
+  unsigned long frames = 0;
+  unsigned long bytes = 0;          // Total bytes sent
+  unsigned long frameBytes = 0;     // Bytes sent in the last frame
+  unsigned long frameMicros = 0;    // Time spent drawing in the last frame
+  unsigned long maxFrameMicros = 0;
+  unsigned long glyphs = 0;         // Glyph cells drawn
+  unsigned long glyphsSkipped = 0;  // Glyph cells that were already on the panel
+} TFTStats;
+
+extern TFTStats tftStats;
+
+// Wrap each screen update in these to get the per frame counters
+void TFTFrameBegin();
+void TFTFrameEnd();
+void TFTResetStats();
+
+// Bytes the Adafruit library sends for a fillRect() or a glyph drawn with a background
+unsigned long TFTFillBytes( int16_t w, int16_t h );
+unsigned long TFTGlyphBytes( uint8_t size );
+
+class TFTLabel
+{
+  public:
+    // For centered and right aligned labels x,y is the anchor point, as for println_Center() and println_Right()
+    TFTLabel( int16_t x, int16_t y, uint8_t size, uint16_t color, uint16_t bg, uint8_t align = ALIGN_LEFT );
+
+    // These only mark the label dirty, nothing is sent until draw()
+    void setText( const char *text );
+    void setColor( uint16_t color, uint16_t bg );
+    void moveTo( int16_t x, int16_t y );
+
+    // Push the changed glyph cells to the panel
+    void draw( Adafruit_ILI9341 &d );
+
+    // Set and draw in one go
+    void print( Adafruit_ILI9341 &d, const char *text );
+    void print( Adafruit_ILI9341 &d, const char *text, uint16_t color, uint16_t bg );
+
+    // Erase what the label has on the panel
+    void clear( Adafruit_ILI9341 &d );
+
+    // The panel was cleared, so nothing of the label is showing any more
+    void forget();
+
+    bool isDirty() const { return _dirty; }
+    const char* getText() const { return _text; }
+
+  private:
+    int16_t originX( int len ) const;
+    int16_t originY() const;
+    void fill( Adafruit_ILI9341 &d, int16_t x, int16_t w, uint16_t color );
+
+    int16_t _x;
+    int16_t _y;
+    uint8_t _size;
+    uint8_t _align;
+    uint16_t _color;
+    uint16_t _bg;
+
+    char _text[TFTWIDGET_MAX_CHARS + 1];
+    bool _dirty;
+
+    // What is on the panel right now
+    char _shown[TFTWIDGET_MAX_CHARS + 1];
+    int16_t _shownX;
+    int16_t _shownY;
+    uint16_t _shownColor;
+    uint16_t _shownBg;
+};
+
+// The coloured bar and label next to one of the 4 buttons
+class TFTButtonHint
+{
+  public:
+    TFTButtonHint( int16_t posY, int16_t barWidth, int16_t barHeight );
+
+    void set( const char *label, uint16_t color );
+    void draw( Adafruit_ILI9341 &d );
+    void forget();
+
+  private:
+    int16_t _posY;
+    int16_t _barWidth;
+    int16_t _barHeight;
+    uint16_t _barColor;
+    bool _barShown;
+    TFTLabel _label;
+};
+
+#endif
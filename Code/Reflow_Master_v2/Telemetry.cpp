@@ -0,0 +1,103 @@
+#include "Telemetry.h"
+
+static void put16( uint8_t *p, uint16_t v )
+{
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void put32( uint8_t *p, uint32_t v )
+{
+  put16( p, v & 0xFFFF );
+  put16( p + 2, v >> 16 );
+}
+
+// Fixed point with rounding, clamped so a wild value can't wrap around
+static int16_t toFixed16( float v, float scale )
+{
+  float f = v * scale;
+  f = constrain( f, -32768.0f, 32767.0f );
+  return (int16_t)( f >= 0 ? f + 0.5f : f - 0.5f );
+}
+
+Telemetry::Telemetry( Print &out ) : _out( out )
+{
+  _sequence = 0;
+  _sent = 0;
+}
+
+uint16_t Telemetry::crc16( const uint8_t *data, size_t len, uint16_t crc )
+{
+  for ( size_t i = 0; i < len; i++ )
+  {
+    crc ^= (uint16_t)data[i] << 8;
+    for ( uint8_t b = 0; b < 8; b++ )
+      crc = ( crc & 0x8000 ) ? ( crc << 1 ) ^ 0x1021 : ( crc << 1 );
+  }
+  return crc;
+}
+
+size_t Telemetry::cobsEncode( const uint8_t *in, size_t len, uint8_t *out )
+{
+  // Each code byte says how far it is to the next 0, the 0s themselves are dropped
+  size_t codePos = 0;
+  size_t outPos = 1;
+  uint8_t code = 1;
+
+  for ( size_t i = 0; i < len; i++ )
+  {
+    if ( in[i] == 0 )
+    {
+      out[codePos] = code;
+      codePos = outPos++;
+      code = 1;
+    }
+    else
+    {
+      out[outPos++] = in[i];
+      code++;
+
+      if ( code == 0xFF )
+      {
+        out[codePos] = code;
+        codePos = outPos++;
+        code = 1;
+      }
+    }
+  }
+
+  out[codePos] = code;
+  return outPos;
+}
+
+void Telemetry::send( const TelemetryRecord &record )
+{
+  uint8_t raw[TELEMETRY_RECORD_SIZE + 2];
+
+  raw[0] = TELEMETRY_VERSION;
+  raw[1] = _sequence++;
+  raw[2] = record.state;
+  raw[3] = record.flags;
+  put32( raw + 4, record.millis );
+  put32( raw + 8, (uint32_t)(int32_t)( record.timeX * 100 + 0.5f ) );
+  put16( raw + 12, (uint16_t)toFixed16( record.currentTemp, 16 ) );
+  put16( raw + 14, (uint16_t)toFixed16( record.wantedTemp, 16 ) );
+  raw[16] = record.duty;
+  raw[17] = record.tcError;
+  raw[18] = record.control;
+
+  for ( uint8_t i = 0; i < TELEMETRY_PROBES; i++ )
+  {
+    int16_t temp = isnan( record.probes[i] ) ? TELEMETRY_NO_PROBE : toFixed16( record.probes[i], 16 );
+    put16( raw + 19 + i * 2, (uint16_t)temp );
+  }
+
+  put16( raw + TELEMETRY_RECORD_SIZE, crc16( raw, TELEMETRY_RECORD_SIZE ) );
+
+  uint8_t frame[TELEMETRY_FRAME_MAX];
+  size_t len = cobsEncode( raw, sizeof( raw ), frame );
+  frame[len++] = 0;
+
+  _out.write( frame, len );
+  _sent++;
+}
@@ -0,0 +1,86 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Telemetry
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  One small binary record per control tick, in place of the ASCII debug trace.
+
+  Each record is packed little endian, a CRC-16/CCITT-FALSE of the record is
+  added on the end, then the lot is COBS encoded and ended with a 0 byte. A 0
+  never shows up inside a frame, so a reader can start anywhere in the stream
+  and sync up on the next 0.
+
+  Record layout, version 2, 27 bytes:
+    0  uint8   version
+    1  uint8   sequence, wraps, gaps mean lost records
+    2  uint8   state
+    3  uint8   flags, bit 0 fan on, bit 1 past the cutoff
+    4  uint32  ms since boot
+    8  int32   timeX in 1/100 s
+    12 int16   current temp in 1/16 C
+    14 int16   wanted temp in 1/16 C
+    16 uint8   SSR duty 0-255
+    17 uint8   TC error status
+    18 uint8   probe the temp is controlled on
+    19 int16   probe 0-3 temps in 1/16 C, -32768 if not fitted or faulty
+
+  Version 1 records stop after byte 17 and only had the one probe.
+
+  Code/Tools/telemetry_decode.py turns a captured stream into CSV.
+  ---------------------------------------------------------------------------
+*/
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include <Arduino.h>
+
+#define TELEMETRY_VERSION 2
+#define TELEMETRY_RECORD_SIZE 27
+#define TELEMETRY_PROBES 4
+#define TELEMETRY_NO_PROBE -32768
+
+// Record plus CRC, plus COBS overhead and the 0 at the end
+#define TELEMETRY_FRAME_MAX ( TELEMETRY_RECORD_SIZE + 2 + 2 + 1 )
+
+#define TELEMETRY_FLAG_FAN 0x01
+#define TELEMETRY_FLAG_CUTOFF 0x02
+
+typedef struct {
+  uint8_t state = 0;
+  uint8_t flags = 0;
+  unsigned long millis = 0;
+  float timeX = 0;
+  float currentTemp = 0;
+  float wantedTemp = 0;
+  uint8_t duty = 0;
+  uint8_t tcError = 0;
+  uint8_t control = 0;
+  float probes[TELEMETRY_PROBES] = { NAN, NAN, NAN, NAN };
+} TelemetryRecord;
+
+class Telemetry
+{
+  public:
+    Telemetry( Print &out );
+
+    // Frame the record and write it in a single write() call
+    void send( const TelemetryRecord &record );
+
+    unsigned long getSent() const { return _sent; }
+
+    // Exposed so they can be checked against the decoder
+    // Pass the last result back in as crc to carry on over more data
+    static uint16_t crc16( const uint8_t *data, size_t len, uint16_t crc = 0xFFFF );
+    static size_t cobsEncode( const uint8_t *in, size_t len, uint8_t *out );
+
+  private:
+    Print &_out;
+    uint8_t _sequence;
+    unsigned long _sent;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "TempController.h"
+
+#define DUTY_MAX 256
+
+HeuristicController::HeuristicController( void )
+{
+  reset( 0 );
+}
+
+void HeuristicController::reset( float current )
+{
+  _lastWanted = -1;
+  _lastTemp = current;
+}
+
+float HeuristicController::update( const ControlInput &in )
+{
+  // How much the profile wants to move versus how much the oven actually moved
+  float wantedDiff = ( in.wantedAhead - _lastWanted );
+  _lastWanted = in.wantedAhead;
+
+  float tempDiff = ( in.current - _lastTemp );
+  _lastTemp = in.current;
+
+  float perc = wantedDiff - tempDiff;
+
+  float delta = ( in.wantedAhead - in.current );
+  float base = 128;
+
+  if ( delta >= 0 )
+    base = 128 + ( delta * 5 );
+  else
+    base = 32 + ( delta * 15 );
+
+  base = constrain( base, 0, DUTY_MAX );
+
+  float duty = base + ( 172 * perc );
+  return constrain( duty, 0, DUTY_MAX );
+}
+
+PIDController::PIDController( void )
+{
+  setTunings( PID_DEFAULT_KP, PID_DEFAULT_KI, PID_DEFAULT_KD, PID_DEFAULT_KFF );
+  reset( 0 );
+}
+
+void PIDController::setTunings( float kp, float ki, float kd, float kff )
+{
+  _kp = kp;
+  _ki = ki;
+  _kd = kd;
+  _kff = kff;
+}
+
+void PIDController::reset( float current )
+{
+  _integral = 0;
+  _lastTemp = current;
+}
+
+float PIDController::update( const ControlInput &in )
+{
+  float dt = max( in.dt, 0.001f );
+  float error = in.wanted - in.current;
+
+  // Feedforward the duty needed to follow the profile slope, so the PID only has to correct the error
+  float slope = ( in.lookAhead > 0 ) ? ( in.wantedAhead - in.wanted ) / in.lookAhead : 0;
+  float feedforward = _kff * max( slope, 0.0f );
+
+  // Derivative on the measurement rather than the error, so steps in the profile don't kick the output
+  float derivative = -_kd * ( in.current - _lastTemp ) / dt;
+  _lastTemp = in.current;
+
+  float unclamped = feedforward + ( _kp * error ) + _integral + derivative;
+
+  // Anti-windup, only integrate when the output isn't already saturated in the direction of the error
+  if ( !( unclamped >= DUTY_MAX && error > 0 ) && !( unclamped <= 0 && error < 0 ) )
+    _integral = constrain( _integral + _ki * error * dt, 0, DUTY_MAX );
+
+  float duty = feedforward + ( _kp * error ) + _integral + derivative;
+  return constrain( duty, 0, DUTY_MAX );
+}
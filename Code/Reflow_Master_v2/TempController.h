@@ -0,0 +1,86 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Temperature Controllers
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  MatchTemp() hands the current and wanted temperatures to one of these each
+  control tick and gets back the SSR duty cycle to apply, 0-256.
+
+  HeuristicController is the original Reflow Master rate matching, tuned for a
+  1 second control tick.
+  PIDController is a PID on the error with feedforward from the slope of the
+  profile, and anti-windup on the integral.
+  ---------------------------------------------------------------------------
+*/
+#ifndef TempController_h
+#define TempController_h
+
+#include <Arduino.h>
+
+// The PID tunings a controller and the settings start from
+#define PID_DEFAULT_KP 20
+#define PID_DEFAULT_KI 0.2
+#define PID_DEFAULT_KD 30
+#define PID_DEFAULT_KFF 250
+
+enum controllers {
+  CONTROLLER_HEURISTIC = 0,
+  CONTROLLER_PID = 1
+};
+
+struct ControlInput
+{
+  float current;     // Measured temperature
+  float wanted;      // Profile temperature now
+  float wantedAhead; // Profile temperature lookAhead seconds from now
+  float lookAhead;   // Seconds between wanted and wantedAhead
+  float dt;          // Seconds since the last update
+};
+
+class TempController
+{
+  public:
+    // Called before a run starts with the current oven temperature
+    virtual void reset( float current ) = 0;
+
+    // Returns the duty cycle, 0-256
+    virtual float update( const ControlInput &in ) = 0;
+};
+
+class HeuristicController : public TempController
+{
+  public:
+    HeuristicController( void );
+    void reset( float current );
+    float update( const ControlInput &in );
+
+  private:
+    float _lastWanted;
+    float _lastTemp;
+};
+
+class PIDController : public TempController
+{
+  public:
+    PIDController( void );
+    void reset( float current );
+    float update( const ControlInput &in );
+
+    void setTunings( float kp, float ki, float kd, float kff );
+
+    float getIntegral() const { return _integral; }
+
+  private:
+    float _kp;
+    float _ki;
+    float _kd;
+    float _kff;
+    float _integral;
+    float _lastTemp;
+};
+
+#endif
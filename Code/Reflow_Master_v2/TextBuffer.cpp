@@ -0,0 +1,152 @@
+#include "TextBuffer.h"
+#include <math.h>
+
+TextBuffer::TextBuffer( void )
+{
+  clear();
+}
+
+TextBuffer& TextBuffer::clear()
+{
+  _len = 0;
+  _buf[0] = 0;
+  _overflow = false;
+  return *this;
+}
+
+TextBuffer& TextBuffer::add( char c )
+{
+  if ( _len < TEXTBUFFER_SIZE - 1 )
+  {
+    _buf[_len++] = c;
+    _buf[_len] = 0;
+  }
+  else
+  {
+    _overflow = true;
+  }
+  return *this;
+}
+
+TextBuffer& TextBuffer::add( const char *text )
+{
+  while ( *text )
+    add( *text++ );
+  return *this;
+}
+
+TextBuffer& TextBuffer::addDigits( unsigned long value, uint8_t minDigits )
+{
+  // Digits come out backwards, so build them in a scratch buffer first
+  char digits[10];
+  uint8_t count = 0;
+
+  do
+  {
+    digits[count++] = '0' + ( value % 10 );
+    value /= 10;
+  }
+  while ( value > 0 && count < sizeof( digits ) );
+
+  while ( count < minDigits && count < sizeof( digits ) )
+    digits[count++] = '0';
+
+  while ( count > 0 )
+    add( digits[--count] );
+
+  return *this;
+}
+
+TextBuffer& TextBuffer::add( long value )
+{
+  if ( value < 0 )
+  {
+    add( '-' );
+    return addDigits( 0UL - (unsigned long)value, 1 );
+  }
+  return addDigits( value, 1 );
+}
+
+TextBuffer& TextBuffer::add( unsigned long value )
+{
+  return addDigits( value, 1 );
+}
+
+TextBuffer& TextBuffer::add( int value )
+{
+  return add( (long)value );
+}
+
+TextBuffer& TextBuffer::add( unsigned int value )
+{
+  return add( (unsigned long)value );
+}
+
+TextBuffer& TextBuffer::add( double value, uint8_t decimals )
+{
+  if ( isnan( value ) )
+    return add( "nan" );
+  if ( isinf( value ) )
+    return add( "inf" );
+
+  decimals = min( decimals, (uint8_t)6 );
+
+  double scale = 1;
+  for ( uint8_t i = 0; i < decimals; i++ )
+    scale *= 10;
+
+  // Too big to go through a long
+  if ( fabs( value ) * scale > 2147483647.0 )
+    return add( "ovf" );
+
+  long fixed = (long)( fabs( value ) * scale + 0.5 );
+  if ( value < 0 && fixed != 0 )
+    add( '-' );
+
+  return addFixed( fixed, decimals );
+}
+
+TextBuffer& TextBuffer::addFixed( long value, uint8_t decimals )
+{
+  if ( value < 0 )
+  {
+    add( '-' );
+    value = -value;
+  }
+
+  unsigned long scale = 1;
+  for ( uint8_t i = 0; i < decimals; i++ )
+    scale *= 10;
+
+  addDigits( value / scale, 1 );
+
+  if ( decimals > 0 )
+  {
+    add( '.' );
+    addDigits( value % scale, decimals );
+  }
+  return *this;
+}
+
+TextBuffer& TextBuffer::addDuration( long seconds )
+{
+  if ( seconds < 0 )
+  {
+    add( '-' );
+    seconds = -seconds;
+  }
+
+  if ( seconds >= 3600 )
+  {
+    addDigits( seconds / 3600, 1 );
+    add( ':' );
+    addDigits( ( seconds / 60 ) % 60, 2 );
+  }
+  else
+  {
+    addDigits( seconds / 60, 1 );
+  }
+
+  add( ':' );
+  return addDigits( seconds % 60, 2 );
+}
@@ -0,0 +1,63 @@
+/*
+  ---------------------------------------------------------------------------
+  Reflow Master Control - Text Buffer
+
+  AUTHOR/LICENSE:
+  Created by Seon Rozenblum - seon@unexpectedmaker.com
+  Copyright 2016 License: GNU GPL v3 http://www.gnu.org/licenses/gpl-3.0.html
+
+  PURPOSE:
+  Fixed size text building for the UI and debug output, in place of String
+  concatenation. Every String + allocates on the heap, and doing that every
+  tick for hours fragments the heap until an allocation fails.
+
+  Text that doesn't fit is cut off, and overflowed() says so.
+
+  TextBuffer t;
+  t.add( round( currentTemp ) ).add( "/" ).add( wanted ).add( "c" );
+  println_Center( tft, t.c_str(), x, y );
+  ---------------------------------------------------------------------------
+*/
+#ifndef TextBuffer_h
+#define TextBuffer_h
+
+#include <Arduino.h>
+
+#define TEXTBUFFER_SIZE 64
+
+class TextBuffer
+{
+  public:
+    TextBuffer( void );
+
+    TextBuffer& clear();
+
+    TextBuffer& add( const char *text );
+    TextBuffer& add( char c );
+    TextBuffer& add( int value );
+    TextBuffer& add( unsigned int value );
+    TextBuffer& add( long value );
+    TextBuffer& add( unsigned long value );
+
+    // Rounded to the number of decimals, same as String( value, decimals )
+    TextBuffer& add( double value, uint8_t decimals = 2 );
+
+    // value is a fixed point number with that many decimal places, 1234 with 1 decimal is 123.4
+    TextBuffer& addFixed( long value, uint8_t decimals );
+
+    // m:ss, or h:mm:ss once it gets to an hour
+    TextBuffer& addDuration( long seconds );
+
+    const char* c_str() const { return _buf; }
+    int length() const { return _len; }
+    bool overflowed() const { return _overflow; }
+
+  private:
+    TextBuffer& addDigits( unsigned long value, uint8_t minDigits );
+
+    char _buf[TEXTBUFFER_SIZE];
+    uint8_t _len;
+    bool _overflow;
+};
+
+#endif
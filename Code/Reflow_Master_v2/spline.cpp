@@ -1,39 +1,46 @@
 #include "spline.h"
 #include <math.h>
+#include <stddef.h>
 
 Spline::Spline(void) {
+  _x = NULL;
+  _y = NULL;
+  _m = NULL;
+  _degree = 1;
+  _length = 0;
   _prev_point = 0;
 }
 
-Spline::Spline( float x[], float y[], int numPoints, int degree )
+Spline::Spline( const float x[], const float y[], int numPoints, int degree )
 {
+  _degree = degree;
   setPoints(x, y, numPoints);
-  setDegree(degree);
   _prev_point = 0;
 }
 
-Spline::Spline( float x[], float y[], float m[], int numPoints )
+Spline::Spline( const float x[], const float y[], const float m[], int numPoints )
 {
+  _degree = Hermite;
   setPoints(x, y, m, numPoints);
-  setDegree(Hermite);
   _prev_point = 0;
 }
 
-void Spline::setPoints( float x[], float y[], int numPoints ) {
-  _x = x;
-  _y = y;
-  _length = numPoints;
+void Spline::setPoints( const float x[], const float y[], int numPoints ) {
+  setPoints(x, y, NULL, numPoints);
 }
 
-void Spline::setPoints( float x[], float y[], float m[], int numPoints ) {
+void Spline::setPoints( const float x[], const float y[], const float m[], int numPoints ) {
   _x = x;
   _y = y;
   _m = m;
-  _length = numPoints;
+  _length = numPoints > SPLINE_MAX_POINTS ? SPLINE_MAX_POINTS : numPoints;
+  _prev_point = 0;
+  buildCoefficients();
 }
 
 void Spline::setDegree( int degree ) {
   _degree = degree;
+  buildCoefficients();
 }
 
 float Spline::value( float x )
@@ -44,68 +51,111 @@ float Spline::value( float x )
   else if ( _x[_length - 1] < x ) {
     return _y[_length - 1];
   }
-  else {
-    for (int i = 0; i < _length; i++ )
-    {
-      int index = ( i + _prev_point ) % _length;
-
-      if ( _x[index] == x ) {
-        _prev_point = index;
-        return _y[index];
-      } else if ( (_x[index] < x) && (x < _x[index + 1]) ) {
-        _prev_point = index;
-        return calc( x, index );
-      }
-    }
+
+  int i = segment( x );
+  if ( _x[i] == x ) {
+    return _y[i];
   }
-  return _y[0];
+  return eval( x, i );
 }
 
-float Spline::calc( float x, int i )
+void Spline::values( float xStart, float xStep, float out[], int count )
 {
-  switch ( _degree ) {
-    case 0:
-      return _y[i];
-    case 1:
-      if ( _x[i] == _x[i + 1] ) {
-        // Avoids division by 0
-        return _y[i];
-      } else {
-        return _y[i] + (_y[i + 1] - _y[i]) * ( x - _x[i]) / ( _x[i + 1] - _x[i] );
-      }
-    case Hermite:
-      return hermite( ((x - _x[i]) / (_x[i + 1] - _x[i])), _y[i], _y[i + 1], _m[i], _m[i + 1], _x[i], _x[i + 1] );
-    case Catmull:
-      if ( i == 0 ) {
-        // x prior to spline start - first point used to determine tangent
-        return _y[1];
-      } else if ( i == _length - 2 ) {
-        // x after spline end - last point used to determine tangent
-        return _y[_length - 2];
-      } else {
-        float t = (x - _x[i]) / (_x[i + 1] - _x[i]);
-        float m0 = (i == 0 ? 0 : catmull_tangent(i) );
-        float m1 = (i == _length - 1 ? 0 : catmull_tangent(i + 1) );
-        return hermite( t, _y[i], _y[i + 1], m0, m1, _x[i], _x[i + 1]);
-      }
+  // Consecutive samples mostly land in the same or next segment, so the cursor
+  // in segment() keeps the lookup O(1) across the whole run
+  for ( int n = 0; n < count; n++ ) {
+    out[n] = value( xStart + xStep * n );
   }
-  return _y[i];
 }
 
-float Spline::hermite( float t, float p0, float p1, float m0, float m1, float x0, float x1 ) {
-  return (hermite_00(t) * p0) + (hermite_10(t) * (x1 - x0) * m0) + (hermite_01(t) * p1) + (hermite_11(t) * (x1 - x0) * m1);
-}
-float Spline::hermite_00( float t ) {
-  return (2 * pow(t, 3)) - (3 * pow(t, 2)) + 1;
-}
-float Spline::hermite_10( float t ) {
-  return pow(t, 3) - (2 * pow(t, 2)) + t;
+// Find the last point at or before x, x must be within the spline range
+int Spline::segment( float x )
+{
+  // Check the previous segment and the one after it first
+  for ( int i = _prev_point; i < _length && i <= _prev_point + 1; i++ ) {
+    if ( _x[i] <= x && ( i == _length - 1 || x < _x[i + 1] ) ) {
+      _prev_point = i;
+      return i;
+    }
+  }
+
+  // Otherwise binary search for it
+  int lo = 0;
+  int hi = _length - 1;
+  while ( lo < hi ) {
+    int mid = ( lo + hi + 1 ) / 2;
+    if ( _x[mid] <= x )
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  _prev_point = lo;
+  return lo;
 }
-float Spline::hermite_01( float t ) {
-  return (3 * pow(t, 2)) - (2 * pow(t, 3));
+
+float Spline::eval( float x, int i )
+{
+  float t = ( x - _x[i] ) * _invDx[i];
+  const float* c = _c[i];
+  return c[0] + t * ( c[1] + t * ( c[2] + t * c[3] ) );
 }
-float Spline::hermite_11( float t ) {
-  return pow(t, 3) - pow(t, 2);
+
+void Spline::buildCoefficients()
+{
+  for ( int i = 0; i < _length - 1; i++ )
+  {
+    float dx = _x[i + 1] - _x[i];
+    float* c = _c[i];
+
+    _invDx[i] = ( dx == 0 ) ? 0 : 1 / dx;
+
+    c[0] = _y[i];
+    c[1] = 0;
+    c[2] = 0;
+    c[3] = 0;
+
+    float m0 = 0;
+    float m1 = 0;
+
+    switch ( _degree ) {
+      case 0:
+        continue;
+      case 1:
+        // Avoids division by 0 as _invDx is 0 for a zero width segment
+        c[1] = _y[i + 1] - _y[i];
+        continue;
+      case Hermite:
+        if ( _m != NULL ) {
+          m0 = _m[i];
+          m1 = _m[i + 1];
+        }
+        break;
+      case Catmull:
+        if ( i == 0 ) {
+          // x prior to spline start - first point used to determine tangent
+          c[0] = _y[1];
+          continue;
+        } else if ( i == _length - 2 ) {
+          // x after spline end - last point used to determine tangent
+          c[0] = _y[_length - 2];
+          continue;
+        }
+        m0 = catmull_tangent(i);
+        m1 = catmull_tangent(i + 1);
+        break;
+      default:
+        continue;
+    }
+
+    // Hermite basis expanded into a cubic in t
+    float p0 = _y[i];
+    float p1 = _y[i + 1];
+    m0 *= dx;
+    m1 *= dx;
+    c[1] = m0;
+    c[2] = ( 3 * ( p1 - p0 ) ) - ( 2 * m0 ) - m1;
+    c[3] = ( 2 * ( p0 - p1 ) ) + m0 + m1;
+  }
 }
 
 float Spline::catmull_tangent( int i )
@@ -116,4 +166,4 @@ float Spline::catmull_tangent( int i )
   } else {
     return (_y[i + 1] - _y[i - 1]) / (_x[i + 1] - _x[i - 1]);
   }
-}
\ No newline at end of file
+}
@@ -2,37 +2,47 @@
   Library for 1-d splines
   Copyright Ryan Michael
   Licensed under the LGPLv3
+
+  Cubic coefficients for each segment are precomputed when the points or degree
+  change, so value() is a segment lookup plus a Horner evaluation.
 */
 #ifndef spline_h
 #define spline_h
 #define Hermite 10
 #define Catmull 11
 
+// Maximum number of points a spline can hold
+#define SPLINE_MAX_POINTS 16
+
 class Spline
 {
   public:
     Spline( void );
-    Spline( float x[], float y[], int numPoints, int degree = 1 );
-    Spline( float x[], float y[], float m[], int numPoints );
+    Spline( const float x[], const float y[], int numPoints, int degree = 1 );
+    Spline( const float x[], const float y[], const float m[], int numPoints );
     float value( float x );
-    void setPoints( float x[], float y[], int numPoints );
-    void setPoints( float x[], float y[], float m[], int numPoints );
+    // Fill out[] with count values starting at xStart, xStep apart
+    void values( float xStart, float xStep, float out[], int count );
+    void setPoints( const float x[], const float y[], int numPoints );
+    void setPoints( const float x[], const float y[], const float m[], int numPoints );
     void setDegree( int degree );
 
   private:
-    float calc( float, int);
-    float* _x;
-    float* _y;
-    float* _m;
+    int segment( float x );
+    float eval( float x, int i );
+    void buildCoefficients();
+    const float* _x;
+    const float* _y;
+    const float* _m;
     int _degree;
     int _length;
     int _prev_point;
 
-    float hermite( float t, float p0, float p1, float m0, float m1, float x0, float x1 );
-    float hermite_00( float t );
-    float hermite_10( float t );
-    float hermite_01( float t );
-    float hermite_11( float t );
+    // Per segment cubic in t = ( x - x[i] ) * _invDx[i]
+    // y = _c[i][0] + t * ( _c[i][1] + t * ( _c[i][2] + t * _c[i][3] ) )
+    float _c[SPLINE_MAX_POINTS - 1][4];
+    float _invDx[SPLINE_MAX_POINTS - 1];
+
     float catmull_tangent( int i );
 };
 
@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+"""
+Reflow Master profile compiler
+
+Turns a solder paste profile into the 128 byte record the Reflow Master keeps
+in flash, and the serial command that uploads it. See ProfileStore.h in the
+sketch for the record layout.
+
+A profile is JSON:
+  {"name": "MY PASTE", "type": "Sn63/Pb37", "liquidus": 183,
+   "points": [[1, 25], [90, 150], [180, 175], [225, 210], [240, 210],
+              [270, 125], [300, 50]]}
+
+or CSV, one time,temp[,tangent] row per point:
+  # name: MY PASTE
+  # type: Sn63/Pb37
+  # liquidus: 183
+  1,25
+  90,150
+  ...
+
+Optional "tangents" (C/s at each point), "fan" and "off" (seconds) can be given
+as well, in JSON or as "# fan:" and "# off:" lines. Without them the curve
+starts with a slope of 1 and is flat through every other point, the fan comes
+on at the third from last point and the heat goes off at the second from last,
+the same as the built in profiles.
+
+Upload straight to the board:
+  python3 profile_compile.py mypaste.json --port /dev/ttyACM0
+
+Or print the command, and/or save the record:
+  python3 profile_compile.py mypaste.csv --bin mypaste.bin
+
+Once uploaded, PROFILES lists it and it shows up on the paste screen.
+"""
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x5052
+VERSION = 1
+POINTS = 10
+NAME_SIZE = 24
+TYPE_SIZE = 32
+# Times are uint16 seconds in the record
+MAX_TIME = 65535
+
+# Everything but the CRC on the end
+RECORD = struct.Struct("<HBBHHH%ds%ds%dH%dh%dh" % (NAME_SIZE, TYPE_SIZE, POINTS, POINTS, POINTS))
+RECORD_SIZE = RECORD.size + 2
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def load_json(text):
+    src = json.loads(text)
+    profile = {
+        "name": src["name"],
+        "type": src.get("type", ""),
+        "liquidus": src["liquidus"],
+        "time": [float(p[0]) for p in src["points"]],
+        "temp": [float(p[1]) for p in src["points"]],
+    }
+    for key in ("tangents", "fan", "off"):
+        if key in src:
+            profile[key] = src[key]
+    return profile
+
+
+def load_csv(text):
+    profile = {"type": "", "time": [], "temp": []}
+    tangents = []
+
+    for line in text.splitlines():
+        line = line.strip()
+        if not line:
+            continue
+        if line.startswith("#"):
+            key, _, value = line[1:].partition(":")
+            key = key.strip().lower()
+            value = value.strip()
+            if key in ("name", "type"):
+                profile[key] = value
+            elif key in ("liquidus", "fan", "off"):
+                profile[key] = float(value)
+            continue
+
+        cols = [c.strip() for c in line.split(",")]
+        try:
+            profile["time"].append(float(cols[0]))
+            profile["temp"].append(float(cols[1]))
+        except ValueError:
+            continue  # a heading row
+        if len(cols) > 2 and cols[2]:
+            tangents.append(float(cols[2]))
+
+    if tangents:
+        profile["tangents"] = tangents
+    return profile
+
+
+def check(profile):
+    time, temp = profile["time"], profile["temp"]
+    n = len(time)
+
+    if not 4 <= n <= POINTS:
+        raise ValueError("a profile needs 4 to %d points, not %d" % (POINTS, n))
+    if any(b <= a for a, b in zip(time, time[1:])):
+        raise ValueError("times must go up")
+    if time[0] < 0 or time[-1] > MAX_TIME:
+        raise ValueError("times must be 0 to %ds" % MAX_TIME)
+    if any(not 1 <= t <= 300 for t in temp):
+        raise ValueError("temps must be 1-300c")
+    if not 1 <= profile["liquidus"] <= max(temp):
+        raise ValueError("liquidus must be reached by the profile")
+    if not 0 < profile["fan"] < profile["off"] <= time[-1]:
+        raise ValueError("the fan must come on before the heat goes off, before the end")
+    if len(profile["tangents"]) != n:
+        raise ValueError("need one tangent per point")
+    if not profile["name"] or len(profile["name"].encode()) >= NAME_SIZE:
+        raise ValueError("name must be 1-%d characters" % (NAME_SIZE - 1))
+    if len(profile["type"].encode()) >= TYPE_SIZE:
+        raise ValueError("type must be under %d characters" % TYPE_SIZE)
+
+
+def pad(values, fill=0):
+    return list(values) + [fill] * (POINTS - len(values))
+
+
+def encode(profile):
+    time = profile["time"]
+    n = len(time)
+    profile.setdefault("tangents", [1.0] + [0.0] * (n - 1))
+    profile.setdefault("fan", time[-3])
+    profile.setdefault("off", time[-2])
+    check(profile)
+
+    body = RECORD.pack(
+        MAGIC, VERSION, n, int(round(profile["liquidus"])),
+        int(round(profile["fan"])), int(round(profile["off"])),
+        profile["name"].encode(), profile["type"].encode(),
+        *(pad([int(round(t)) for t in time])
+          + pad([int(round(t * 10)) for t in profile["temp"]])
+          + pad([int(round(m * 1000)) for m in profile["tangents"]])))
+    return body + struct.pack("<H", crc16(body))
+
+
+def decode(record):
+    if len(record) != RECORD_SIZE or crc16(record[:-2]) != struct.unpack_from("<H", record, RECORD.size)[0]:
+        raise ValueError("bad record")
+    fields = RECORD.unpack_from(record)
+    n = fields[2]
+    time = fields[8:8 + POINTS]
+    temp = fields[8 + POINTS:8 + POINTS * 2]
+    tangents = fields[8 + POINTS * 2:8 + POINTS * 3]
+    return {
+        "name": fields[6].rstrip(b"\0").decode(),
+        "type": fields[7].rstrip(b"\0").decode(),
+        "liquidus": fields[3], "fan": fields[4], "off": fields[5],
+        "time": list(time[:n]),
+        "temp": [t / 10.0 for t in temp[:n]],
+        "tangents": [m / 1000.0 for m in tangents[:n]],
+    }
+
+
+def verify(profile, record):
+    # Read the record back the way the board will and make sure nothing got lost in rounding
+    back = decode(record)
+    if back["name"] != profile["name"] or back["type"] != profile["type"]:
+        raise ValueError("name or type didn't survive encoding")
+    for key, step in (("time", 0.5), ("temp", 0.05), ("tangents", 0.0005)):
+        if any(abs(a - b) > step for a, b in zip(back[key], profile[key])):
+            raise ValueError("%s are finer than the record can hold" % key)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile a reflow profile for the Reflow Master")
+    parser.add_argument("profile", help="JSON or CSV profile")
+    parser.add_argument("--bin", help="write the 128 byte record here")
+    parser.add_argument("--port", help="serial device to send the upload command to")
+    args = parser.parse_args()
+
+    with open(args.profile) as f:
+        text = f.read()
+
+    try:
+        profile = load_json(text) if text.lstrip().startswith("{") else load_csv(text)
+        record = encode(profile)
+        verify(profile, record)
+    except (ValueError, KeyError, IndexError) as e:
+        sys.exit("%s: %s" % (args.profile, e))
+
+    command = "PROFILE ADD " + record.hex().upper()
+
+    if args.bin:
+        with open(args.bin, "wb") as f:
+            f.write(record)
+
+    if args.port:
+        with open(args.port, "w") as f:
+            f.write(command + "\n")
+        sys.stderr.write("Sent %s, check with PROFILES\n" % profile["name"])
+    else:
+        print(command)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""
+Reflow Master profiler comparison
+
+Compares the section timings from two builds of the firmware, built with
+PROFILER defined. Capture the serial output of each build running through the
+same scenarios (menu idle, warmup, reflow, bake, profile switch...), the
+firmware prints each scenario's timings as it ends, or send PROF for the one
+in progress.
+
+  python3 profile_diff.py old.log new.log
+
+Each line the profiler prints is
+  scenario,section,count,min,mean,max,bucket0,...,bucket15
+where bucket b counts the runs that took 2^(b-1) to 2^b - 1 us. Anything else
+in the logs is skipped. When a scenario shows up more than once in a log the
+runs are added together.
+
+For every scenario and section in either log it prints the mean, the 90th
+percentile (to the top of its bucket) and the max, old -> new, and how much
+the mean changed.
+"""
+import sys
+
+BUCKETS = 16
+
+
+def load(path):
+    sections = {}
+    with open(path, errors="replace") as f:
+        for line in f:
+            cols = line.strip().split(",")
+            if len(cols) != 6 + BUCKETS:
+                continue
+            try:
+                count, low, mean, high = (int(c) for c in cols[2:6])
+                buckets = [int(c) for c in cols[6:]]
+            except ValueError:
+                continue
+
+            key = (cols[0], cols[1])
+            if key in sections:
+                # Another run of the scenario, combine them
+                s = sections[key]
+                total = s["mean"] * s["count"] + mean * count
+                s["count"] += count
+                s["mean"] = total // max(s["count"], 1)
+                s["min"] = min(s["min"], low)
+                s["max"] = max(s["max"], high)
+                s["buckets"] = [a + b for a, b in zip(s["buckets"], buckets)]
+            else:
+                sections[key] = {"count": count, "min": low, "mean": mean, "max": high, "buckets": buckets}
+    return sections
+
+
+def percentile(buckets, fraction):
+    # Top of the bucket the fraction falls in, so it is an upper bound
+    total = sum(buckets)
+    if total == 0:
+        return 0
+    seen = 0
+    for b, n in enumerate(buckets):
+        seen += n
+        if seen >= total * fraction:
+            return (1 << b) - 1 if b < BUCKETS - 1 else float("inf")
+    return float("inf")
+
+
+def fmt(s, key):
+    if s is None:
+        return "-"
+    if key == "p90":
+        p = percentile(s["buckets"], 0.9)
+        return ">%d" % (1 << (BUCKETS - 2)) if p == float("inf") else "%d" % p
+    return "%d" % s[key]
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: profile_diff.py old.log new.log")
+
+    old = load(sys.argv[1])
+    new = load(sys.argv[2])
+    if not old and not new:
+        sys.exit("no profiler output in either log, was the firmware built with PROFILER?")
+
+    print("%-16s %-14s %8s %17s %17s %17s %8s" % ("scenario", "section", "runs", "mean us", "p90 us", "max us", "mean"))
+    for key in sorted(set(old) | set(new)):
+        a, b = old.get(key), new.get(key)
+        change = ""
+        if a and b and a["mean"] > 0:
+            change = "%+.0f%%" % ((b["mean"] - a["mean"]) * 100.0 / a["mean"])
+        runs = b["count"] if b else a["count"]
+        print("%-16s %-14s %8d %17s %17s %17s %8s" % (
+            key[0], key[1], runs,
+            "%s -> %s" % (fmt(a, "mean"), fmt(b, "mean")),
+            "%s -> %s" % (fmt(a, "p90"), fmt(b, "p90")),
+            "%s -> %s" % (fmt(a, "max"), fmt(b, "max")),
+            change))
+
+
+if __name__ == "__main__":
+    main()
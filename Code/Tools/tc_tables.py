@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""
+Reflow Master thermocouple table generator
+
+Writes TCTables.h for the sketch: fixed point lookup tables that take a
+MAX31855 reading back to the NIST ITS-90 curve for each thermocouple type.
+
+The MAX31855 turns the thermocouple voltage into a temperature as if every
+thermocouple were 41.276uV/C, which is only right for type K near room
+temperature. TCLinearize.cpp undoes that: it works the voltage back out of
+the reading and the cold junction temperature, adds the cold junction
+voltage from the first table, and looks the total up in the second.
+
+  cj   1/4 uV at the cold junction, every 8C from 0C to 128C
+  inv  hot junction temp in 1/64C, every 2^shift 1/4 uV from 0uV
+
+Both come from the NIST polynomials (the inverse ones for inv). Before
+anything is written the tables are checked:
+  - the forward polynomials against NIST reference table values
+  - the inverse polynomials against the forward ones, to within NIST's own
+    stated error for them
+  - the whole integer path, the same as TCLinearize.cpp does it, against the
+    forward polynomials at every 0.25C over the table range
+
+It fails and writes nothing if any check is out.
+
+  python3 tc_tables.py ../Reflow_Master_v2/TCTables.h
+"""
+import math
+import sys
+
+# MAX31855 sensitivity, the chip assumes this for every thermocouple
+CHIP_UV_PER_C = 41.276
+# (reading - cold junction) in 1/16C to 1/4 uV is * CHIP_SENS >> 10
+CHIP_SENS = round(CHIP_UV_PER_C / 16 * 4 * 1024)
+
+CJ_STEP = 8       # C
+CJ_MAX = 128      # C
+HOT_MAX = 500     # C, well past any reflow profile
+
+# Types that NIST only covers to a lower temp
+HOT_LIMIT = {"T": 400}
+
+
+def hot_max(tc):
+    return HOT_LIMIT.get(tc, HOT_MAX)
+
+# Forward polynomials, C to mV, from 0C up
+FORWARD = {
+    "K": ([-0.176004136860e-01, 0.389212049750e-01, 0.185587700320e-04, -0.994575928740e-07,
+           0.318409457190e-09, -0.560728448890e-12, 0.560750590590e-15, -0.320207200030e-18,
+           0.971511471520e-22, -0.121047212750e-25],
+          (0.118597600000e+00, -0.118343200000e-03, 0.126968600000e+03)),
+    "J": ([0.0, 0.503811878150e-01, 0.304758369300e-04, -0.856810657200e-07, 0.132281952950e-09,
+           -0.170529583370e-12, 0.209480906970e-15, -0.125383953360e-18, 0.156317256970e-22], None),
+    "T": ([0.0, 0.387481063640e-01, 0.332922278800e-04, 0.206182434040e-06, -0.218822568460e-08,
+           0.109968809280e-10, -0.308157587720e-13, 0.454791352900e-16, -0.275129016730e-19], None),
+    "E": ([0.0, 0.586655087100e-01, 0.450322755820e-04, 0.289084072120e-07, -0.330568966520e-09,
+           0.650244032700e-12, -0.191974955040e-15, -0.125366004970e-17, 0.214892175690e-20,
+           -0.143880417820e-23, 0.359608994810e-27], None),
+    "N": ([0.0, 0.259293946010e-01, 0.157101418800e-04, 0.438256272370e-07, -0.252611697940e-09,
+           0.643118193390e-12, -0.100634715190e-14, 0.997453389920e-18, -0.608632456070e-21,
+           0.208492293390e-24, -0.306821961510e-28], None),
+}
+
+# Inverse polynomials, mV to C, as (top of range in mV, coefficients, NIST's stated error in C)
+INVERSE = {
+    "K": [(20.644, [0.0, 2.508355e+01, 7.860106e-02, -2.503131e-01, 8.315270e-02, -1.228034e-02,
+                    9.804036e-04, -4.413030e-05, 1.057734e-06, -1.052755e-08], 0.05),
+          (54.886, [-1.318058e+02, 4.830222e+01, -1.646031e+00, 5.464731e-02, -9.650715e-04,
+                    8.802193e-06, -3.110810e-08], 0.06)],
+    "J": [(42.919, [0.0, 1.978425e+01, -2.001204e-01, 1.036969e-02, -2.549687e-04, 3.585153e-06,
+                    -5.344285e-08, 5.099890e-10], 0.05)],
+    "T": [(20.872, [0.0, 2.592800e+01, -7.602961e-01, 4.637791e-02, -2.165394e-03, 6.048144e-05,
+                    -7.293422e-07], 0.03)],
+    "E": [(76.373, [0.0, 1.7057035e+01, -2.3301759e-01, 6.5435585e-03, -7.3562749e-05,
+                    -1.7896001e-06, 8.4036165e-08, -1.3735879e-09, 1.0629823e-11, -3.2447087e-14], 0.03)],
+    "N": [(20.613, [0.0, 3.86896e+01, -1.08267e+00, 4.70205e-02, -2.12169e-06, -1.17272e-04,
+                    5.39280e-06, -7.98156e-08], 0.04)],
+}
+
+# NIST ITS-90 reference table values, C and mV
+REFERENCE = {
+    "K": [(0, 0.000), (25, 1.000), (100, 4.096), (200, 8.138), (250, 10.153), (300, 12.209),
+          (400, 16.397), (500, 20.644)],
+    "J": [(0, 0.000), (25, 1.277), (100, 5.269), (200, 10.779), (300, 16.327), (500, 27.393)],
+    "T": [(0, 0.000), (25, 0.992), (100, 4.279), (200, 9.288), (300, 14.862), (400, 20.872)],
+    "E": [(0, 0.000), (100, 6.319), (200, 13.421), (300, 21.036), (400, 28.946), (500, 37.005)],
+    "N": [(0, 0.000), (100, 2.774), (200, 5.913), (300, 9.341), (500, 16.748)],
+}
+
+# Most the table lookups may be out by, over and above NIST's error in the inverse polynomial
+MAX_TABLE_ERROR = 0.05  # C
+
+
+def poly(coeffs, x):
+    return sum(c * x ** i for i, c in enumerate(coeffs))
+
+
+def forward_mv(tc, t):
+    coeffs, exp = FORWARD[tc]
+    mv = poly(coeffs, t)
+    if exp:
+        a0, a1, a2 = exp
+        mv += a0 * math.exp(a1 * (t - a2) ** 2)
+    return mv
+
+
+def inverse_c(tc, mv):
+    for top, coeffs, _ in INVERSE[tc]:
+        if mv <= top:
+            return poly(coeffs, mv)
+    return poly(INVERSE[tc][-1][1], mv)
+
+
+def inverse_error(tc, mv):
+    for top, _, err in INVERSE[tc]:
+        if mv <= top:
+            return err
+    return INVERSE[tc][-1][2]
+
+
+def build(tc):
+    cj = [round(forward_mv(tc, t) * 4000) for t in range(0, CJ_MAX + 1, CJ_STEP)]
+
+    # Coarsest power of 2 step the interpolation is still good enough at
+    top = forward_mv(tc, hot_max(tc)) * 4000
+    for shift in range(12, 4, -1):
+        step = 1 << shift
+        count = int(math.ceil(top / step)) + 1
+        inv = [round(inverse_c(tc, i * step / 4000.0) * 64) for i in range(count)]
+        if table_error(tc, cj, inv, shift) <= MAX_TABLE_ERROR:
+            return cj, inv, shift
+    raise ValueError("type %s: no table step is fine enough" % tc)
+
+
+def lookup(table, x, shift):
+    # The same rounded interpolation as TCLinearize.cpp, ends extended
+    i = x >> shift
+    i = max(0, min(i, len(table) - 2))
+    frac = x - (i << shift)
+    return table[i] + (((table[i + 1] - table[i]) * frac + (1 << (shift - 1))) >> shift)
+
+
+def linearize(cj, inv, shift, tc_raw, cj_raw):
+    # tc_raw in 1/4C, cj_raw in 1/16C, result in 1/64C, as TCLinearize() does it
+    quv = ((tc_raw * 4 - cj_raw) * CHIP_SENS + (1 << 9)) >> 10
+    quv += lookup(cj, cj_raw, int(math.log2(CJ_STEP * 16)))
+    return lookup(inv, quv, shift)
+
+
+def table_error(tc, cj, inv, shift):
+    # Against the polynomials the table was built from, at every step the chip could read
+    worst = 0.0
+    for cj_c in (0, 21.5, 25, 40, 70):
+        cj_raw = int(cj_c * 16)
+        for t_q in range(0, hot_max(tc) * 4 + 1):
+            t = t_q / 4.0
+            # What the chip reads with the hot junction at t
+            uv = (forward_mv(tc, t) - forward_mv(tc, cj_c)) * 1000
+            tc_raw = int(round((uv / CHIP_UV_PER_C + cj_c) * 4))
+            # The chip rounds to 1/4C, so it's the exact temp for the reading that is compared
+            exact = inverse_c(tc, ((tc_raw / 4.0 - cj_c) * CHIP_UV_PER_C + forward_mv(tc, cj_c) * 1000) / 1000.0)
+            worst = max(worst, abs(linearize(cj, inv, shift, tc_raw, cj_raw) / 64.0 - exact))
+    return worst
+
+
+def check(tc):
+    for t, mv in REFERENCE[tc]:
+        if abs(forward_mv(tc, t) - mv) > 0.0015:
+            raise ValueError("type %s forward polynomial is off at %dC: %.4f not %.3f mV" % (tc, t, forward_mv(tc, t), mv))
+
+    for t10 in range(0, hot_max(tc) * 10 + 1, 5):
+        t = t10 / 10.0
+        back = inverse_c(tc, forward_mv(tc, t))
+        if abs(back - t) > inverse_error(tc, forward_mv(tc, t)) + 0.005:
+            raise ValueError("type %s inverse polynomial is off at %.1fC: %.3f" % (tc, t, back))
+
+
+def emit(out, tables):
+    out.write("/*\n")
+    out.write("  Generated by Code/Tools/tc_tables.py, don't edit, run it again instead\n\n")
+    out.write("  NIST ITS-90 thermocouple tables for TCLinearize.cpp\n")
+    out.write("  cj is 1/4 uV every %dC from 0C, inv is 1/64C every 2^shift 1/4 uV from 0uV up to %dC\n" % (CJ_STEP, HOT_MAX))
+    out.write("  (%s)\n" % ", ".join("type %s to %dC" % kv for kv in HOT_LIMIT.items()))
+    out.write("*/\n")
+    out.write("#ifndef TCTables_h\n#define TCTables_h\n\n")
+    out.write("// (reading - cold junction) in 1/16C * TC_CHIP_SENS >> 10 is 1/4 uV, the chip assumes %.3fuV/C\n" % CHIP_UV_PER_C)
+    out.write("#define TC_CHIP_SENS %d\n\n" % CHIP_SENS)
+    out.write("// Cold junction tables, 2^TC_COLD_SHIFT 1/16C steps\n")
+    out.write("#define TC_COLD_COUNT %d\n" % (CJ_MAX // CJ_STEP + 1))
+    out.write("#define TC_COLD_SHIFT %d\n\n" % int(math.log2(CJ_STEP * 16)))
+
+    for tc, (cj, inv, shift, err) in tables.items():
+        out.write("// Type %s, lookups within %.3fC of the NIST polynomials\n" % (tc, err))
+        out.write("static const int32_t tcCold%s[%d] = { %s };\n" % (tc, len(cj), ", ".join(map(str, cj))))
+        out.write("static const int16_t tcInverse%s[%d] = {\n" % (tc, len(inv)))
+        for i in range(0, len(inv), 12):
+            out.write("  %s,\n" % ", ".join(map(str, inv[i:i + 12])))
+        out.write("};\n")
+        out.write("#define TC_SHIFT_%s %d\n\n" % (tc, shift))
+
+    out.write("#endif\n")
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: tc_tables.py TCTables.h")
+
+    tables = {}
+    try:
+        for tc in FORWARD:
+            check(tc)
+            cj, inv, shift = build(tc)
+            err = table_error(tc, cj, inv, shift)
+            tables[tc] = (cj, inv, shift, err)
+            sys.stderr.write("type %s: %d + %d entries, step %guV, max error %.3fC\n" % (tc, len(cj), len(inv), (1 << shift) / 4.0, err))
+    except ValueError as e:
+        sys.exit(str(e))
+
+    with open(sys.argv[1], "w") as out:
+        emit(out, tables)
+
+
+if __name__ == "__main__":
+    main()
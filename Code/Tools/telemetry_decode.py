@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""
+Reflow Master telemetry decoder
+
+Turns the binary telemetry stream from a Reflow Master built with TELEMETRY
+defined into CSV. See Telemetry.h in the sketch for the frame layout.
+
+Capture from the board and decode as it comes in:
+  stty -F /dev/ttyACM0 115200 raw
+  python3 telemetry_decode.py < /dev/ttyACM0 > run.csv
+
+Or decode a capture afterwards:
+  python3 telemetry_decode.py capture.bin > run.csv
+
+Frames that fail the CRC, and anything between frames that isn't telemetry,
+are skipped and counted on stderr.
+"""
+import struct
+import sys
+
+# Version 2 adds the probe being controlled on and every probe's temp
+RECORD = struct.Struct("<BBBBIihhBB")
+PROBES = struct.Struct("<B4h")
+RECORD_SIZES = {1: RECORD.size, 2: RECORD.size + PROBES.size}
+NO_PROBE = -32768
+
+STATES = {
+    0: "BOOT", 1: "WARMUP", 2: "REFLOW", 3: "FINISHED", 4: "REVIEW",
+    10: "MENU", 11: "SETTINGS", 12: "SETTINGS_PASTE", 13: "SETTINGS_RESET",
+    14: "SETTINGS_CONTROL", 15: "OVENCHECK", 16: "OVENCHECK_START",
+    20: "BAKE_MENU", 21: "BAKE", 22: "BAKE_DONE", 99: "ABORT",
+}
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def frames(stream):
+    buf = bytearray()
+    while True:
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            end = buf.find(0)
+            if end < 0:
+                break
+            yield bytes(buf[:end])
+            del buf[:end + 1]
+
+
+def main():
+    stream = open(sys.argv[1], "rb") if len(sys.argv) > 1 else sys.stdin.buffer
+
+    out = sys.stdout
+    out.write("seq,ms,state,time_s,temp_c,wanted_c,duty,fan,cutoff,tc_error,control,probe0_c,probe1_c,probe2_c,probe3_c\n")
+
+    good = bad = lost = 0
+    last_seq = None
+
+    for frame in frames(stream):
+        raw = cobs_decode(frame) if frame else None
+        size = RECORD_SIZES.get(raw[0]) if raw else None
+        if size is None or len(raw) != size + 2:
+            bad += 1
+            continue
+        if crc16(raw[:size]) != struct.unpack_from("<H", raw, size)[0]:
+            bad += 1
+            continue
+
+        _, seq, state, flags, ms, time_x, temp, wanted, duty, tc_error = RECORD.unpack_from(raw)
+
+        if raw[0] >= 2:
+            control, *temps = PROBES.unpack_from(raw, RECORD.size)
+            probes = "%d,%s" % (control, ",".join("" if t == NO_PROBE else "%.2f" % (t / 16.0) for t in temps))
+        else:
+            probes = ",,,,"
+
+        if last_seq is not None:
+            lost += (seq - last_seq - 1) & 0xFF
+        last_seq = seq
+        good += 1
+
+        out.write("%d,%d,%s,%.2f,%.2f,%.2f,%d,%d,%d,%d,%s\n" % (
+            seq, ms, STATES.get(state, str(state)), time_x / 100.0,
+            temp / 16.0, wanted / 16.0, duty,
+            flags & 1, (flags >> 1) & 1, tc_error, probes))
+        out.flush()
+
+    sys.stderr.write("%d records, %d bad frames, %d lost\n" % (good, bad, lost))
+
+
+if __name__ == "__main__":
+    main()